@@ -65,6 +65,10 @@ namespace SCXCoreLib
 
         //! Returns true if information is available
         bool         GotInfo() const { return m_File.length() ? true : false; };
+        //! Returns the source file; empty if information is not available
+        const std::wstring& GetFile() const { return m_File; };
+        //! Returns the line number; only meaningful if GotInfo()
+        unsigned int GetLine() const { return m_Line; };
         //! Returns a formatted string with code location
         std::wstring Where() const;
 
@@ -98,6 +98,13 @@ namespace SCXCoreLib
          */
         virtual void HandleLogRotate() { }
 
+        /*----------------------------------------------------------------------------*/
+        /**
+           Wait until the items logged so far have been consumed; a consumer that
+           consumes an item before LogThisItem() returns has nothing to wait for
+         */
+        virtual void Flush() { }
+
         /**
             Destructor.
 
@@ -229,6 +236,7 @@ namespace SCXCoreLib
 
         static SCXLogHandle GetLogHandle(const std::wstring& module);
         static const SCXHandle<const SCXLogConfiguratorIf> GetLogConfigurator();
+        static void Flush();
 
         const std::wstring DumpString() const;
 
@@ -251,6 +259,9 @@ namespace SCXCoreLib
             SCXASSERT(!"Do not assign SCXLogHandleFactory");
             return *this;
         }
+#if defined(linux)
+        static void FlushAtExit();
+#endif
 #if !defined(DISABLE_WIN_UNSUPPORTED)  
         static const int LOGROTATE_REACTION_SIGNAL;
 
@@ -42,6 +42,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <signal.h>
 #include <sys/types.h>
 
 #if defined(sun) || defined(hpux)
@@ -77,6 +78,8 @@ namespace SCXCoreLib
     
     };
 
+    class SCXProcessSupervisor;
+
     /*----------------------------------------------------------------------------*/
     /**
         Represents a reference to a process. 
@@ -115,6 +118,11 @@ namespace SCXCoreLib
         virtual void CloseAndDie();
 
     private:
+        friend class SCXProcessSupervisor;
+
+        void ExecChild(const std::string& chrootDir, const std::string& cwdDir, const sigset_t* signals);
+        void ChildFailed(const sigset_t* signals);
+
         //!< Index of file descriptors for a pipe
         enum Direction {
             R,           //!< in
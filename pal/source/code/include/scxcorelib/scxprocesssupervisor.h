@@ -0,0 +1,112 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+    \file        scxprocesssupervisor.h
+
+    \brief       Runs any number of processes to completion from one thread.
+
+    \date        2026-10-18 18:02:00
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef SCXPROCESSSUPERVISOR_H
+#define SCXPROCESSSUPERVISOR_H
+
+#include <scxcorelib/scxcmn.h>
+#include <scxcorelib/scxprocess.h>
+
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#if defined(SCX_UNIX)
+
+namespace SCXCoreLib
+{
+    /*----------------------------------------------------------------------------*/
+    /**
+        Supervises started processes: feeds their stdin, collects their stdout
+        and stderr, enforces their timeouts and reaps them, all in one poll loop.
+
+        Where the kernel provides process file descriptors (pidfd, Linux 5.3)
+        an exit wakes the loop at once, even while a grandchild still holds
+        the output pipes open. Elsewhere exits are checked for every
+        c_exitCheckInterval milliseconds while the pipes are quiet.
+
+        Processes may be added between calls to RunUntilExit(), so a caller can
+        start the next process as soon as an earlier one exits.  Interrupt() is
+        the only method that may be called from another thread.
+
+        \ex
+        \code
+            SCXProcessSupervisor supervisor;
+            size_t first = supervisor.Add(process1, in1, out1, err1, 10000);
+            size_t second = supervisor.Add(process2, in2, out2, err2);
+            supervisor.Run();
+            int code = supervisor.GetReturnCode(first);
+        \endcode
+    */
+    class SCXProcessSupervisor
+    {
+    public:
+        SCXProcessSupervisor();
+        ~SCXProcessSupervisor();
+
+        size_t Add(SCXProcess& process, std::istream& mystdin, std::ostream& mystdout, std::ostream& mystderr,
+                   unsigned timeout = 0);
+        void Run();
+        size_t RunUntilExit();
+        void Interrupt();
+        int GetReturnCode(size_t index) const;
+        bool WasInterrupted(size_t index) const;
+
+        static const int c_exitCheckInterval = 250;   //!< Milliseconds between exit checks without pidfd
+        static const size_t npos = static_cast<size_t>(-1);  //!< RunUntilExit() returned without an exit
+
+    private:
+        SCXProcessSupervisor(const SCXProcessSupervisor&);             //!< Prevent copying
+        SCXProcessSupervisor& operator=(const SCXProcessSupervisor&);  //!< Prevent assignment
+
+        //! A supervised process
+        struct Entry
+        {
+            SCXProcess*   m_process;        //!< Process, owned by the caller
+            std::istream* m_stdin;          //!< Source of the process' stdin
+            std::ostream* m_stdout;         //!< Receiver of the process' stdout
+            std::ostream* m_stderr;         //!< Receiver of the process' stderr
+            scxulong      m_deadline;       //!< When the process is killed, 0 for never
+            bool          m_killed;         //!< The process group has been killed
+            int           m_pidfd;          //!< Process file descriptor, -1 if none
+            bool          m_done;           //!< The process has been reaped
+            int           m_status;         //!< Wait status, once reaped
+        };
+
+        void Reap(Entry& entry);
+
+        std::vector<Entry> m_entries;       //!< Processes in the order they were added
+        std::deque<size_t> m_exited;        //!< Reaped processes RunUntilExit() has not returned yet
+        int m_wakeup[2];                    //!< Pipe Interrupt() writes to, to wake up the poll loop
+    };
+} /* namespace SCXCoreLib */
+
+#endif /* SCX_UNIX */
+
+#endif /* SCXPROCESSSUPERVISOR_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
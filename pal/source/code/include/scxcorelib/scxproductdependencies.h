@@ -53,22 +53,6 @@ namespace SCXCoreLib
            \param[in] procStart Timestamp when first log from process was made
         */
         void WriteLogFileHeader( SCXHandle<std::wfstream> &stream, int runNum, SCXCalendarTime& procStart );
-
-        /*----------------------------------------------------------------------------*/
-        /**
-           The developer must implement this function to modify log file lines as they
-           are written to the log file.  If no changes are needed, then simply implement
-           as something like:
-               stream << message << std::endl;
-
-           This method provides a hook if log lines must be written in some particular
-           format, or must be modified in some way.
-           
-           \param[in] stream    The stream to write the head to
-           \param[in] item      Log file item to be written (if needed for context)
-           \param[in] message   Formatted message to be written to the log file
-        */
-        void WrtieItemToLog( SCXHandle<std::wfstream> &stream, const SCXLogItem& item, const std::wstring& message );
     }
 }
 
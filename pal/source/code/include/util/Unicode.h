@@ -1259,6 +1259,19 @@ namespace SCX
             */
             void Assign(const std::vector<unsigned char>& v);
 
+            /*----------------------------------------------------------------------------*/
+            /**
+             Assign an array of bytes encoded in UTF-8, e.g. a mapped file, to the
+             current string without copying it into a vector first
+
+             \param [in]     str    the input bytes
+             \param [in]     _size  number of bytes in str
+            */
+            void Assign(const Utf8Char* str, size_t _size)
+            {
+                Utf16String::Assign(str, _size);
+            }
+
             /*----------------------------------------------------------------------------*/
             /**
              Assign a range of words in machine byte order to the current string
@@ -33,6 +33,7 @@
 #endif
 #include <scxcorelib/scxcmn.h>
 #include <scxcorelib/scxprocess.h>
+#include <scxcorelib/scxprocesssupervisor.h>
 #include <scxcorelib/scxoserror.h>
 #include <scxcorelib/stringaid.h>
 #include <scxcorelib/scxmath.h>
@@ -56,10 +57,14 @@
 #include <sys/socket.h>
 #endif
 
-#if defined(macos) || defined(sun)
+#if defined(macos) || defined(sun) || defined(linux)
 #include <signal.h>
 #endif
 
+#if defined(linux)
+#include <pthread.h>
+#endif
+
 #include <errno.h>
 
 namespace SCXCoreLib
@@ -223,77 +228,12 @@ namespace SCXCoreLib
     }
     
 
-    /**********************************************************************************/
-    //! Class for running a process with an option to timeout 
-    class ProcessThreadParam : public SCXThreadParam
-    {   
-    public:
-        //! Constructor that starts a process
-        //! \param[in]  process     Process to monitor
-        //! \param[in]  timeout     Accepted wait before process terminates
-        ProcessThreadParam(SCXProcess *process, unsigned timeout)
-            : m_process(process), m_processTerminated(false), m_timeout(timeout)
-        {
-        }
+    //! A 'magic number' that is passed to the parent to signify that this process has had its pgid set.
+    static const char * const c_magicGUID = "b4360097-03d5-4d1d-9514-176428bcd88f";
+    static const ssize_t c_magicGUID_length = 36;
 
-        /**********************************************************************************/
-        //! Wait for the process to terminate
-        //! \param[in]  mystdin     Represents stdin of process
-        //! \param[in]  mystdout    Represents stdout of process
-        //! \param[in]  mystderr    Represents stderr of process
-        //! \returns Return code from process being run.
-        int WaitForReturn(std::istream &mystdin, std::ostream &mystdout, std::ostream &mystderr)
-        {               
-            int returnCode = -1;
-            try 
-            {
-                returnCode =  m_process->WaitForReturn(mystdin, mystdout, mystderr);
-                m_processTerminated = true;
-            }
-            catch (...)
-            {
-                m_processTerminated = true;
-                throw;
-            }
-            return returnCode;
-        }
-
-        /**********************************************************************************/
-        //! Wait a limited amount of time for the process to terminate.
-        void WaitForReturn() 
-        {
-            // Good enough way of waiting for the process
-            int timeoutLeft = m_timeout;             
-            while (timeoutLeft > 0 && !m_processTerminated)
-            {
-                const int timeBetweenChecks = 1000;
-                SCXThread::Sleep(timeBetweenChecks);
-                timeoutLeft -= timeBetweenChecks;
-            }
-            if (!m_processTerminated)
-            {
-                m_process->Kill();
-            }
-        }
-
-    private:
-        ProcessThreadParam(const ProcessThreadParam &);             //!< Prevent copying               
-        ProcessThreadParam &operator=(const ProcessThreadParam &);  //!< Prevent assignment
-
-        SCXProcess *m_process;      //!< Process to run
-        bool m_processTerminated;   //!< True iff the process has terminated
-        unsigned m_timeout;              //!< Accepted wait before termination
-    };
-
-    /**********************************************************************************/
-    //! Monitors the process
-    //! \param[in]  handle      Parameters of thread
-    //! \note Meant to be called in a separate thread by being passed as argument to Thread constructor
-    void WaitForReturnFn(SCXCoreLib::SCXThreadParamHandle& handle)
-    {        
-        ProcessThreadParam* param = static_cast<ProcessThreadParam *>(handle.GetData());
-        param->WaitForReturn();
-    }
+    //! Timeout waiting for the subprocess to write or exit, in milliseconds
+    static const int c_pollTimeout = 2000;
 
     /**********************************************************************************/
     //! Helper function to determine effective timeout duration.
@@ -345,22 +285,11 @@ namespace SCXCoreLib
     int SCXProcess::Run(SCXProcess& process, 
                         std::istream &mystdin, std::ostream &mystdout, std::ostream &mystderr, unsigned timeout /*= 0*/)
     {
-        int returnCode = -1;
-        if (timeout <= 0)
-        {
-            returnCode = process.WaitForReturn(mystdin, mystdout, mystderr);
-        }
-        else
-        {
-            ProcessThreadParam *ptp = new ProcessThreadParam(&process, timeout);
-            //ptp = 0;
-            SCXThreadParamHandle tph(ptp);
+        SCXProcessSupervisor supervisor;
+        supervisor.Add(process, mystdin, mystdout, mystderr, timeout);
+        supervisor.Run();
 
-            SCXThread t(WaitForReturnFn, tph);
-            returnCode = ptp->WaitForReturn(mystdin, mystdout, mystderr);
-            t.Wait();
-        }
-        return returnCode;
+        return process.WaitForReturn();
     }
 
     /**********************************************************************************/
@@ -401,166 +330,234 @@ namespace SCXCoreLib
                throw SCXInternalErrorException(L"Failed to open pipe for m_errForChild", SCXSRCLOCATION);
         }
 
-        // A 'magic number' that is passed to the parent to signify that this process has had its pgid set.
-        const char * c_magicGUID = "b4360097-03d5-4d1d-9514-176428bcd88f";
-        const ssize_t c_magicGUID_length = 36;
+        // Everything the child process needs is converted before the child is
+        // created, so that it does not have to allocate memory
+        std::string chrootDir = StrToMultibyte(chrootPath.Get());
+        std::string cwdDir = StrToMultibyte(cwd.Get());
+
+#if defined(linux)
+        // The child shares the memory of this process until it has called exec,
+        // which saves copying the page tables of a large parent. Signals stay
+        // blocked until the child has reset their handlers, so that no handler
+        // of this process runs in the child.
+        sigset_t allSignals;
+        sigset_t oldSignals;
+        sigfillset(&allSignals);
+        pthread_sigmask(SIG_SETMASK, &allSignals, &oldSignals);
+
+        m_pid = vfork();
+        if (m_pid == 0)
+        {
+            ExecChild(chrootDir, cwdDir, &oldSignals);
+        }
 
+        int forkErrno = errno;
+        pthread_sigmask(SIG_SETMASK, &oldSignals, 0);
+        errno = forkErrno;
+#else
         m_pid = fork();                         // Create child process, duplicates file descriptors
         if (m_pid == 0) 
         {
-            // Set the pgid of the forked process to be the same as the forked process's pid, so that 
-            // we can kill the forked process and all subprocesses (if necessary) by calling killpg.
-            setpgid(0, 0);
- 
-            // Communicate with the parent process that the child process has set its process group id.
-            write(m_outForChild[W], c_magicGUID, c_magicGUID_length);
+            ExecChild(chrootDir, cwdDir, 0);
+        }
+#endif
 
-            // Child process.
-            // The file descriptors are duplicates, created by "fork",  of those in the parent process
-            dup2(m_inForChild[R], STDIN_FILENO);      // Make the child process read from the parent process
-            close(m_inForChild[R]);                   // Close duplicate
-            close(m_inForChild[W]);                   // The child only reads from its stdin
-            dup2(m_outForChild[W], STDOUT_FILENO);    // Make the child process write to the parent process
-            close(m_outForChild[R]);                  // The child only writes to its stdout
-            close(m_outForChild[W]);                  // Close duplicate
-            dup2(m_errForChild[W], STDERR_FILENO);    // Make the child process write to the parent process
-            close(m_errForChild[R]);                  // The child only writes to its stdout
-            close(m_errForChild[W]);                  // Close duplicate
-
-            char error_msg[1024];
-            if (L"" != chrootPath.Get())
+        // Same (parent) process.
+        // All file descriptors were duplicated in the child process by "fork"
+        close(m_inForChild[R]);                   // Only the child process reads from its stdin
+        close(m_outForChild[W]);                  // Only the child process writes to its stdout
+        close(m_errForChild[W]);                  // Only the child process writes to its stderr
+        if (m_pid < 0)
+        {
+            // Free remaining resources held by the parent process
+            // The child process manages its own resources
+            close(m_inForChild[W]);
+            close(m_outForChild[R]);
+            close(m_errForChild[R]);
+
+            // Free everything except the terminating NULL
+            for (std::vector<char *>::size_type i = 0; i < m_cargv.size() - 1; i++)
             {
-                if ( 0 != ::chroot(StrToMultibyte(chrootPath.Get()).c_str()))
-                {
-                    snprintf(error_msg,
-                             sizeof(error_msg),
-                             "Failed to chroot '%s' errno=%d",
-                             StrToMultibyte(chrootPath.Get()).c_str(), errno);
-                    DoWrite(STDERR_FILENO, error_msg, strlen(error_msg));
-                    CloseAndDie();
-                }
-                if ( 0 != ::chdir("/"))
+                free(m_cargv[i]);
+            }
+            //  No child process was created
+            throw SCXInternalErrorException(UnexpectedErrno(L"Process communication failed", errno), SCXSRCLOCATION);
+        }
+
+        // Set non-blocking I/O for the output and error channels
+        // We need to use this to insure we have all our data from
+        // the subprocess ...
+
+        if (-1 == fcntl(m_outForChild[R], F_SETFL, O_NONBLOCK))
+        {
+            throw SCXInternalErrorException(UnexpectedErrno(L"Failed to set non-blocking I/O on stdout pipe", errno), SCXSRCLOCATION);
+        }
+
+        if (-1 == fcntl(m_errForChild[R], F_SETFL, O_NONBLOCK))
+        {
+            throw SCXInternalErrorException(UnexpectedErrno(L"Failed to set non-blocking I/O on stderr pipe", errno), SCXSRCLOCATION);
+        }
+
+        m_timeoutOverhead = 0;
+
+#if !defined(linux)
+        // Block until c_magicGUID is written to the child's stdout. This is to prevent a race condition
+        // where the parent process attempts to kill the child's process group before the child process
+        // sets its process group. (After vfork the child has already called exec when we get here.)
+        char readmagic[c_magicGUID_length+1];
+        const size_t c_timeBetweenReads = 50;
+        const size_t c_maxTimeout = 30000;
+        ssize_t numOfBytesRead = 0;
+
+        while(m_timeoutOverhead < c_maxTimeout)
+        {
+            ssize_t readVal = read(m_outForChild[R], readmagic + numOfBytesRead, c_magicGUID_length - numOfBytesRead);
+            if ( (readVal + numOfBytesRead) == c_magicGUID_length)
+            {
+                // Proper number of bytes read.  Let's make sure the strings match.
+                if (strncmp(readmagic, c_magicGUID, c_magicGUID_length) != 0)
                 {
-                    snprintf(error_msg,
-                             sizeof(error_msg),
-                             "Failed to change root directory. errno=%d", errno);
-                    DoWrite(STDERR_FILENO, error_msg, strlen(error_msg));
-                    CloseAndDie();
+                    // there was an error communicating with the subprocess
+                    throw SCXInternalErrorException(L"Process communication failed: read data did not match", SCXSRCLOCATION);
                 }
+                break;
             }
-            if (L"" != cwd.Get())
+            else if (readVal < 0) 
             {
-                if (0 != ::chdir(StrToMultibyte(cwd.Get()).c_str()))
+                if (errno == EAGAIN)
                 {
-                    snprintf(error_msg,
-                             sizeof(error_msg),
-                             "Failed to change cwd. errno=%d", errno);
-                    DoWrite(STDERR_FILENO, error_msg, strlen(error_msg));
-                    CloseAndDie();
+                    continue;
                 }
+                else
+                {
+                    // there was an error communicating with the subprocess
+                    throw SCXInternalErrorException(UnexpectedErrno(L"Process communication failed: read returned an error", errno), SCXSRCLOCATION);
+                }
+            }
+            else
+            {
+                // read returned an unexpected number of bytes, keep reading until the number of bytes matches
+                numOfBytesRead += readVal;
             }
+            SCXThread::Sleep(c_timeBetweenReads);
+            m_timeoutOverhead += c_timeBetweenReads;
+        }
+#endif
+    }
+
+    /**********************************************************************************/
+    //! Set up the child process and replace it with the command; never returns
+    //! \param[in]  chrootDir   Directory to chroot to, empty for none
+    //! \param[in]  cwdDir      Directory to change to, empty for none
+    //! \param[in]  signals     Signal mask to restore if the child shares the memory
+    //!                         of the parent (vfork), otherwise 0
+    //! \note   A child sharing the memory of the parent must not allocate memory or
+    //!         change anything but its own stack, so it exits instead of calling
+    //!         CloseAndDie. Exit code 1 is what CloseAndDie's shell exits with.
+    void SCXProcess::ExecChild(const std::string& chrootDir, const std::string& cwdDir, const sigset_t* signals)
+    {
+        // Set the pgid of the forked process to be the same as the forked process's pid, so that 
+        // we can kill the forked process and all subprocesses (if necessary) by calling killpg.
+        setpgid(0, 0);
+ 
+        if (0 == signals)
+        {
+            // Communicate with the parent process that the child process has set its process group id.
+            write(m_outForChild[W], c_magicGUID, c_magicGUID_length);
+        }
 
-            // Close open file descriptors except stdin/out/err
-            // (Some systems have UNLIMITED of 2^64; limit to something reasonable)
+        // Child process.
+        // The file descriptors are duplicates, created by "fork",  of those in the parent process
+        dup2(m_inForChild[R], STDIN_FILENO);      // Make the child process read from the parent process
+        close(m_inForChild[R]);                   // Close duplicate
+        close(m_inForChild[W]);                   // The child only reads from its stdin
+        dup2(m_outForChild[W], STDOUT_FILENO);    // Make the child process write to the parent process
+        close(m_outForChild[R]);                  // The child only writes to its stdout
+        close(m_outForChild[W]);                  // Close duplicate
+        dup2(m_errForChild[W], STDERR_FILENO);    // Make the child process write to the parent process
+        close(m_errForChild[R]);                  // The child only writes to its stdout
+        close(m_errForChild[W]);                  // Close duplicate
 
-            int fdLimit = 0;
-            fdLimit = getdtablesize();
-            if (fdLimit > 2500)
+        char error_msg[1024];
+        if (!chrootDir.empty())
+        {
+            if ( 0 != ::chroot(chrootDir.c_str()))
             {
-                fdLimit = 2500;
+                snprintf(error_msg,
+                         sizeof(error_msg),
+                         "Failed to chroot '%s' errno=%d",
+                         chrootDir.c_str(), errno);
+                DoWrite(STDERR_FILENO, error_msg, strlen(error_msg));
+                ChildFailed(signals);
             }
-
-            for (int fd = 3; fd < fdLimit; ++fd)
+            if ( 0 != ::chdir("/"))
             {
-                close(fd);
+                snprintf(error_msg,
+                         sizeof(error_msg),
+                         "Failed to change root directory. errno=%d", errno);
+                DoWrite(STDERR_FILENO, error_msg, strlen(error_msg));
+                ChildFailed(signals);
             }
-
-            execvp(m_cargv[0], &m_cargv[0]);                // Replace the child process image
-            snprintf(error_msg, sizeof(error_msg), "Failed to start child process '%s' errno=%d  ", m_cargv[0], errno);
-            DoWrite(STDERR_FILENO, error_msg, strlen(error_msg));
-            CloseAndDie();                                  // Failed to load correct process.
         }
-        else
+        if (!cwdDir.empty())
         {
-            // Same (parent) process.
-            // All file descriptors were duplicated in the child process by "fork"
-            close(m_inForChild[R]);                   // Only the child process reads from its stdin
-            close(m_outForChild[W]);                  // Only the child process writes to its stdout
-            close(m_errForChild[W]);                  // Only the child process writes to its stderr
-            if (m_pid < 0)
+            if (0 != ::chdir(cwdDir.c_str()))
             {
-                // Free remaining resources held by the parent process
-                // The child process manages its own resources
-                close(m_inForChild[W]);
-                close(m_outForChild[R]);
-                close(m_errForChild[R]);
-
-                // Free everything except the terminating NULL
-                for (std::vector<char *>::size_type i = 0; i < m_cargv.size() - 1; i++)
-                {
-                    free(m_cargv[i]);
-                }
-                //  No child process was created
-                throw SCXInternalErrorException(UnexpectedErrno(L"Process communication failed", errno), SCXSRCLOCATION);
+                snprintf(error_msg,
+                         sizeof(error_msg),
+                         "Failed to change cwd. errno=%d", errno);
+                DoWrite(STDERR_FILENO, error_msg, strlen(error_msg));
+                ChildFailed(signals);
             }
+        }
 
-            // Set non-blocking I/O for the output and error channels
-            // We need to use this to insure we have all our data from
-            // the subprocess ...
+        // Close open file descriptors except stdin/out/err
+        // (Some systems have UNLIMITED of 2^64; limit to something reasonable)
 
-            if (-1 == fcntl(m_outForChild[R], F_SETFL, O_NONBLOCK))
-            {
-                throw SCXInternalErrorException(UnexpectedErrno(L"Failed to set non-blocking I/O on stdout pipe", errno), SCXSRCLOCATION);
-            }
-
-            if (-1 == fcntl(m_errForChild[R], F_SETFL, O_NONBLOCK))
-            {
-                throw SCXInternalErrorException(UnexpectedErrno(L"Failed to set non-blocking I/O on stderr pipe", errno), SCXSRCLOCATION);
-            }
+        int fdLimit = 0;
+        fdLimit = getdtablesize();
+        if (fdLimit > 2500)
+        {
+            fdLimit = 2500;
+        }
 
-            // Block until c_magicGUID is written to the child's stdout. This is to prevent a race condition
-            // where the parent process attempts to kill the child's process group before the child process
-            // sets its process group.
-            char readmagic[c_magicGUID_length+1];
-            m_timeoutOverhead = 0;
-            const size_t c_timeBetweenReads = 50;
-            const size_t c_maxTimeout = 30000;
-            ssize_t numOfBytesRead = 0;
+        for (int fd = 3; fd < fdLimit; ++fd)
+        {
+            close(fd);
+        }
 
-            while(m_timeoutOverhead < c_maxTimeout)
+        if (0 != signals)
+        {
+            // Handlers of the parent must not run in the child; ignored signals stay ignored
+            for (int sig = 1; sig < NSIG; ++sig)
             {
-                ssize_t readVal = read(m_outForChild[R], readmagic + numOfBytesRead, c_magicGUID_length - numOfBytesRead);
-                if ( (readVal + numOfBytesRead) == c_magicGUID_length)
-                {
-                    // Proper number of bytes read.  Let's make sure the strings match.
-                    if (strncmp(readmagic, c_magicGUID, c_magicGUID_length) != 0)
-                    {
-                        // there was an error communicating with the subprocess
-                        throw SCXInternalErrorException(L"Process communication failed: read data did not match", SCXSRCLOCATION);
-                    }
-                    break;
-                }
-                else if (readVal < 0) 
-                {
-                    if (errno == EAGAIN)
-                    {
-                        continue;
-                    }
-                    else
-                    {
-                        // there was an error communicating with the subprocess
-                        throw SCXInternalErrorException(UnexpectedErrno(L"Process communication failed: read returned an error", errno), SCXSRCLOCATION);
-                    }
-                }
-                else
+                struct sigaction action;
+                if (0 == sigaction(sig, 0, &action) && SIG_IGN != action.sa_handler)
                 {
-                    // read returned an unexpected number of bytes, keep reading until the number of bytes matches
-                    numOfBytesRead += readVal;
+                    action.sa_handler = SIG_DFL;
+                    action.sa_flags = 0;
+                    sigaction(sig, &action, 0);
                 }
-                SCXThread::Sleep(c_timeBetweenReads);
-                m_timeoutOverhead += c_timeBetweenReads;
             }
+            sigprocmask(SIG_SETMASK, signals, 0);
+        }
+
+        execvp(m_cargv[0], &m_cargv[0]);                // Replace the child process image
+        snprintf(error_msg, sizeof(error_msg), "Failed to start child process '%s' errno=%d  ", m_cargv[0], errno);
+        DoWrite(STDERR_FILENO, error_msg, strlen(error_msg));
+        ChildFailed(signals);                           // Failed to load correct process.
+    }
+
+    /**********************************************************************************/
+    //! Terminate a child process that could not be set up
+    //! \param[in]  signals     As passed to ExecChild
+    void SCXProcess::ChildFailed(const sigset_t* signals)
+    {
+        if (0 != signals)
+        {
+            _exit(1);
         }
+        CloseAndDie();
     }
 
     /**********************************************************************************/
@@ -612,8 +609,6 @@ namespace SCXCoreLib
     //! \param[in]  mystderr    Receiver of content that the process writes to stderr
     //! \returns true if there is possibly more data to fetch (stderr and/or stdout still open for read).
     bool SCXProcess::InternalPerformIO(std::istream &mystdin, std::ostream &mystdout, std::ostream &mystderr) {
-        const int pollTimeoutInSecs = 2;     // Timeout waiting for subprocess
-
         // Wait some time for something available to be read from stdout or
         // stderr of the child process.
         //
@@ -650,7 +645,7 @@ namespace SCXCoreLib
             fds[2].fd = m_errForChild[R];
         }
 
-        int pollStatus = poll(fds, 3, pollTimeoutInSecs * 1000);
+        int pollStatus = poll(fds, 3, c_pollTimeout);
         if (pollStatus < 0)             /* Error occurred */
         {
             throw SCXInternalErrorException(UnexpectedErrno(L"Process communication failed", errno), SCXSRCLOCATION);
@@ -746,11 +741,9 @@ namespace SCXCoreLib
     //! \param[in]  mystderr    Stderr of process
     int SCXProcess::WaitForReturn(std::istream &mystdin, std::ostream &mystdout, std::ostream &mystderr)
     {
-        bool fetched = true;
-        while (fetched)
-        {
-            fetched = PerformIO(mystdin, mystdout, mystderr);
-        }  
+        SCXProcessSupervisor supervisor;
+        supervisor.Add(*this, mystdin, mystdout, mystderr);
+        supervisor.Run();
 
         return WaitForReturn();
     }
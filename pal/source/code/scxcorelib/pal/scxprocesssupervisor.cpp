@@ -0,0 +1,438 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+    \file        scxprocesssupervisor.cpp
+
+    \brief       Runs any number of processes to completion from one thread.
+
+    \date        2026-10-18 18:02:00
+
+*/
+/*----------------------------------------------------------------------------*/
+
+#include <scxcorelib/scxcmn.h>
+#include <scxcorelib/scxprocesssupervisor.h>
+#include <scxcorelib/scxexception.h>
+#include <scxcorelib/scxoserror.h>
+
+#if defined(SCX_UNIX)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if defined(linux)
+#include <sys/syscall.h>
+#include <time.h>
+#else
+#include <sys/time.h>
+#endif
+
+#if defined(linux) && !defined(__NR_pidfd_open)
+#define __NR_pidfd_open 434
+#endif
+
+namespace
+{
+    /**********************************************************************************/
+    //! Milliseconds since an unspecified point in time, for measuring timeouts
+    scxulong MonotonicMilliseconds()
+    {
+#if defined(linux)
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return static_cast<scxulong>(now.tv_sec) * 1000 + now.tv_nsec / 1000000;
+#else
+        struct timeval now;
+        gettimeofday(&now, 0);
+        return static_cast<scxulong>(now.tv_sec) * 1000 + now.tv_usec / 1000;
+#endif
+    }
+
+    /**********************************************************************************/
+    //! Open a file descriptor that becomes readable when the process exits
+    //! \returns The descriptor, or -1 if the kernel has no process descriptors
+    int OpenPidFd(SCXCoreLib::SCXProcessId pid)
+    {
+#if defined(linux)
+        int fd = static_cast<int>(syscall(__NR_pidfd_open, pid, 0));
+        if (fd >= 0)
+        {
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        return fd;
+#else
+        (void) pid;
+        return -1;
+#endif
+    }
+
+    /**********************************************************************************/
+    //! Shorten a poll timeout; -1 means no timeout
+    int ShortestTimeout(int timeout, scxulong candidate)
+    {
+        if (timeout < 0 || candidate < static_cast<scxulong>(timeout))
+        {
+            return static_cast<int>(candidate);
+        }
+        return timeout;
+    }
+}
+
+namespace SCXCoreLib
+{
+    const size_t SCXProcessSupervisor::npos;
+
+    /**********************************************************************************/
+    //! Constructor
+    //! \throws     SCXInternalErrorException       Failure to open the wakeup pipe
+    SCXProcessSupervisor::SCXProcessSupervisor()
+    {
+        if (-1 == pipe(m_wakeup))
+        {
+            throw SCXInternalErrorException(UnexpectedErrno(L"Failed to open wakeup pipe", errno), SCXSRCLOCATION);
+        }
+
+        for (int i = 0; i < 2; ++i)
+        {
+            fcntl(m_wakeup[i], F_SETFD, FD_CLOEXEC);
+            fcntl(m_wakeup[i], F_SETFL, O_NONBLOCK);
+        }
+    }
+
+    /**********************************************************************************/
+    //! Destructor; processes that were not run to completion are left running
+    SCXProcessSupervisor::~SCXProcessSupervisor()
+    {
+        for (std::vector<Entry>::iterator iter = m_entries.begin(); iter != m_entries.end(); ++iter)
+        {
+            if (iter->m_pidfd >= 0)
+            {
+                close(iter->m_pidfd);
+            }
+        }
+
+        close(m_wakeup[0]);
+        close(m_wakeup[1]);
+    }
+
+    /**********************************************************************************/
+    //! Supervise a started process
+    //! \param[in]  process     Process to supervise; must outlive Run()
+    //! \param[in]  mystdin     stdin for the process
+    //! \param[in]  mystdout    stdout for the process
+    //! \param[in]  mystderr    stderr for the process
+    //! \param[in]  timeout     Max number of milliseconds the process is allowed to run (0 means no limit)
+    //! \returns Index of the process, for GetReturnCode() and WasInterrupted()
+    size_t SCXProcessSupervisor::Add(SCXProcess& process,
+                                     std::istream& mystdin, std::ostream& mystdout, std::ostream& mystderr,
+                                     unsigned timeout /*= 0*/)
+    {
+        Entry entry;
+        entry.m_process = &process;
+        entry.m_stdin = &mystdin;
+        entry.m_stdout = &mystdout;
+        entry.m_stderr = &mystderr;
+        entry.m_deadline = timeout > 0 ? MonotonicMilliseconds() + timeout : 0;
+        entry.m_killed = false;
+        entry.m_pidfd = OpenPidFd(process.m_pid);
+        entry.m_done = false;
+        entry.m_status = 0;
+
+        m_entries.push_back(entry);
+        return m_entries.size() - 1;
+    }
+
+    /**********************************************************************************/
+    //! Run until every process has exited and been reaped. A process whose timeout
+    //! passes has its process group killed.
+    //! \throws     SCXInternalErrorException       Failure to communicate with a process
+    void SCXProcessSupervisor::Run()
+    {
+        for (;;)
+        {
+            if (npos == RunUntilExit())
+            {
+                bool pending = false;
+                for (std::vector<Entry>::const_iterator iter = m_entries.begin(); iter != m_entries.end(); ++iter)
+                {
+                    pending = pending || !iter->m_done;
+                }
+
+                // Only an Interrupt() returns early while processes are running
+                if (!pending)
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    /**********************************************************************************/
+    //! Run until the next process has exited and been reaped. Processes are returned
+    //! in the order they were reaped, each once. A process whose timeout passes has
+    //! its process group killed.
+    //! \returns Index of the process, or npos once no process is left running or
+    //!          when Interrupt() was called
+    //! \throws     SCXInternalErrorException       Failure to communicate with a process
+    size_t SCXProcessSupervisor::RunUntilExit()
+    {
+        std::vector<struct pollfd> fds;
+        std::vector<size_t> owners;             // Entry each descriptor belongs to
+
+        for (;;)
+        {
+            if (!m_exited.empty())
+            {
+                size_t index = m_exited.front();
+                m_exited.pop_front();
+                return index;
+            }
+
+            fds.clear();
+            owners.clear();
+
+            scxulong now = MonotonicMilliseconds();
+            int timeout = -1;
+            size_t pending = 0;
+
+            for (size_t i = 0; i < m_entries.size(); ++i)
+            {
+                Entry& entry = m_entries[i];
+                if (entry.m_done)
+                {
+                    continue;
+                }
+                ++pending;
+
+                SCXProcess& process = *entry.m_process;
+                if (0 != entry.m_deadline && !entry.m_killed)
+                {
+                    if (now >= entry.m_deadline)
+                    {
+                        process.Kill();
+                        entry.m_killed = true;
+                    }
+                    else
+                    {
+                        timeout = ShortestTimeout(timeout, entry.m_deadline - now);
+                    }
+                }
+
+                struct pollfd fd;
+                fd.revents = 0;
+                if (process.m_stdinActive)
+                {
+                    fd.fd = process.m_inForChild[SCXProcess::W];
+                    fd.events = POLLOUT;
+                    fds.push_back(fd);
+                    owners.push_back(i);
+                }
+                if (process.m_stdoutActive)
+                {
+                    fd.fd = process.m_outForChild[SCXProcess::R];
+                    fd.events = POLLIN;
+                    fds.push_back(fd);
+                    owners.push_back(i);
+                }
+                if (process.m_stderrActive)
+                {
+                    fd.fd = process.m_errForChild[SCXProcess::R];
+                    fd.events = POLLIN;
+                    fds.push_back(fd);
+                    owners.push_back(i);
+                }
+                if (entry.m_pidfd >= 0)
+                {
+                    fd.fd = entry.m_pidfd;
+                    fd.events = POLLIN;
+                    fds.push_back(fd);
+                    owners.push_back(i);
+                }
+                else
+                {
+                    timeout = ShortestTimeout(timeout, c_exitCheckInterval);
+                }
+            }
+
+            if (0 == pending)
+            {
+                return npos;
+            }
+
+            struct pollfd wakeup;
+            wakeup.fd = m_wakeup[0];
+            wakeup.events = POLLIN;
+            wakeup.revents = 0;
+            fds.push_back(wakeup);
+            owners.push_back(npos);
+
+            int pollStatus = poll(fds.empty() ? 0 : &fds[0], static_cast<nfds_t>(fds.size()), timeout);
+            if (pollStatus < 0)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                throw SCXInternalErrorException(UnexpectedErrno(L"Process communication failed", errno), SCXSRCLOCATION);
+            }
+
+            bool interrupted = false;
+            for (size_t k = 0; k < fds.size(); ++k)
+            {
+                if (0 == fds[k].revents)
+                {
+                    continue;
+                }
+
+                if (npos == owners[k])
+                {
+                    char drain[64];
+                    while (read(m_wakeup[0], drain, sizeof(drain)) > 0)
+                    {
+                    }
+                    interrupted = true;
+                    continue;
+                }
+
+                Entry& entry = m_entries[owners[k]];
+                SCXProcess& process = *entry.m_process;
+                bool closed = 0 != (fds[k].revents & (POLLERR | POLLHUP | POLLNVAL));
+
+                if (fds[k].fd == process.m_inForChild[SCXProcess::W])
+                {
+                    if (fds[k].revents & POLLOUT)
+                    {
+                        process.m_stdinActive = process.SendInput(*entry.m_stdin);
+                    }
+                    if (closed)
+                    {
+                        process.m_stdinActive = false;
+                    }
+                }
+                else if (fds[k].fd == process.m_outForChild[SCXProcess::R])
+                {
+                    if (fds[k].revents & POLLIN)
+                    {
+                        process.ReadToStream(fds[k].fd, *entry.m_stdout);
+                    }
+                    if (closed)
+                    {
+                        process.m_stdoutActive = false;
+                    }
+                }
+                else if (fds[k].fd == process.m_errForChild[SCXProcess::R])
+                {
+                    if (fds[k].revents & POLLIN)
+                    {
+                        process.ReadToStream(fds[k].fd, *entry.m_stderr);
+                    }
+                    if (closed)
+                    {
+                        process.m_stderrActive = false;
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < m_entries.size(); ++i)
+            {
+                if (!m_entries[i].m_done && 0 != m_entries[i].m_process->DoWaitPID(NULL, false))
+                {
+                    Reap(m_entries[i]);
+                    m_exited.push_back(i);
+                }
+            }
+
+            if (interrupted && m_exited.empty())
+            {
+                return npos;
+            }
+        }
+    }
+
+    /**********************************************************************************/
+    //! Make RunUntilExit() return npos now, or on its next call if it is not running.
+    //! Safe to call from any thread, e.g. after queuing another process to be added.
+    void SCXProcessSupervisor::Interrupt()
+    {
+        const char wake = 0;
+        if (write(m_wakeup[1], &wake, 1) < 0 && EAGAIN != errno)
+        {
+            throw SCXInternalErrorException(UnexpectedErrno(L"Failed to wake up the supervisor", errno), SCXSRCLOCATION);
+        }
+    }
+
+    /**********************************************************************************/
+    //! Collect what an exited process left in its pipes and record its status
+    //! \param[in]  entry       The exited process
+    void SCXProcessSupervisor::Reap(Entry& entry)
+    {
+        SCXProcess& process = *entry.m_process;
+
+        // The pipes may still hold output, or be held open by a grandchild;
+        // take what is there without waiting for more
+        if (process.m_stdoutActive)
+        {
+            process.ReadToStream(process.m_outForChild[SCXProcess::R], *entry.m_stdout);
+        }
+        if (process.m_stderrActive)
+        {
+            process.ReadToStream(process.m_errForChild[SCXProcess::R], *entry.m_stderr);
+        }
+
+        process.DoWaitPID(&entry.m_status, false);
+        entry.m_done = true;
+
+        if (entry.m_pidfd >= 0)
+        {
+            close(entry.m_pidfd);
+            entry.m_pidfd = -1;
+        }
+    }
+
+    /**********************************************************************************/
+    //! Exit code of a process after Run()
+    //! \param[in]  index       As returned by Add()
+    //! \returns The exit code, or -1 if the process was interrupted
+    int SCXProcessSupervisor::GetReturnCode(size_t index) const
+    {
+        const Entry& entry = m_entries.at(index);
+        if (!entry.m_done || !WIFEXITED(entry.m_status))
+        {
+            return -1;
+        }
+        return WEXITSTATUS(entry.m_status);
+    }
+
+    /**********************************************************************************/
+    //! Did a process terminate without an exit code, e.g. killed at its timeout?
+    //! \param[in]  index       As returned by Add()
+    bool SCXProcessSupervisor::WasInterrupted(size_t index) const
+    {
+        const Entry& entry = m_entries.at(index);
+        return !entry.m_done || !WIFEXITED(entry.m_status);
+    }
+} /* namespace SCXCoreLib */
+
+#endif /* SCX_UNIX */
+
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -0,0 +1,452 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+    \file
+
+    \brief       Implementation for a binary scxlog backend.
+
+    \date        2026-10-18 22:10:00
+
+*/
+/*----------------------------------------------------------------------------*/
+
+#include "scxlogbinarybackend.h"
+#include "scxloglineformatter.h"
+#include "scxlogrecord.h"
+#include <scxcorelib/scxlogitem.h>
+#include <scxcorelib/stringaid.h>
+#include <scxcorelib/scxfile.h>
+#include <scxcorelib/scxfilesystem.h>
+#include <scxcorelib/scxproductdependencies.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <istream>
+#include <ostream>
+#include <unistd.h>
+#include <vector>
+
+using namespace SCXCoreLib::SCXLogRecord;
+
+namespace SCXCoreLib
+{
+    const char SCXLogBinaryBackend::c_Magic[8] = { '\x7f', 'S', 'C', 'X', 'B', 'L', 'O', 'G' };
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Default constructor.
+    */
+    SCXLogBinaryBackend::SCXLogBinaryBackend() :
+        SCXLogBackend(),
+        m_FilePath(),
+        m_FileDescriptor(-1),
+        m_LogFileRunningNumber(1),
+        m_procStartTimestamp(SCXCalendarTime::CurrentUTC()),
+        m_NextLocationId(0),
+        m_ProcessId(0)
+    {
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Constructor with filepath.
+        \param[in] filePath Path to log file.
+    */
+    SCXLogBinaryBackend::SCXLogBinaryBackend(const SCXFilePath& filePath) :
+        SCXLogBackend(),
+        m_FilePath(filePath),
+        m_FileDescriptor(-1),
+        m_LogFileRunningNumber(1),
+        m_procStartTimestamp(SCXCalendarTime::CurrentUTC()),
+        m_NextLocationId(0),
+        m_ProcessId(0)
+    {
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Virtual destructor.
+    */
+    SCXLogBinaryBackend::~SCXLogBinaryBackend()
+    {
+        Close();
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Open the log file for appending and start a section. The file stays
+        closed, and gets no header, if it can not be written to.
+    */
+    void SCXLogBinaryBackend::Open()
+    {
+        m_FileDescriptor = open(SCXFileSystem::EncodePath(m_FilePath).c_str(),
+                                O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0666);
+        if (m_FileDescriptor < 0)
+        {
+            return;
+        }
+
+        StartSection(SCXProcess::GetCurrentProcessID());
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Start a section in the open log file: the log file header, c_Magic,
+        the format version and the process id. The file is closed if it can
+        not be written to.
+        \param[in] processId Process id written in the section.
+    */
+    void SCXLogBinaryBackend::StartSection(SCXProcessId processId)
+    {
+        try {
+            SCXHandle<std::wfstream> stream = SCXFile::OpenWFstream(m_FilePath, std::ios::out|std::ios::app);
+
+            // Write a log file header
+            SCXProductDependencies::WriteLogFileHeader( stream, m_LogFileRunningNumber, m_procStartTimestamp );
+            stream->close();
+        }
+        catch (const SCXFilePathNotFoundException&)
+        {
+            // We get this if we don't have permissions to create or write to this file.
+            // There's not much we can do about this.
+            Close();
+            return;
+        }
+        catch (const SCXUnauthorizedFileSystemAccessException&)
+        {
+            // We get this if we don't have permissions to create or write to this file.
+            // There's not much we can do about this.
+            Close();
+            return;
+        }
+
+        m_ModuleIds.clear();
+        m_LocationIds.clear();
+        m_NextLocationId = 0;
+        m_ProcessId = processId;
+
+        m_Record.assign(c_Magic, sizeof(c_Magic));
+        PutNumber(m_Record, c_Version);
+        PutNumber(m_Record, static_cast<scxulong>(processId));
+        if (!Write())
+        {
+            Close();
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Close the log file, if open.
+    */
+    void SCXLogBinaryBackend::Close()
+    {
+        if (m_FileDescriptor >= 0)
+        {
+            close(m_FileDescriptor);
+            m_FileDescriptor = -1;
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Append m_Record to the log file.
+        \returns false if the file could not be written to.
+    */
+    bool SCXLogBinaryBackend::Write()
+    {
+        const char* data = m_Record.data();
+        size_t remaining = m_Record.size();
+        while (remaining > 0)
+        {
+            ssize_t written = write(m_FileDescriptor, data, remaining);
+            if (written < 0)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                return false;
+            }
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Id of a module in the current section; a module not yet defined gets
+        an eModuleRecord in m_Record.
+    */
+    scxulong SCXLogBinaryBackend::ModuleId(const std::wstring& module)
+    {
+        std::map<std::wstring, scxulong>::const_iterator found = m_ModuleIds.find(module);
+        if (found != m_ModuleIds.end())
+        {
+            return found->second;
+        }
+
+        scxulong id = m_ModuleIds.size();
+        m_ModuleIds[module] = id;
+        PutNumber(m_Record, eModuleRecord);
+        PutNumber(m_Record, id);
+        PutString(m_Record, module);
+        return id;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Id of a source location in the current section; a location not yet
+        defined gets an eLocationRecord in m_Record.
+    */
+    scxulong SCXLogBinaryBackend::LocationId(const SCXCodeLocation& location)
+    {
+        LineIdMap& lines = m_LocationIds[location.GetFile()];
+        LineIdMap::const_iterator found = lines.find(location.GetLine());
+        if (found != lines.end())
+        {
+            return found->second;
+        }
+
+        scxulong id = m_NextLocationId++;
+        lines[location.GetLine()] = id;
+        PutNumber(m_Record, eLocationRecord);
+        PutNumber(m_Record, id);
+        PutNumber(m_Record, location.GetLine());
+        PutString(m_Record, location.GetFile());
+        return id;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        An SCXLogItem is submitted for output to this specific backend.
+        When this method is called from LogThisItem, we are in the scope of a
+        thread lock so there should be no need for one here.
+
+        \param[in] item Log item to be submitted for output.
+    */
+    void SCXLogBinaryBackend::DoLogItem(const SCXLogItem& item)
+    {
+        if (m_FileDescriptor < 0)
+        {
+            Open();
+        }
+        else
+        {
+            // A forked child shares the file; its items go in a section
+            // of its own, carrying its process id
+            SCXProcessId processId = SCXProcess::GetCurrentProcessID();
+            if (processId != m_ProcessId)
+            {
+                StartSection(processId);
+            }
+        }
+        if (m_FileDescriptor < 0)
+        {
+            return;
+        }
+
+        m_Record.clear();
+        scxulong moduleId = ModuleId(item.GetModule());
+        scxulong locationId = LocationId(item.GetLocation());
+
+        PutNumber(m_Record, eItemRecord);
+        PutNumber(m_Record, static_cast<scxulong>(item.GetSeverity()));
+        PutNumber(m_Record, moduleId);
+        PutNumber(m_Record, locationId);
+        PutTimestamp(m_Record, item.GetTimestamp());
+        PutNumber(m_Record, static_cast<scxulong>(item.GetThreadId()));
+        PutString(m_Record, item.GetMessage());
+
+        if (!Write())
+        {
+            // Definitions in m_Record may not have reached the file; start
+            // a new section with the next item rather than refer to them
+            Close();
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+       Handle log rotations that have occurred
+     */
+    void SCXLogBinaryBackend::HandleLogRotate()
+    {
+        m_LogFileRunningNumber++;
+        Close();
+        SCXLogItem item(L"scx.core.providers", eInfo, L"Log rotation complete", 
+                        SCXSRCLOCATION, SCXThread::GetCurrentThreadID());
+        DoLogItem(item);
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        The backend can be configured using key - value pairs.
+
+        \param[in] key Name of property to set.
+        \param[in] value Value of property to set.
+    */
+    void SCXLogBinaryBackend::SetProperty(const std::wstring& key, const std::wstring& value)
+    {
+        if (L"PATH" == key)
+        {
+            m_FilePath.Set(value);
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        This implementation is initialized once the file path is not empty.
+
+        \returns true if m_FilePath is not empty
+    */
+    bool SCXLogBinaryBackend::IsInitialized() const
+    {
+        return m_FilePath.Get().length() != 0;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Get the path to the log file.
+
+        \returns Current path to log file.
+    */
+    const SCXFilePath& SCXLogBinaryBackend::GetFilePath() const
+    {
+        return m_FilePath;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Render a binary log file as SCXLogFileBackend would have written it.
+        Text headers are copied as they are; items become text lines.
+
+        \param[in]  in  Binary log file.
+        \param[out] out Receives the text log.
+        \returns false if the input is not a binary log file, or is cut short.
+    */
+    bool SCXLogBinaryBackend::Decode(std::istream& in, std::ostream& out)
+    {
+        const std::string magic(c_Magic, sizeof(c_Magic));
+        Reader reader(in);
+        SCXLogLineFormatter formatter;
+        std::vector<std::wstring> modules;
+        std::vector<SCXCodeLocation> locations;
+        SCXProcessId processId = 0;
+        bool inSection = false;
+        bool sawSection = false;
+        std::string text;
+        std::string line;
+
+        for (;;)
+        {
+            if (!inSection)
+            {
+                // Copy a header line, unless it is where the records start
+                text.clear();
+                char c;
+                while (in.get(c))
+                {
+                    text += c;
+                    if (text == magic || '\n' == c)
+                    {
+                        break;
+                    }
+                }
+                if (text != magic)
+                {
+                    out << text;
+                    if (!in)
+                    {
+                        return sawSection;
+                    }
+                    continue;
+                }
+
+                scxulong version = reader.Number();
+                processId = static_cast<SCXProcessId>(reader.Number());
+                if (reader.Failed() || version != c_Version)
+                {
+                    return false;
+                }
+                modules.clear();
+                locations.clear();
+                inSection = true;
+                sawSection = true;
+                continue;
+            }
+
+            int type = in.get();
+            if (type == std::char_traits<char>::eof())
+            {
+                return true;
+            }
+
+            if (eModuleRecord == type)
+            {
+                scxulong id = reader.Number();
+                reader.String(text);
+                if (reader.Failed() || id != modules.size())
+                {
+                    return false;
+                }
+                modules.push_back(StrFromUTF8(text));
+            }
+            else if (eLocationRecord == type)
+            {
+                scxulong id = reader.Number();
+                unsigned int lineNumber = static_cast<unsigned int>(reader.Number());
+                reader.String(text);
+                if (reader.Failed() || id != locations.size())
+                {
+                    return false;
+                }
+                locations.push_back(SCXCodeLocation(StrFromUTF8(text), lineNumber));
+            }
+            else if (eItemRecord == type)
+            {
+                SCXLogSeverity severity = static_cast<SCXLogSeverity>(reader.Number());
+                scxulong moduleId = reader.Number();
+                scxulong locationId = reader.Number();
+                SCXCalendarTime timestamp;
+                reader.Timestamp(timestamp);
+                scxulong threadId = reader.Number();
+                reader.String(text);
+                if (reader.Failed() || moduleId >= modules.size() || locationId >= locations.size())
+                {
+                    return false;
+                }
+
+                formatter.Format(line, timestamp, severity,
+                                 modules[static_cast<size_t>(moduleId)],
+                                 locations[static_cast<size_t>(locationId)],
+                                 processId, threadId, StrFromUTF8(text));
+                out << line << '\n';
+            }
+            else
+            {
+                // The text header of the next section
+                in.unget();
+                inSection = false;
+            }
+        }
+    }
+} /* namespace SCXCoreLib */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -0,0 +1,125 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+    \file
+
+    \brief       Definitions for a binary scxlog backend.
+
+    \date        2026-10-18 22:10:00
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef SCXLOGBINARYBACKEND_H
+#define SCXLOGBINARYBACKEND_H
+
+#include "scxlogbackend.h"
+#include <scxcorelib/scxfilepath.h>
+#include <scxcorelib/scxprocess.h>
+#include <scxcorelib/scxtime.h>
+
+#include <iosfwd>
+#include <map>
+#include <string>
+
+namespace SCXCoreLib
+{
+    /*----------------------------------------------------------------------------*/
+    /**
+        File backend that writes log items as compact binary records instead
+        of text lines; Decode() renders such a file in the text format of
+        SCXLogFileBackend.
+
+        The file is a sequence of sections, one for each time the file is
+        opened and one for each forked child that goes on logging to it. A
+        section starts with the text log file header followed by c_Magic, the
+        format version and the process id. Then come records, each a record
+        type followed by its fields:
+
+        - eModuleRecord: id, module name
+        - eLocationRecord: id, line number, source file name
+        - eItemRecord: severity, module id, location id, year, month, day,
+          hour, minute, microsecond of the minute, number of decimals,
+          minutes from UTC, thread id, message
+
+        A module or location is defined by a record of its own the first time
+        an item refers to it within a section; ids count from 0 in each
+        section. Numbers are unsigned LEB128 (minutes from UTC zigzag encoded
+        first), strings are their length in bytes followed by UTF-8. Each log
+        item, with the definitions it needs, is appended with a single write.
+        Records refer to the section before them, so a process and its forked
+        child can not both go on logging to the same file.
+    */
+    class SCXLogBinaryBackend : public SCXLogBackend
+    {
+    public:
+        static const char c_Magic[8];           //!< Marks the end of the text header of a section
+        static const scxulong c_Version = 1;    //!< Format version written after c_Magic
+
+        //! Record types
+        enum RecordType
+        {
+            eModuleRecord = 1,
+            eLocationRecord = 2,
+            eItemRecord = 3
+        };
+
+        SCXLogBinaryBackend();
+        SCXLogBinaryBackend(const SCXFilePath& filePath);
+
+        virtual ~SCXLogBinaryBackend();
+
+        virtual void SetProperty(const std::wstring& key, const std::wstring& value);
+        virtual bool IsInitialized() const;
+
+        virtual const SCXFilePath& GetFilePath() const;
+
+        static bool Decode(std::istream& in, std::ostream& out);
+    private:
+        SCXLogBinaryBackend(const SCXLogBinaryBackend&);             //!< Prevent copying
+        SCXLogBinaryBackend& operator=(const SCXLogBinaryBackend&);  //!< Prevent assignment
+
+        void DoLogItem(const SCXLogItem& item);
+        virtual void HandleLogRotate();
+        void Open();
+        void Close();
+        void StartSection(SCXProcessId processId);
+        bool Write();
+        scxulong ModuleId(const std::wstring& module);
+        scxulong LocationId(const SCXCodeLocation& location);
+
+        //! Location ids by line number
+        typedef std::map<unsigned int, scxulong> LineIdMap;
+
+        SCXFilePath m_FilePath;                 //!< Path of log file.
+        int m_FileDescriptor;                   //!< Log file, opened for appending; -1 while closed.
+
+        int m_LogFileRunningNumber;             //!< Keep track of number of rotates
+        SCXCalendarTime m_procStartTimestamp;   //!< Timestamp when first log from process was made, regardless of rotations
+
+        std::string m_Record;                   //!< Records being written; keeps its capacity between items
+        std::map<std::wstring, scxulong> m_ModuleIds;       //!< Modules defined in the current section
+        std::map<std::wstring, LineIdMap> m_LocationIds;    //!< Locations defined in the current section, by file
+        scxulong m_NextLocationId;              //!< Id of the next location to be defined
+        SCXProcessId m_ProcessId;               //!< Process id written in the current section
+    };
+
+} /* namespace SCXCoreLib */
+#endif /* SCXLOGBINARYBACKEND_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -30,11 +30,15 @@
 #include "scxlogfilebackend.h"
 #include <scxcorelib/scxlogitem.h>
 #include <scxcorelib/stringaid.h>
+#include <scxcorelib/scxfilesystem.h>
 #include <scxcorelib/scxproductdependencies.h>
 
+#include <errno.h>
+#include <fcntl.h>
 #include <stdexcept>
 #include <stdlib.h>
 #include <locale.h>
+#include <unistd.h>
 #if defined(SCX_UNIX)
 #include <scxcorelib/scxuser.h>
 #include <wctype.h>
@@ -49,6 +53,7 @@ namespace SCXCoreLib
     SCXLogFileBackend::SCXLogFileBackend() :
         SCXLogBackend(),
         m_FilePath(),
+        m_FileDescriptor(-1),
         m_LogFileRunningNumber(1),
         m_procStartTimestamp(SCXCalendarTime::CurrentUTC())
     {
@@ -62,7 +67,7 @@ namespace SCXCoreLib
     SCXLogFileBackend::SCXLogFileBackend(const SCXFilePath& filePath) :
         SCXLogBackend(),
         m_FilePath(filePath),
-        m_FileStream(0),
+        m_FileDescriptor(-1),
         m_LogFileRunningNumber(1),
         m_procStartTimestamp(SCXCalendarTime::CurrentUTC())
     {
@@ -74,6 +79,7 @@ namespace SCXCoreLib
     */
     SCXLogFileBackend::~SCXLogFileBackend()
     {
+        Close();
     }
 
     /*----------------------------------------------------------------------------*/
@@ -91,6 +97,54 @@ namespace SCXCoreLib
 #endif
     }
 
+    /*----------------------------------------------------------------------------*/
+    /**
+        Open the log file for appending and write the log file header.
+        The file stays closed, and gets no header, if it can not be written to.
+    */
+    void SCXLogFileBackend::Open()
+    {
+        m_FileDescriptor = open(SCXFileSystem::EncodePath(m_FilePath).c_str(),
+                                O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0666);
+        if (m_FileDescriptor < 0)
+        {
+            return;
+        }
+
+        try {
+            SCXHandle<std::wfstream> stream = SCXFile::OpenWFstream(m_FilePath, std::ios::out|std::ios::app);
+
+            // Write a log file header
+            SCXProductDependencies::WriteLogFileHeader( stream, m_LogFileRunningNumber, m_procStartTimestamp );
+            stream->close();
+        }
+        catch (const SCXFilePathNotFoundException&)
+        {
+            // We get this if we don't have permissions to create or write to this file.
+            // There's not much we can do about this.
+            Close();
+        }
+        catch (const SCXUnauthorizedFileSystemAccessException&)
+        {
+            // We get this if we don't have permissions to create or write to this file.
+            // There's not much we can do about this.
+            Close();
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Close the log file, if open.
+    */
+    void SCXLogFileBackend::Close()
+    {
+        if (m_FileDescriptor >= 0)
+        {
+            close(m_FileDescriptor);
+            m_FileDescriptor = -1;
+        }
+    }
+
     /*----------------------------------------------------------------------------*/
     /**
         An SCXLogItem is submitted for output to this specific backend.
@@ -101,30 +155,40 @@ namespace SCXCoreLib
     */
     void SCXLogFileBackend::DoLogItem(const SCXLogItem& item)
     {
-        if (m_FileStream == 0 || ! m_FileStream->is_open())
+        if (m_FileDescriptor < 0)
         {
-            try {
-                m_FileStream = SCXFile::OpenWFstream(m_FilePath, std::ios::out|std::ios::app);
-
-                // Write a log file header
-                SCXProductDependencies::WriteLogFileHeader( m_FileStream, m_LogFileRunningNumber, m_procStartTimestamp );
-            }
-            catch (const SCXFilePathNotFoundException&)
+            Open();
+            if (m_FileDescriptor < 0)
             {
-                // We get this if we don't have permissions to create or write to this file.
-                // There's not much we can do about this.
                 return;
             }
-            catch (const SCXUnauthorizedFileSystemAccessException&)
+        }
+
+        m_Formatter.Format(m_Line, item.GetTimestamp(), item.GetSeverity(), item.GetModule(),
+                           item.GetLocation(), SCXProcess::GetCurrentProcessID(),
+                           static_cast<scxulong>(item.GetThreadId()),
+                           item.GetMessage());
+        m_Line += '\n';
+
+        // With O_APPEND the line lands in the file in one piece; only a
+        // signal or a full disk makes write() take less than all of it
+        const char* data = m_Line.data();
+        size_t remaining = m_Line.size();
+        while (remaining > 0)
+        {
+            ssize_t written = write(m_FileDescriptor, data, remaining);
+            if (written < 0)
             {
-                // We get this if we don't have permissions to create or write to this file.
+                if (EINTR == errno)
+                {
+                    continue;
+                }
                 // There's not much we can do about this.
                 return;
             }
+            data += written;
+            remaining -= static_cast<size_t>(written);
         }
-
-        std::wstring msg = Format(item);
-        SCXProductDependencies::WrtieItemToLog( m_FileStream, item, msg );
     }
 
     /*----------------------------------------------------------------------------*/
@@ -134,8 +198,7 @@ namespace SCXCoreLib
     void SCXLogFileBackend::HandleLogRotate()
     {
         m_LogFileRunningNumber++;
-        m_FileStream->close();
-        m_FileStream = 0;
+        Close();
         SCXLogItem item(L"scx.core.providers", eInfo, L"Log rotation complete", 
                         SCXSRCLOCATION, SCXThread::GetCurrentThreadID());
         DoLogItem(item);
@@ -179,64 +242,5 @@ namespace SCXCoreLib
         return m_FilePath;
     }
 
-    /*----------------------------------------------------------------------------*/
-    /**
-        Log format method.
-
-        \param[in]  item An SCXLogItem to format.
-        \returns    A formatted message:
-                    "<time> <SEVERITY> [<module>:<linenumber>:<processid>:<threadid>] <message>"
-    */
-    const std::wstring SCXLogFileBackend::Format(const SCXLogItem& item) const
-    {
-        static const wchar_t* severityStrings[] = {
-            L"NotSet    ",
-            L"Hysterical",
-            L"Trace     ",
-            L"Info      ",
-            L"Warning   ",
-            L"Error     "
-        };
-
-        std::wstringstream ss;
-
-        ss << item.GetTimestamp().ToExtendedISO8601() << L" ";
-
-        if (item.GetSeverity() > eError)
-        {
-            ss << L"Unknown " << item.GetSeverity();
-        }
-        else
-        {
-            ss << severityStrings[item.GetSeverity()];
-        }
-
-        // JWF -- Try and convert the string.  If this call fails, then we cannot print the string
-        const std::wstring in_message(item.GetMessage());
-        std::wstring message(in_message);
-
-        bool messageHadUnprintable = false;
-        const wchar_t replacementSymbol(L'?');
-        for (size_t i = 0; i < in_message.size(); i++)
-        {
-            wchar_t currentChar = in_message[i];
-
-            if (currentChar < 32 || currentChar > 126)
-            {
-                message[i] = replacementSymbol;
-                messageHadUnprintable = true;
-            }
-        }
-        if (messageHadUnprintable)
-        {
-            message += L" (* Message contained unprintable (?) characters *)";
-        }
-
-        ss << L" [" << item.GetModule() << L":" << item.GetLocation().WhichLine() << L":" << SCXProcess::GetCurrentProcessID() << L":" << item.GetThreadId() << L"] " 
-         << message;
-         // << item.GetMessage();
-
-        return ss.str();
-    }
 } /* namespace SCXCoreLib */
 /*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
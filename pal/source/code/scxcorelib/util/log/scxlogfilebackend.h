@@ -30,16 +30,23 @@
 #define SCXLOGFILEBACKEND_H
 
 #include "scxlogbackend.h"
+#include "scxloglineformatter.h"
 #include <scxcorelib/scxfilepath.h>
 #include <scxcorelib/scxfile.h>
 #include <scxcorelib/scxprocess.h>
 #include <scxcorelib/scxthread.h>
 
+#include <string>
+
 namespace SCXCoreLib
 {
     /*----------------------------------------------------------------------------*/
     /**
         Simple file backend.
+
+        Lines are formatted by an SCXLogLineFormatter into a buffer that is
+        reused from line to line, and each line is appended to the file with
+        a single write.
     */
     class SCXLogFileBackend : public SCXLogBackend
     {
@@ -54,16 +61,23 @@ namespace SCXCoreLib
 
         virtual const SCXFilePath& GetFilePath() const;
     private:
+        SCXLogFileBackend(const SCXLogFileBackend&);             //!< Prevent copying
+        SCXLogFileBackend& operator=(const SCXLogFileBackend&);  //!< Prevent assignment
+
         void DoLogItem(const SCXLogItem& item);
         void AddUserNameToFilePath();
         virtual void HandleLogRotate();
-        const std::wstring Format(const SCXLogItem& item) const;
+        void Open();
+        void Close();
 
         SCXFilePath m_FilePath; //!< Path of log file.
-        SCXHandle<std::wfstream> m_FileStream; //!< Stream to log file.
+        int m_FileDescriptor;   //!< Log file, opened for appending; -1 while closed.
 
         int m_LogFileRunningNumber;            //!< Keep track of number of rotates
         SCXCalendarTime m_procStartTimestamp;  //!< Timestamp when first log from process was made, regardless of rotations
+
+        SCXLogLineFormatter m_Formatter;    //!< Formats the lines
+        std::string m_Line;                 //!< Line being written; keeps its capacity between lines
     };
 
 } /* namespace SCXCoreLib */
@@ -29,6 +29,8 @@
 
 #include "scxlogfileconfigurator.h"
 #include "scxlogmediator.h"
+#include "scxlogbinarybackend.h"
+#include "scxlogflightrecorderbackend.h"
 #include "scxlogstdoutbackend.h"
 
 #include <scxcorelib/scxfile.h>
@@ -120,6 +122,7 @@ namespace SCXCoreLib
         }
         if (changed)
         {
+            m_Mediator->InvalidateSeverities();
             ++m_ConfigVersion;
         }
     }
@@ -146,6 +149,7 @@ namespace SCXCoreLib
         }
         if (changed)
         {
+            m_Mediator->InvalidateSeverities();
             ++m_ConfigVersion;
 
             m_MinActiveSeverityThreshold = eSeverityMax;
@@ -166,13 +170,18 @@ namespace SCXCoreLib
     /*----------------------------------------------------------------------------*/
     /**
         Get current config version
-       
+
+        Every severity check of a log handle asks for the version, so it is
+        read without the lock. The version is changed under the lock, after
+        the mediator has been told to invalidate its effective severities;
+        a handle that sees a new version works out its severity anew from
+        the new thresholds.
+
         \returns Current config version.
         
     */
     unsigned int SCXLogFileConfigurator::GetConfigVersion() const
     {
-        SCXThreadLock lock(m_lock);
         return m_ConfigVersion;
     }
 
@@ -242,6 +251,17 @@ namespace SCXCoreLib
         MODULE: WARNING
         MODULE: scx.some.module TRACE
         )
+
+        A BINARY section takes the same keys as a FILE section; the log is
+        written in the format of SCXLogBinaryBackend.
+
+        A RECORDER section configures an SCXLogFlightRecorderBackend, which
+        records every module at every severity; it takes PATH and SIZE, the
+        size of its ring in megabytes:
+        RECORDER (
+        PATH: /var/opt/microsoft/scvmmguestagent/log/scvmm.ring
+        SIZE: 8
+        )
     */
     bool SCXLogFileConfigurator::ParseConfigFile()
     {
@@ -262,6 +282,7 @@ namespace SCXCoreLib
             m_MinActiveSeverityThreshold = CustomLogPolicyFactory()->GetDefaultSeverityThreshold();
         }
 
+        m_Mediator->InvalidateSeverities();
         ++m_ConfigVersion;
 
         return validConfig;
@@ -365,6 +386,16 @@ namespace SCXCoreLib
             backend = new SCXLogStdoutBackend();
             SetSeverityThreshold(backend, L"", CustomLogPolicyFactory()->GetDefaultSeverityThreshold());
         }
+        if (L"BINARY (" == name)
+        {
+            backend = new SCXLogBinaryBackend();
+            SetSeverityThreshold(backend, L"", CustomLogPolicyFactory()->GetDefaultSeverityThreshold());
+        }
+        if (L"RECORDER (" == name)
+        {
+            backend = new SCXLogFlightRecorderBackend();
+            m_MinActiveSeverityThreshold = eHysterical;
+        }
         return backend;
     }
 
@@ -76,7 +76,7 @@ namespace SCXCoreLib
         SCXHandle<SCXLogMediator> m_Mediator; //!< Mediator to configure.
         BackendList m_Backends; //!< Configured backends.
         const SCXFilePath m_ConfigFilePath; //!< File path of config file.
-        unsigned int m_ConfigVersion; //!< Current config version.
+        volatile unsigned int m_ConfigVersion; //!< Current config version; read without the lock.
         SCXThreadLockHandle m_lock; //!< Thread lock synchronizing access to internal data.
         scxulong m_ConfigRefreshRate; //!< The interval the configuration thread checks for new configuration.
         SCXHandle<SCXThread> m_ConfigUpdateThread; //!< Pointer to thread.
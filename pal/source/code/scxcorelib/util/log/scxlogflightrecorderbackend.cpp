@@ -0,0 +1,493 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+    \file
+
+    \brief       Implementation for a flight recorder scxlog backend.
+
+    \date        2026-10-18 23:00:00
+
+*/
+/*----------------------------------------------------------------------------*/
+
+#include "scxlogflightrecorderbackend.h"
+#include "scxloglineformatter.h"
+#include "scxlogrecord.h"
+#include <scxcorelib/scxlogitem.h>
+#include <scxcorelib/stringaid.h>
+#include <scxcorelib/scxfilesystem.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <pthread.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace SCXCoreLib::SCXLogRecord;
+
+namespace
+{
+    /*----------------------------------------------------------------------------*/
+    /**
+        Copy bytes into a ring at a position, wrapping around at its end.
+    */
+    void ToRing(char* ring, scxulong capacity, scxulong position, const char* data, size_t size)
+    {
+        size_t offset = static_cast<size_t>(position % capacity);
+        size_t first = std::min(size, static_cast<size_t>(capacity) - offset);
+        memcpy(ring + offset, data, first);
+        memcpy(ring, data + first, size - first);
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Copy bytes out of a ring from a position, wrapping around at its end.
+    */
+    void FromRing(const char* ring, scxulong capacity, scxulong position, char* data, size_t size)
+    {
+        size_t offset = static_cast<size_t>(position % capacity);
+        size_t first = std::min(size, static_cast<size_t>(capacity) - offset);
+        memcpy(data, ring + offset, first);
+        memcpy(data + first, ring, size - first);
+    }
+
+    SCXCoreLib::SCXProcessId s_processId = 0;                   //!< Id of this process, recorded with every item
+    pthread_once_t s_processIdOnce = PTHREAD_ONCE_INIT;         //!< Initializes s_processId once
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Set s_processId; run when the first recorder is made and, as a fork
+        handler, in every forked child, so that recording an item needs no
+        system call to get the id.
+    */
+    void UpdateProcessId()
+    {
+        s_processId = SCXCoreLib::SCXProcess::GetCurrentProcessID();
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Set s_processId and keep it up to date in forked children.
+    */
+    void InitProcessId()
+    {
+        UpdateProcessId();
+        pthread_atfork(0, 0, UpdateProcessId);
+    }
+}
+
+namespace SCXCoreLib
+{
+    const char SCXLogFlightRecorderBackend::c_Magic[8] = { '\x7f', 'S', 'C', 'X', 'R', 'I', 'N', 'G' };
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Default constructor.
+    */
+    SCXLogFlightRecorderBackend::SCXLogFlightRecorderBackend() :
+        SCXLogBackend(),
+        m_Lock(ThreadLockHandleGet()),
+        m_FilePath(),
+        m_Capacity(c_DefaultSize << 20),
+        m_OpenFailed(false),
+        m_Mapping(0),
+        m_MappingSize(0),
+        m_Header(0),
+        m_Ring(0)
+    {
+        pthread_once(&s_processIdOnce, InitProcessId);
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Constructor with filepath and size.
+        \param[in] filePath Path to the file.
+        \param[in] megabytes Size of the ring.
+    */
+    SCXLogFlightRecorderBackend::SCXLogFlightRecorderBackend(const SCXFilePath& filePath,
+                                                             scxulong megabytes /*= c_DefaultSize*/) :
+        SCXLogBackend(),
+        m_Lock(ThreadLockHandleGet()),
+        m_FilePath(filePath),
+        m_Capacity(megabytes << 20),
+        m_OpenFailed(false),
+        m_Mapping(0),
+        m_MappingSize(0),
+        m_Header(0),
+        m_Ring(0)
+    {
+        pthread_once(&s_processIdOnce, InitProcessId);
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Virtual destructor.
+    */
+    SCXLogFlightRecorderBackend::~SCXLogFlightRecorderBackend()
+    {
+        Close();
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Map the file, creating it with room for the whole ring up front so that
+        writing to the mapping can not fail for want of disk space. The records
+        in the file are kept if its header matches the configuration; else the
+        ring starts out empty. If the file can not be mapped, no more attempts
+        are made and items are dropped.
+    */
+    void SCXLogFlightRecorderBackend::Open()
+    {
+        m_OpenFailed = true;
+
+        int fd = open(SCXFileSystem::EncodePath(m_FilePath).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+        if (fd < 0)
+        {
+            return;
+        }
+
+        const size_t size = sizeof(Header) + static_cast<size_t>(m_Capacity);
+        struct stat status;
+        if (0 != fstat(fd, &status) ||
+            (static_cast<size_t>(status.st_size) != size &&
+             (0 != ftruncate(fd, 0) || 0 != posix_fallocate(fd, 0, static_cast<off_t>(size)))))
+        {
+            close(fd);
+            return;
+        }
+
+        void* mapping = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (MAP_FAILED == mapping)
+        {
+            return;
+        }
+
+        m_Mapping = mapping;
+        m_MappingSize = size;
+        m_Header = static_cast<Header*>(mapping);
+        m_Ring = static_cast<char*>(mapping) + sizeof(Header);
+        m_OpenFailed = false;
+
+        if (0 != memcmp(m_Header->m_Magic, c_Magic, sizeof(c_Magic)) ||
+            c_Version != m_Header->m_Version ||
+            sizeof(Header) != m_Header->m_HeaderSize ||
+            m_Capacity != m_Header->m_Capacity ||
+            m_Header->m_Tail > m_Header->m_Head ||
+            m_Header->m_Head - m_Header->m_Tail > m_Capacity)
+        {
+            m_Header->m_Version = c_Version;
+            m_Header->m_HeaderSize = sizeof(Header);
+            m_Header->m_Capacity = m_Capacity;
+            m_Header->m_Tail = 0;
+            m_Header->m_Head = 0;
+            memcpy(m_Header->m_Magic, c_Magic, sizeof(c_Magic));
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Unmap the file, if mapped. The kernel writes it back in its own time;
+        nothing is lost if the process dies without getting here.
+    */
+    void SCXLogFlightRecorderBackend::Close()
+    {
+        if (0 != m_Mapping)
+        {
+            munmap(m_Mapping, m_MappingSize);
+            m_Mapping = 0;
+            m_Header = 0;
+            m_Ring = 0;
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Move the tail past the oldest records until a record of a size fits
+        in the ring. A record size that runs past the head can only be the
+        result of damage to the file, and empties the ring.
+
+        \param[in] size Size of the record, including its size field.
+    */
+    void SCXLogFlightRecorderBackend::MakeRoom(scxulong size)
+    {
+        const scxulong head = m_Header->m_Head;
+        scxulong tail = m_Header->m_Tail;
+        while (head + size - tail > m_Capacity)
+        {
+            unsigned int length;
+            FromRing(m_Ring, m_Capacity, tail, reinterpret_cast<char*>(&length), sizeof(length));
+            tail += sizeof(length) + length;
+            if (tail > head)
+            {
+                tail = head;
+            }
+        }
+
+        // The tail must have moved before the bytes it gave up are overwritten
+        m_Header->m_Tail = tail;
+        __sync_synchronize();
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Every item is recorded, whatever its severity.
+
+        \param[in] item Item to send to log.
+    */
+    void SCXLogFlightRecorderBackend::LogThisItem(const SCXLogItem& item)
+    {
+        SCXThreadLock lock(m_Lock);
+        DoLogItem(item);
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Record an item: encode it, make room for it, copy it into the ring and
+        then publish it by moving the head. An item too large for the ring is
+        dropped.
+
+        \param[in] item Log item to record.
+    */
+    void SCXLogFlightRecorderBackend::DoLogItem(const SCXLogItem& item)
+    {
+        if (0 == m_Mapping)
+        {
+            if (m_OpenFailed || !IsInitialized())
+            {
+                return;
+            }
+            Open();
+            if (0 == m_Mapping)
+            {
+                return;
+            }
+        }
+
+        const SCXCodeLocation& location = item.GetLocation();
+        unsigned int length = 0;
+        m_Record.assign(sizeof(length), '\0');
+        PutNumber(m_Record, static_cast<scxulong>(item.GetSeverity()));
+        PutNumber(m_Record, static_cast<scxulong>(s_processId));
+        PutNumber(m_Record, static_cast<scxulong>(item.GetThreadId()));
+        PutTimestamp(m_Record, item.GetTimestamp());
+        PutNumber(m_Record, location.GotInfo() ? static_cast<scxulong>(location.GetLine()) + 1 : 0);
+        PutString(m_Record, item.GetModule());
+        PutString(m_Record, item.GetMessage());
+
+        if (m_Record.size() > m_Capacity)
+        {
+            return;
+        }
+        length = static_cast<unsigned int>(m_Record.size() - sizeof(length));
+        memcpy(&m_Record[0], &length, sizeof(length));
+
+        MakeRoom(m_Record.size());
+        const scxulong head = m_Header->m_Head;
+        ToRing(m_Ring, m_Capacity, head, m_Record.data(), m_Record.size());
+
+        // The record must be in place before the head moves past it
+        __sync_synchronize();
+        m_Header->m_Head = head + m_Record.size();
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+       The ring does not grow, so there is nothing to rotate.
+     */
+    void SCXLogFlightRecorderBackend::HandleLogRotate()
+    {
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        The recorder records every module down to hysterical.
+
+        \param[in] module Log module to retrieve severity for.
+        \returns eHysterical
+    */
+    SCXLogSeverity SCXLogFlightRecorderBackend::GetEffectiveSeverity(const std::wstring& /*module*/) const
+    {
+        return eHysterical;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Thresholds do not apply to the recorder.
+
+        \returns false; nothing changes.
+    */
+    bool SCXLogFlightRecorderBackend::SetSeverityThreshold(const std::wstring& /*module*/,
+                                                           SCXLogSeverity /*severity*/)
+    {
+        return false;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Thresholds do not apply to the recorder.
+
+        \returns false; nothing changes.
+    */
+    bool SCXLogFlightRecorderBackend::ClearSeverityThreshold(const std::wstring& /*module*/)
+    {
+        return false;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        \returns eHysterical
+    */
+    SCXLogSeverity SCXLogFlightRecorderBackend::GetMinActiveSeverityThreshold() const
+    {
+        return eHysterical;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        The backend can be configured using key - value pairs: PATH, the file
+        to map, and SIZE, the size of the ring in megabytes. A SIZE that is not
+        a positive number is ignored.
+
+        \param[in] key Name of property to set.
+        \param[in] value Value of property to set.
+    */
+    void SCXLogFlightRecorderBackend::SetProperty(const std::wstring& key, const std::wstring& value)
+    {
+        if (L"PATH" == key)
+        {
+            m_FilePath.Set(value);
+        }
+        else if (L"SIZE" == key)
+        {
+            try
+            {
+                scxulong megabytes = StrToULong(value);
+                if (megabytes > 0)
+                {
+                    m_Capacity = megabytes << 20;
+                }
+            }
+            catch (const SCXNotSupportedException&)
+            {
+            }
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        This implementation is initialized once the file path is not empty.
+
+        \returns true if m_FilePath is not empty
+    */
+    bool SCXLogFlightRecorderBackend::IsInitialized() const
+    {
+        return m_FilePath.Get().length() != 0;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Get the path to the file.
+
+        \returns Current path to the file.
+    */
+    const SCXFilePath& SCXLogFlightRecorderBackend::GetFilePath() const
+    {
+        return m_FilePath;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Render the records in a flight recorder file, oldest first, as
+        SCXLogFileBackend would have written them.
+
+        \param[in]  in  Flight recorder file.
+        \param[out] out Receives the text log.
+        \returns false if the input is not a flight recorder file, or is damaged.
+    */
+    bool SCXLogFlightRecorderBackend::Decode(std::istream& in, std::ostream& out)
+    {
+        const std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        Header header;
+        if (file.size() < sizeof(header))
+        {
+            return false;
+        }
+        memcpy(&header, file.data(), sizeof(header));
+        if (0 != memcmp(header.m_Magic, c_Magic, sizeof(c_Magic)) ||
+            c_Version != header.m_Version ||
+            sizeof(header) != header.m_HeaderSize ||
+            0 == header.m_Capacity ||
+            file.size() - sizeof(header) < header.m_Capacity ||
+            header.m_Tail > header.m_Head ||
+            header.m_Head - header.m_Tail > header.m_Capacity)
+        {
+            return false;
+        }
+
+        std::string records(static_cast<size_t>(header.m_Head - header.m_Tail), '\0');
+        if (!records.empty())
+        {
+            FromRing(file.data() + sizeof(header), header.m_Capacity, header.m_Tail, &records[0], records.size());
+        }
+
+        std::istringstream stream(records);
+        Reader reader(stream);
+        SCXLogLineFormatter formatter;
+        std::string module;
+        std::string message;
+        std::string line;
+
+        while (stream.peek() != std::char_traits<char>::eof())
+        {
+            unsigned int length;
+            stream.read(reinterpret_cast<char*>(&length), sizeof(length));
+            const std::streampos end = stream.tellg() + static_cast<std::streamoff>(length);
+
+            SCXLogSeverity severity = static_cast<SCXLogSeverity>(reader.Number());
+            SCXProcessId processId = static_cast<SCXProcessId>(reader.Number());
+            scxulong threadId = reader.Number();
+            SCXCalendarTime timestamp;
+            reader.Timestamp(timestamp);
+            scxulong lineNumber = reader.Number();
+            reader.String(module);
+            reader.String(message);
+            if (!stream || reader.Failed() || stream.tellg() != end)
+            {
+                return false;
+            }
+
+            // Only the line number of a location is part of a log line
+            formatter.Format(line, timestamp, severity, StrFromUTF8(module),
+                             0 == lineNumber ? SCXCodeLocation()
+                                             : SCXCodeLocation(L"-", static_cast<unsigned int>(lineNumber - 1)),
+                             processId, threadId, StrFromUTF8(message));
+            out << line << '\n';
+        }
+        return true;
+    }
+} /* namespace SCXCoreLib */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
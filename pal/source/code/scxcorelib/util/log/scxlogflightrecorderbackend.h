@@ -0,0 +1,124 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+    \file
+
+    \brief       Contains the definition of a flight recorder scxlog backend.
+
+    \date        2026-10-18 23:00:00
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef SCXLOGFLIGHTRECORDERBACKEND_H
+#define SCXLOGFLIGHTRECORDERBACKEND_H
+
+#include "scxlogbackend.h"
+#include <scxcorelib/scxfilepath.h>
+#include <scxcorelib/scxprocess.h>
+
+#include <iosfwd>
+#include <string>
+
+namespace SCXCoreLib
+{
+    /*----------------------------------------------------------------------------*/
+    /**
+        Backend that keeps the most recent log items, of every module and at
+        every severity down to hysterical, in a circular file mapped into
+        memory. Logging an item copies a record into the mapping and makes no
+        system calls, so the recorder can be left on at all times; what it
+        holds survives a crash or a kill of the process, and is rendered in
+        the text format of SCXLogFileBackend by Decode(). MODULE thresholds
+        configured for the recorder are ignored.
+
+        The file is a header followed by the ring. The header is c_Magic, the
+        format version and the header size as 32 bit numbers, and then the
+        capacity of the ring, the tail and the head as 64 bit numbers, all in
+        native byte order. Tail and head count bytes written since the ring
+        was created; records are kept from tail to head, wrapping around at
+        the end of the file. A record is its size as a 32 bit number followed
+        by the fields of SCXLogRecord: severity, process id, thread id,
+        timestamp, line number plus one (0 if unknown), module and message.
+
+        A new record first moves the tail past the oldest records until there
+        is room for it, then is copied in, and only then is the head moved
+        past it; the records from tail to head are complete at any time.
+        The file is kept when the process starts again, if its size is still
+        the configured one. Only one process may use a file at a time.
+    */
+    class SCXLogFlightRecorderBackend : public SCXLogBackend
+    {
+    public:
+        static const char c_Magic[8];               //!< Start of the file
+        static const unsigned int c_Version = 1;    //!< Format version written after c_Magic
+        static const scxulong c_DefaultSize = 4;    //!< Megabytes the ring holds unless configured
+
+        SCXLogFlightRecorderBackend();
+        SCXLogFlightRecorderBackend(const SCXFilePath& filePath, scxulong megabytes = c_DefaultSize);
+
+        virtual ~SCXLogFlightRecorderBackend();
+
+        virtual void SetProperty(const std::wstring& key, const std::wstring& value);
+        virtual bool IsInitialized() const;
+
+        virtual void LogThisItem(const SCXLogItem& item);
+        virtual SCXLogSeverity GetEffectiveSeverity(const std::wstring& module) const;
+        virtual bool SetSeverityThreshold(const std::wstring& module, SCXLogSeverity severity);
+        virtual bool ClearSeverityThreshold(const std::wstring& module);
+        virtual SCXLogSeverity GetMinActiveSeverityThreshold() const;
+
+        const SCXFilePath& GetFilePath() const;
+
+        static bool Decode(std::istream& in, std::ostream& out);
+    private:
+        SCXLogFlightRecorderBackend(const SCXLogFlightRecorderBackend&);             //!< Prevent copying
+        SCXLogFlightRecorderBackend& operator=(const SCXLogFlightRecorderBackend&);  //!< Prevent assignment
+
+        //! Start of the file, as mapped
+        struct Header
+        {
+            char m_Magic[8];                //!< c_Magic
+            unsigned int m_Version;         //!< c_Version
+            unsigned int m_HeaderSize;      //!< sizeof(Header); the ring follows
+            scxulong m_Capacity;            //!< Size of the ring in bytes
+            volatile scxulong m_Tail;       //!< Position of the oldest record
+            volatile scxulong m_Head;       //!< Position after the newest record
+        };
+
+        void DoLogItem(const SCXLogItem& item);
+        virtual void HandleLogRotate();
+        void Open();
+        void Close();
+        void MakeRoom(scxulong size);
+
+        SCXThreadLockHandle m_Lock;     //!< Serializes writers of the ring
+        SCXFilePath m_FilePath;         //!< Path of the file
+        scxulong m_Capacity;            //!< Configured size of the ring in bytes
+        bool m_OpenFailed;              //!< The file could not be mapped; no more attempts are made
+        void* m_Mapping;                //!< The mapped file; 0 while not mapped
+        size_t m_MappingSize;           //!< Size of m_Mapping
+        Header* m_Header;               //!< Header in m_Mapping
+        char* m_Ring;                   //!< Ring in m_Mapping
+        std::string m_Record;           //!< Record being written; keeps its capacity between items
+    };
+
+} /* namespace SCXCoreLib */
+#endif /* SCXLOGFLIGHTRECORDERBACKEND_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -73,10 +73,13 @@ namespace SCXCoreLib
             // Not initialized so suppress all output through this handle.
             return eSuppress;
         }
-        if (m_configVersion != m_configurator->GetConfigVersion())
+        // The version is read before the severity is worked out, so that a
+        // change made in between makes us work it out again next time
+        unsigned int configVersion = m_configurator->GetConfigVersion();
+        if (m_configVersion != configVersion)
         {
             m_severityThreshold = static_cast<unsigned char> (m_mediator->GetEffectiveSeverity(m_module));
-            m_configVersion = m_configurator->GetConfigVersion();
+            m_configVersion = configVersion;
         }
         return static_cast<SCXLogSeverity> (m_severityThreshold);
     }
@@ -142,8 +145,8 @@ namespace SCXCoreLib
         m_mediator(mediator),
         m_configurator(configurator)
     {
-        m_severityThreshold = static_cast<unsigned char> (m_mediator->GetEffectiveSeverity(m_module));
         m_configVersion = m_configurator->GetConfigVersion();
+        m_severityThreshold = static_cast<unsigned char> (m_mediator->GetEffectiveSeverity(m_module));
     }
 
     /*----------------------------------------------------------------------------*/
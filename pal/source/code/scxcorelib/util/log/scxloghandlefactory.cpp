@@ -31,9 +31,11 @@
 #include <scxcorelib/scxlog.h>
 #include <scxcorelib/scxlogpolicy.h>
 #include "scxlogmediatorsimple.h"
+#include "scxlogmediatorasync.h"
 #include "scxlogfileconfigurator.h"
 #include <signal.h>
 #include <errno.h>
+#include <stdlib.h>
 
 namespace SCXCoreLib
 {
@@ -74,6 +76,16 @@ namespace SCXCoreLib
         return Instance().m_LogConfigurator;
     }
 
+    /*----------------------------------------------------------------------------*/
+    /**
+        Wait until everything logged so far has reached the log backends, e.g.
+        before the process replaces itself with exec.
+    */
+    void SCXLogHandleFactory::Flush()
+    {
+        Instance().m_LogMediator->Flush();
+    }
+
     /*----------------------------------------------------------------------------*/
     /**
         Default constructor.
@@ -85,10 +97,19 @@ namespace SCXCoreLib
         m_LogMediator(0),
         m_LogConfigurator(0)
     {
+#if defined(linux)
+        // Logging threads only queue their items; one thread writes them
+        SCXHandle<SCXLogMediator> m( new SCXLogMediatorAsync() );
+#else
         SCXHandle<SCXLogMediator> m( new SCXLogMediatorSimple() );
+#endif
         m_LogMediator = m;
         m_LogConfigurator =
             new SCXLogFileConfigurator(m, CustomLogPolicyFactory()->GetConfigFileName());
+#if defined(linux)
+        // What is still queued when the process exits is written first
+        atexit(FlushAtExit);
+#endif
 #if !defined(DISABLE_WIN_UNSUPPORTED)  
         InstallLogRotateSupport();
 #endif //!defined(DISABLE_WIN_UNSUPPORTED)  
@@ -115,6 +136,17 @@ namespace SCXCoreLib
         return L"SCXLogHandleFactory";
     }
 
+#if defined(linux)
+    /*----------------------------------------------------------------------------*/
+    /**
+        Flush the log as the process exits.
+    */
+    void SCXLogHandleFactory::FlushAtExit()
+    {
+        Flush();
+    }
+#endif
+
 #if !defined(DISABLE_WIN_UNSUPPORTED)  
     /*----------------------------------------------------------------------------*/
     /**
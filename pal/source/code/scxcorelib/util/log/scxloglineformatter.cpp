@@ -0,0 +1,288 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+    \file
+
+    \brief       Implementation of the formatter for text log lines.
+
+    \date        2026-10-18 22:10:00
+
+*/
+/*----------------------------------------------------------------------------*/
+
+#include "scxloglineformatter.h"
+
+#include <stdlib.h>
+
+namespace
+{
+    //! What each ASCII character is written as in a log message: printable
+    //! characters as themselves, the rest as '?'
+    const char s_MessageCharacters[128 + 1] =
+        "????????????????????????????????"
+        " !\"#$%&'()*+,-./0123456789:;<=>?"
+        "@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_"
+        "`abcdefghijklmnopqrstuvwxyz{|}~?";
+
+    const char* const s_SeverityStrings[] = {
+        "NotSet    ",
+        "Hysterical",
+        "Trace     ",
+        "Info      ",
+        "Warning   ",
+        "Error     "
+    };
+
+    const char s_UnprintableNote[] = " (* Message contained unprintable (?) characters *)";
+}
+
+namespace SCXCoreLib
+{
+    /*----------------------------------------------------------------------------*/
+    /**
+        Constructor.
+    */
+    SCXLogLineFormatter::SCXLogLineFormatter() :
+        m_ProcessIdValue(0),
+        m_ProcessId("0"),
+        m_StampKey(-1)
+    {
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Format a log line; the formatted line replaces the contents of line.
+        Characters of the message that are not printable ASCII are written
+        as '?'.
+
+        \param[out] line      Receives the formatted line, without a newline.
+        \param[in]  timestamp When the item was logged.
+        \param[in]  severity  Severity of the item.
+        \param[in]  module    Module the item was logged to.
+        \param[in]  location  Where the item was logged.
+        \param[in]  processId Process that logged the item.
+        \param[in]  threadId  Thread that logged the item.
+        \param[in]  message   The message.
+    */
+    void SCXLogLineFormatter::Format(std::string& line,
+                                     const SCXCalendarTime& timestamp,
+                                     SCXLogSeverity severity,
+                                     const std::wstring& module,
+                                     const SCXCodeLocation& location,
+                                     SCXProcessId processId,
+                                     scxulong threadId,
+                                     const std::wstring& message)
+    {
+        line.clear();
+
+        FormatTimestamp(line, timestamp);
+        line += ' ';
+
+        if (severity > eError)
+        {
+            line += "Unknown ";
+            AppendUnsigned(line, static_cast<scxulong>(severity));
+        }
+        else
+        {
+            line += s_SeverityStrings[severity];
+        }
+
+        line += " [";
+        AppendUTF8(line, module);
+        line += ':';
+        if (location.GotInfo())
+        {
+            AppendUnsigned(line, location.GetLine());
+        }
+        else
+        {
+            line += "unknown";
+        }
+        line += ':';
+        if (processId != m_ProcessIdValue)
+        {
+            m_ProcessId.clear();
+            AppendUnsigned(m_ProcessId, static_cast<scxulong>(processId));
+            m_ProcessIdValue = processId;
+        }
+        line += m_ProcessId;
+        line += ':';
+        AppendUnsigned(line, threadId);
+        line += "] ";
+
+        // One pass over the message, writing each character as the table says;
+        // characters beyond ASCII are not printable either
+        bool messageHadUnprintable = false;
+        if (!message.empty())
+        {
+            const size_t messageStart = line.size();
+            line.resize(messageStart + message.size());
+            char* out = &line[messageStart];
+            for (size_t i = 0; i < message.size(); i++)
+            {
+                const unsigned long currentChar = static_cast<unsigned long>(message[i]);
+                const char c = currentChar < 128 ? s_MessageCharacters[currentChar] : '?';
+                messageHadUnprintable |= ('?' == c && '?' != currentChar);
+                out[i] = c;
+            }
+        }
+        if (messageHadUnprintable)
+        {
+            line += s_UnprintableNote;
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Append a number in decimal, zero padded to at least width digits.
+    */
+    void SCXLogLineFormatter::AppendUnsigned(std::string& out, scxulong value, size_t width /*= 1*/)
+    {
+        char digits[32];
+        size_t count = 0;
+        do
+        {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0 && count < sizeof(digits));
+        for (; count < width; --width)
+        {
+            out += '0';
+        }
+        while (count > 0)
+        {
+            out += digits[--count];
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Append a wide string encoded as UTF-8; code points that can not be
+        encoded are written as U+FFFD.
+    */
+    void SCXLogLineFormatter::AppendUTF8(std::string& out, const std::wstring& text)
+    {
+        for (std::wstring::const_iterator iter = text.begin(); iter != text.end(); ++iter)
+        {
+            unsigned long c = static_cast<unsigned long>(*iter);
+            if ((c >= 0xD800 && c < 0xE000) || c >= 0x110000)
+            {
+                c = 0xFFFD;
+            }
+
+            if (c < 0x80)
+            {
+                out += static_cast<char>(c);
+            }
+            else if (c < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (c >> 6));
+                out += static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else if (c < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | (c >> 12));
+                out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (c & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | (c >> 18));
+                out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (c & 0x3F));
+            }
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Append a timestamp to a line in extended ISO8601, as
+        SCXCalendarTime::ToExtendedISO8601() formats it. The part up to the
+        second and the offset from UTC are formatted once per second.
+
+        \param[in,out] line  Line to append to.
+        \param[in]  timestamp Timestamp to format.
+    */
+    void SCXLogLineFormatter::FormatTimestamp(std::string& line, const SCXCalendarTime& timestamp)
+    {
+        const scxulong microseconds = static_cast<scxulong>(timestamp.GetSecond() * 1000000 + 0.5);
+        const SCXRelativeTime offset(timestamp.GetOffsetFromUTC());
+        const int minutesFromUTC = offset.GetHours() * 60 + offset.GetMinutes();
+
+        scxlong key = timestamp.GetYear();
+        key = key * 12 + timestamp.GetMonth();
+        key = key * 31 + timestamp.GetDay();
+        key = key * 24 + timestamp.GetHour();
+        key = key * 60 + timestamp.GetMinute();
+        key = key * 61 + static_cast<scxlong>(microseconds / 1000000);
+        key = key * 27 * 60 + (minutesFromUTC + 13 * 60);
+
+        if (key != m_StampKey)
+        {
+            m_StampPrefix.clear();
+            AppendUnsigned(m_StampPrefix, timestamp.GetYear(), 4);
+            m_StampPrefix += '-';
+            AppendUnsigned(m_StampPrefix, timestamp.GetMonth(), 2);
+            m_StampPrefix += '-';
+            AppendUnsigned(m_StampPrefix, timestamp.GetDay(), 2);
+            m_StampPrefix += 'T';
+            AppendUnsigned(m_StampPrefix, timestamp.GetHour(), 2);
+            m_StampPrefix += ':';
+            AppendUnsigned(m_StampPrefix, timestamp.GetMinute(), 2);
+            m_StampPrefix += ':';
+            AppendUnsigned(m_StampPrefix, microseconds / 1000000, 2);
+
+            m_StampZone.clear();
+            if (minutesFromUTC != 0)
+            {
+                const unsigned absMinutesFromUTC = static_cast<unsigned>(abs(minutesFromUTC));
+                m_StampZone += minutesFromUTC >= 0 ? '+' : '-';
+                AppendUnsigned(m_StampZone, absMinutesFromUTC / 60, 2);
+                if (absMinutesFromUTC % 60 != 0)
+                {
+                    m_StampZone += ':';
+                    AppendUnsigned(m_StampZone, absMinutesFromUTC % 60, 2);
+                }
+            }
+            else
+            {
+                m_StampZone += 'Z';
+            }
+            m_StampKey = key;
+        }
+
+        line += m_StampPrefix;
+        const scxdecimalnr decimalCount = timestamp.GetDecimalCount();
+        if (decimalCount > 0)
+        {
+            scxulong fraction = microseconds % 1000000;
+            for (scxdecimalnr i = decimalCount; i < 6; ++i)
+            {
+                fraction /= 10;
+            }
+            line += ',';
+            AppendUnsigned(line, fraction, decimalCount);
+        }
+        line += m_StampZone;
+    }
+} /* namespace SCXCoreLib */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -0,0 +1,81 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+    \file
+
+    \brief       Definition of the formatter for text log lines.
+
+    \date        2026-10-18 22:10:00
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef SCXLOGLINEFORMATTER_H
+#define SCXLOGLINEFORMATTER_H
+
+#include <scxcorelib/scxcmn.h>
+#include <scxcorelib/scxexception.h>
+#include <scxcorelib/scxlog.h>
+#include <scxcorelib/scxprocess.h>
+#include <scxcorelib/scxtime.h>
+
+#include <string>
+
+namespace SCXCoreLib
+{
+    /*----------------------------------------------------------------------------*/
+    /**
+        Formats log lines as the file backend writes them:
+        "<time> <SEVERITY> [<module>:<linenumber>:<processid>:<threadid>] <message>"
+
+        Lines are written as UTF-8 into a buffer of the caller's, so a buffer
+        that is reused keeps its capacity. The process id and the timestamp
+        down to the second are formatted once and reused for as long as they
+        stay the same.
+    */
+    class SCXLogLineFormatter
+    {
+    public:
+        SCXLogLineFormatter();
+
+        void Format(std::string& line,
+                    const SCXCalendarTime& timestamp,
+                    SCXLogSeverity severity,
+                    const std::wstring& module,
+                    const SCXCodeLocation& location,
+                    SCXProcessId processId,
+                    scxulong threadId,
+                    const std::wstring& message);
+
+        static void AppendUnsigned(std::string& out, scxulong value, size_t width = 1);
+        static void AppendUTF8(std::string& out, const std::wstring& text);
+
+    private:
+        void FormatTimestamp(std::string& line, const SCXCalendarTime& timestamp);
+
+        SCXProcessId m_ProcessIdValue;  //!< Process id m_ProcessId was formatted for
+        std::string m_ProcessId;        //!< Process id, formatted
+        scxlong m_StampKey;             //!< Second m_StampPrefix and m_StampZone were formatted for, -1 if none
+        std::string m_StampPrefix;      //!< Timestamp up to and including the second, e.g. "2008-07-23T15:15:20"
+        std::string m_StampZone;        //!< Offset from UTC of the timestamp, e.g. "Z"
+    };
+
+} /* namespace SCXCoreLib */
+#endif /* SCXLOGLINEFORMATTER_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -64,6 +64,14 @@ namespace SCXCoreLib
         */
         virtual bool DeRegisterConsumer(SCXHandle<SCXLogItemConsumerIf> consumer) = 0;
 
+        /*----------------------------------------------------------------------------*/
+        /**
+            Tell the mediator that the severity thresholds of its consumers have
+            changed, so that effective severities it has kept must be worked out
+            anew.
+        */
+        virtual void InvalidateSeverities() = 0;
+
     };
 }
 
@@ -0,0 +1,589 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+    \file
+
+    \brief       Implementation of the asynchronous log mediator class.
+
+    \date        2026-10-18 21:05:00
+
+*/
+/*----------------------------------------------------------------------------*/
+
+#include "scxlogmediatorasync.h"
+#include <scxcorelib/scxlogitem.h>
+#include <scxcorelib/scxdumpstring.h>
+#include <cstddef>
+#include <new>
+#include <set>
+#include <sstream>
+
+#if defined(linux)
+
+#include <pthread.h>
+
+namespace
+{
+    /*----------------------------------------------------------------------------*/
+    /**
+        Read a value written by another thread; what was written before the value
+        is visible after the read.
+    */
+    inline size_t LoadAcquire(const volatile size_t& value)
+    {
+        size_t result = value;
+        __sync_synchronize();
+        return result;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Write a value read by another thread; what was written before is visible
+        to a thread that reads the value.
+    */
+    inline void StoreRelease(volatile size_t& value, size_t newValue)
+    {
+        __sync_synchronize();
+        value = newValue;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Is position a before position b? Positions wrap around.
+    */
+    inline bool Before(size_t a, size_t b)
+    {
+        return static_cast<std::ptrdiff_t>(a - b) < 0;
+    }
+
+    volatile size_t s_forks = 0;                                //!< Forks since the library was loaded, counted in the child
+    pthread_once_t s_forkHandlersOnce = PTHREAD_ONCE_INIT;      //!< Registers the fork handlers once
+    pthread_mutex_t s_instancesLock = PTHREAD_MUTEX_INITIALIZER; //!< Guards s_instances
+}
+
+namespace SCXCoreLib
+{
+    /** Milliseconds the writer sleeps at most; a log rotation is noticed within this time */
+    static const scxulong c_writerWakeInterval = 1000;
+
+    namespace
+    {
+        /*----------------------------------------------------------------------------*/
+        /**
+            Parameters for the writer thread.
+        */
+        class LogMediatorAsyncParam : public SCXThreadParam
+        {
+        public:
+            LogMediatorAsyncParam()
+                : m_mediator(NULL)
+            {}
+
+            SCXLogMediatorAsync* m_mediator;  //!< Mediator whose ring the thread drains.
+        };
+
+        /** Mediators in the process, for the fork handlers; never destroyed */
+        std::set<SCXLogMediatorAsync*>* s_instances = NULL;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Constructor; starts the writer thread.
+
+        \param[in] capacity Items the ring holds; rounded up to a power of two.
+        \param[in] policy What LogThisItem() does when the ring is full.
+    */
+    SCXLogMediatorAsync::SCXLogMediatorAsync(size_t capacity /*= c_defaultCapacity*/,
+                                             OverflowPolicy policy /*= eBlock*/) :
+        m_mask(0),
+        m_policy(policy),
+        m_enqueuePos(0),
+        m_dequeuePos(0),
+        m_writtenPos(0),
+        m_writerIdle(0),
+        m_rotatePending(0),
+        m_dropped(0),
+        m_droppedReported(0),
+        m_writerId(0),
+        m_forks(0),
+        m_restartLock(ThreadLockHandleGet())
+    {
+        size_t size = 2;
+        while (size < capacity)
+        {
+            size <<= 1;
+        }
+
+        m_slots.resize(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            m_slots[i].m_sequence = i;
+            m_slots[i].m_item = NULL;
+        }
+        m_mask = size - 1;
+
+        pthread_once(&s_forkHandlersOnce, RegisterForkHandlers);
+        pthread_mutex_lock(&s_instancesLock);
+        s_instances->insert(this);
+        m_forks = s_forks;
+        StartWriter();
+        pthread_mutex_unlock(&s_instancesLock);
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Destructor; what is left in the ring is passed on before the writer
+        thread stops.
+    */
+    SCXLogMediatorAsync::~SCXLogMediatorAsync()
+    {
+        pthread_mutex_lock(&s_instancesLock);
+        s_instances->erase(this);
+        pthread_mutex_unlock(&s_instancesLock);
+
+        if (LoadAcquire(m_forks) != s_forks)
+        {
+            // The writer belongs to the parent process
+            RestartWriter();
+        }
+        if (m_writer->IsAlive())
+        {
+            m_writer->RequestTerminate();
+            m_writer->Wait();
+        }
+
+        // Items logged while the writer was stopping
+        Drain();
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Log a message. The item is copied into the ring and passed on to the
+        consumers by the writer thread. This entry point is thread safe.
+
+        \param[in] item Log item to add to the log mediator.
+    */
+    void SCXLogMediatorAsync::LogThisItem(const SCXLogItem& item)
+    {
+        if (LoadAcquire(m_forks) != s_forks)
+        {
+            RestartWriter();
+        }
+
+        SCXLogItem* copy = new SCXLogItem(item);
+
+        while ( ! TryEnqueue(copy))
+        {
+            // The writer cannot wait for itself to make room
+            if (eDrop == m_policy || SCXThread::GetCurrentThreadID() == m_writerId)
+            {
+                delete copy;
+                __sync_fetch_and_add(&m_dropped, 1);
+                return;
+            }
+
+            WakeWriter(true);
+            SCXThread::Sleep(1);
+        }
+
+        WakeWriter(false);
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Handle log rotations that have occurred. Called from a signal handler, so
+        this only leaves a note for the writer thread, which passes the rotation
+        on to the consumers between items.
+     */
+    void SCXLogMediatorAsync::HandleLogRotate()
+    {
+        m_rotatePending = 1;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Wait until the items logged so far have reached the consumers, e.g.
+        before the process exits or replaces itself.
+     */
+    void SCXLogMediatorAsync::Flush()
+    {
+        if (LoadAcquire(m_forks) != s_forks)
+        {
+            RestartWriter();
+        }
+        if (SCXThread::GetCurrentThreadID() == m_writerId)
+        {
+            return;
+        }
+
+        size_t target = LoadAcquire(m_enqueuePos);
+        while (Before(LoadAcquire(m_writtenPos), target) && m_writer->IsAlive())
+        {
+            WakeWriter(true);
+            SCXThread::Sleep(1);
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Number of items dropped because the ring was full.
+
+        \returns Items dropped since the mediator was created.
+    */
+    scxulong SCXLogMediatorAsync::GetDroppedCount() const
+    {
+        return LoadAcquire(m_dropped);
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Start the writer thread.
+    */
+    void SCXLogMediatorAsync::StartWriter()
+    {
+        SCXHandle<LogMediatorAsyncParam> p( new LogMediatorAsyncParam() );
+        p->m_mediator = this;
+        m_writer = new SCXThread(WriterThreadBody, p);
+        m_writerId = m_writer->GetThreadID();
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Start a writer thread in a process forked since the writer was started;
+        the first thread to get here after the fork does so.
+    */
+    void SCXLogMediatorAsync::RestartWriter()
+    {
+        SCXThreadLock lock(m_restartLock);
+        size_t forks = s_forks;
+        if (m_forks == forks)
+        {
+            return;
+        }
+
+        // The thread m_writer refers to exists only in the parent, and its
+        // thread id may be reused here: it must be neither waited for nor
+        // detached, so its SCXThread is left behind
+        new SCXHandle<SCXThread>(m_writer);
+        StartWriter();
+        StoreRelease(m_forks, forks);
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Bring the ring to a state the next writer can go on from. In the child
+        just after a fork, where no other thread runs, the threads of the parent
+        may have been stopped in the middle of taking or putting an item.
+    */
+    void SCXLogMediatorAsync::RepairAfterFork()
+    {
+        // The writer freed the slot but did not get to move past it
+        size_t pos = m_dequeuePos;
+        if (Before(pos + 1, m_slots[pos & m_mask].m_sequence))
+        {
+            m_dequeuePos = ++pos;
+        }
+
+        // A producer claimed the position but did not get to publish it; the
+        // item, if it got that far, is kept
+        for ( ; Before(pos, m_enqueuePos); ++pos)
+        {
+            Slot& slot = m_slots[pos & m_mask];
+            if (slot.m_sequence != pos + 1)
+            {
+                slot.m_sequence = pos + 1;
+            }
+        }
+
+        m_writerIdle = 0;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Register the fork handlers; once per process.
+    */
+    void SCXLogMediatorAsync::RegisterForkHandlers()
+    {
+        s_instances = new std::set<SCXLogMediatorAsync*>();
+        pthread_atfork(PrepareFork, ParentAfterFork, ChildAfterFork);
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Fork handler run before the fork: waits until no writer passes an item
+        to the consumers, and keeps them from doing so until after the fork.
+    */
+    void SCXLogMediatorAsync::PrepareFork()
+    {
+        pthread_mutex_lock(&s_instancesLock);
+        for (std::set<SCXLogMediatorAsync*>::iterator i = s_instances->begin(); i != s_instances->end(); ++i)
+        {
+            (*i)->m_restartLock.Lock();
+            (*i)->m_lock.Lock();
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Fork handler run in the parent after the fork.
+    */
+    void SCXLogMediatorAsync::ParentAfterFork()
+    {
+        for (std::set<SCXLogMediatorAsync*>::iterator i = s_instances->begin(); i != s_instances->end(); ++i)
+        {
+            (*i)->m_lock.Unlock();
+            (*i)->m_restartLock.Unlock();
+        }
+        pthread_mutex_unlock(&s_instancesLock);
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Fork handler run in the child after the fork. The writers are started
+        when the child first logs, not here, as most children exec at once.
+
+        Another thread of the parent may have been copying or releasing a
+        handle of the mediator's locks, which takes a lock of its own; rather
+        than unlock them, the child gets new locks and leaves the old ones be.
+    */
+    void SCXLogMediatorAsync::ChildAfterFork()
+    {
+        ++s_forks;
+        for (std::set<SCXLogMediatorAsync*>::iterator i = s_instances->begin(); i != s_instances->end(); ++i)
+        {
+            (*i)->RepairAfterFork();
+            new (&(*i)->m_lock) SCXThreadLockHandle(ThreadLockHandleGet());
+            new (&(*i)->m_restartLock) SCXThreadLockHandle(ThreadLockHandleGet());
+        }
+        pthread_mutex_unlock(&s_instancesLock);
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Put an item in the ring. Any number of threads may do so at once; a
+        position is claimed by compare and swap, and the item is published
+        through the sequence number of its slot.
+
+        \param[in] item Item to pass to the writer.
+        \returns False if the ring is full.
+    */
+    bool SCXLogMediatorAsync::TryEnqueue(SCXLogItem* item)
+    {
+        size_t pos = m_enqueuePos;
+        for (;;)
+        {
+            Slot& slot = m_slots[pos & m_mask];
+            size_t sequence = LoadAcquire(slot.m_sequence);
+
+            if (sequence == pos)
+            {
+                if (__sync_bool_compare_and_swap(&m_enqueuePos, pos, pos + 1))
+                {
+                    slot.m_item = item;
+                    StoreRelease(slot.m_sequence, pos + 1);
+                    return true;
+                }
+                pos = m_enqueuePos;
+            }
+            else if (Before(sequence, pos))
+            {
+                // The slot still holds the item from one lap ago
+                return false;
+            }
+            else
+            {
+                // Another thread claimed the position first
+                pos = m_enqueuePos;
+            }
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Take the next item from the ring; writer thread only.
+
+        \param[out] item The item, owned by the caller; NULL if it was lost in a fork.
+        \returns False if there is no item yet.
+    */
+    bool SCXLogMediatorAsync::TryDequeue(SCXLogItem*& item)
+    {
+        size_t pos = m_dequeuePos;
+        Slot& slot = m_slots[pos & m_mask];
+        if (LoadAcquire(slot.m_sequence) != pos + 1)
+        {
+            return false;
+        }
+
+        item = slot.m_item;
+        slot.m_item = NULL;
+
+        // Free the slot for the position one lap ahead
+        StoreRelease(slot.m_sequence, pos + m_mask + 1);
+        m_dequeuePos = pos + 1;
+        return true;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Is there nothing for the writer to take?
+    */
+    bool SCXLogMediatorAsync::IsEmpty() const
+    {
+        size_t pos = m_dequeuePos;
+        return LoadAcquire(m_slots[pos & m_mask].m_sequence) != pos + 1;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Wake the writer thread if it is waiting for items.
+
+        \param[in] always Wake it even if it is busy, e.g. to make room.
+    */
+    void SCXLogMediatorAsync::WakeWriter(bool always)
+    {
+        // Pairs with the writer marking itself idle before it checks the ring
+        __sync_synchronize();
+        if (always || m_writerIdle)
+        {
+            SCXConditionHandle h(m_writer->GetThreadParam()->m_cond);
+            h.Signal();
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Pass the items in the ring on to the consumers; writer thread only, or
+        once the writer has stopped.
+    */
+    void SCXLogMediatorAsync::Drain()
+    {
+        SCXLogItem* item;
+        while (TryDequeue(item))
+        {
+            try
+            {
+                if (NULL != item)
+                {
+                    SCXLogMediatorSimple::LogThisItem(*item);
+                }
+            }
+            catch (...)
+            {
+                // Nowhere to report it; the item is lost as it would be in a failed write
+            }
+            delete item;
+
+            StoreRelease(m_writtenPos, m_dequeuePos);
+        }
+
+        ReportDropped();
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Log how many items were dropped since the last report, if any.
+    */
+    void SCXLogMediatorAsync::ReportDropped()
+    {
+        size_t dropped = LoadAcquire(m_dropped);
+        if (dropped == m_droppedReported)
+        {
+            return;
+        }
+
+        std::wostringstream message;
+        message << (dropped - m_droppedReported) << L" log items were dropped because the log ring was full";
+        m_droppedReported = dropped;
+
+        SCXLogItem item(L"scx.core.log", eWarning, message.str(), SCXSRCLOCATION, SCXThread::GetCurrentThreadID());
+        try
+        {
+            SCXLogMediatorSimple::LogThisItem(item);
+        }
+        catch (...)
+        {
+        }
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Writer thread: passes items on as they arrive, waits while there are none.
+
+        \param[in] param Thread parameters, a LogMediatorAsyncParam.
+    */
+    void SCXLogMediatorAsync::WriterThreadBody(SCXThreadParamHandle& param)
+    {
+        LogMediatorAsyncParam* p = static_cast<LogMediatorAsyncParam*>(param.GetData());
+        SCXASSERT(0 != p);
+
+        SCXLogMediatorAsync* mediator = p->m_mediator;
+        SCXASSERT(0 != mediator);
+
+        p->m_cond.SetSleep(c_writerWakeInterval);
+
+        bool terminate = false;
+        while ( ! terminate)
+        {
+            mediator->Drain();
+
+            if (mediator->m_rotatePending)
+            {
+                mediator->m_rotatePending = 0;
+                mediator->SCXLogMediatorSimple::HandleLogRotate();
+            }
+
+            // Producers only signal while the writer is idle; it marks itself so
+            // before looking at the ring for the last time, so no item is missed
+            SCXConditionHandle h(p->m_cond);
+            terminate = param->GetTerminateFlag();
+            if ( ! terminate)
+            {
+                mediator->m_writerIdle = 1;
+                __sync_synchronize();
+                if (mediator->IsEmpty() && ! mediator->m_rotatePending)
+                {
+                    h.Wait();
+                }
+                mediator->m_writerIdle = 0;
+            }
+        }
+
+        mediator->Drain();
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        Dump object as string (for logging).
+
+        \returns The object represented as a string suitable for logging.
+
+    */
+    const std::wstring SCXLogMediatorAsync::DumpString() const
+    {
+        SCXDumpStringBuilder dsb("SCXLogMediatorAsync");
+        dsb.Scalar("Capacity", m_slots.size())
+           .Scalar("Dropped", GetDroppedCount());
+        return dsb;
+    }
+} /* namespace SCXCoreLib */
+
+#endif /* linux */
+
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
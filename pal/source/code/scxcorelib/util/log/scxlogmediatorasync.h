@@ -0,0 +1,126 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+    \file
+
+    \brief       Contains the definition of an asynchronous log mediator class.
+
+    \date        2026-10-18 21:05:00
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef SCXLOGMEDIATORASYNC_H
+#define SCXLOGMEDIATORASYNC_H
+
+#include "scxlogmediatorsimple.h"
+#include <scxcorelib/scxthread.h>
+#include <vector>
+
+#if defined(linux)
+
+namespace SCXCoreLib
+{
+    /*----------------------------------------------------------------------------*/
+    /**
+        Log mediator that hands log items to its consumers from a thread of its
+        own. Logging threads put a copy of the item in a bounded ring and return;
+        they neither wait for the backends nor for each other, as the ring takes
+        items without a lock. Items reach the consumers in the order they were
+        put in the ring.
+
+        A child process has no writer thread, as fork() copies only the thread
+        that calls it. The child starts a writer of its own when it first logs.
+        The consumers are kept out of reach of the writer while the process
+        forks, so that the child does not inherit their locks held.
+
+        What happens when the ring is full is up to the overflow policy: the
+        logging thread waits for room, or the item is dropped and counted. The
+        number of dropped items is logged once there is room again.
+    */
+    class SCXLogMediatorAsync : public SCXLogMediatorSimple
+    {
+    public:
+        /** What LogThisItem() does when the ring is full */
+        enum OverflowPolicy
+        {
+            eBlock,     //!< Wait for the writer to make room
+            eDrop       //!< Drop the item
+        };
+
+        static const size_t c_defaultCapacity = 4096;       //!< Items the ring holds by default
+
+        explicit SCXLogMediatorAsync(size_t capacity = c_defaultCapacity, OverflowPolicy policy = eBlock);
+        virtual ~SCXLogMediatorAsync();
+
+        virtual void LogThisItem(const SCXLogItem& item);
+        virtual void HandleLogRotate();
+        virtual void Flush();
+
+        scxulong GetDroppedCount() const;
+
+        const std::wstring DumpString() const;
+    private:
+        SCXLogMediatorAsync(const SCXLogMediatorAsync&);             //!< Prevent copying
+        SCXLogMediatorAsync& operator=(const SCXLogMediatorAsync&);  //!< Prevent assignment
+
+        //! A place in the ring
+        struct Slot
+        {
+            volatile size_t m_sequence;     //!< Position the slot can next be written (==) or read (+1) at
+            SCXLogItem*     m_item;         //!< Item, owned by the ring while readable
+        };
+
+        void StartWriter();
+        void RestartWriter();
+        void RepairAfterFork();
+        bool TryEnqueue(SCXLogItem* item);
+        bool TryDequeue(SCXLogItem*& item);
+        bool IsEmpty() const;
+        void WakeWriter(bool always);
+        void Drain();
+        void ReportDropped();
+
+        static void WriterThreadBody(SCXThreadParamHandle& param);
+        static void RegisterForkHandlers();
+        static void PrepareFork();
+        static void ParentAfterFork();
+        static void ChildAfterFork();
+
+        std::vector<Slot>       m_slots;            //!< The ring; its size is a power of two
+        size_t                  m_mask;             //!< Ring size - 1
+        OverflowPolicy          m_policy;           //!< What to do when the ring is full
+        volatile size_t         m_enqueuePos;       //!< Next position to write, claimed by compare and swap
+        volatile size_t         m_dequeuePos;       //!< Next position to read; written by the writer only
+        volatile size_t         m_writtenPos;       //!< Positions before this have reached the consumers
+        volatile int            m_writerIdle;       //!< The writer is waiting, or about to, for items
+        volatile int            m_rotatePending;    //!< A log rotation is to be passed on
+        volatile size_t         m_dropped;          //!< Items dropped so far
+        size_t                  m_droppedReported;  //!< Items dropped and logged about; writer only
+        SCXThreadId             m_writerId;         //!< Thread id of the writer
+        SCXHandle<SCXThread>    m_writer;           //!< The writer thread
+        volatile size_t         m_forks;            //!< Forks of the process before the writer was started
+        SCXThreadLockHandle     m_restartLock;      //!< Serializes starting a writer after a fork
+    };
+}
+
+#endif /* linux */
+
+#endif /* SCXLOGMEDIATORASYNC_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
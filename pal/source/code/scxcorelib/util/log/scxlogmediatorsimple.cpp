@@ -39,7 +39,9 @@ namespace SCXCoreLib
 
     */
     SCXLogMediatorSimple::SCXLogMediatorSimple() :
-        m_lock(ThreadLockHandleGet())
+        m_lock(ThreadLockHandleGet()),
+        m_Generation(0),
+        m_SeveritiesGeneration(0)
     {
     }
 
@@ -50,7 +52,9 @@ namespace SCXCoreLib
         \param[in] lock Used to inject a thread lock handle.
     */
     SCXLogMediatorSimple::SCXLogMediatorSimple(const SCXThreadLockHandle& lock) :
-        m_lock(lock)
+        m_lock(lock),
+        m_Generation(0),
+        m_SeveritiesGeneration(0)
     {
     }
 
@@ -87,6 +91,7 @@ namespace SCXCoreLib
     {
         SCXThreadLock lock(m_lock);
         m_Consumers.insert(consumer);
+        ++m_Generation;
         return true;
     }
 
@@ -101,12 +106,30 @@ namespace SCXCoreLib
     bool SCXLogMediatorSimple::DeRegisterConsumer(SCXHandle<SCXLogItemConsumerIf> consumer)
     {
         SCXThreadLock lock(m_lock);
-        return m_Consumers.erase(consumer) > 0;
+        if (m_Consumers.erase(consumer) > 0)
+        {
+            ++m_Generation;
+            return true;
+        }
+        return false;
+    }
+
+    /*----------------------------------------------------------------------------*/
+    /**
+        The severity thresholds of the consumers have changed; effective
+        severities are worked out anew as they are asked for.
+    */
+    void SCXLogMediatorSimple::InvalidateSeverities()
+    {
+        SCXThreadLock lock(m_lock);
+        ++m_Generation;
     }
 
     /*----------------------------------------------------------------------------*/
     /**
-        Get the effective severity for a particular log module.
+        Get the effective severity for a particular log module: the lowest
+        severity any consumer takes for it. It is worked out once per module
+        and kept until the consumers or their thresholds change.
 
         \param[in] module Log module to retrieve severity for.
         \returns Effective severity for log module.
@@ -114,10 +137,22 @@ namespace SCXCoreLib
     */
     SCXLogSeverity SCXLogMediatorSimple::GetEffectiveSeverity(const std::wstring& module) const
     {
-        SCXLogSeverity effectiveSeverity = eSuppress;
         SCXThreadLock lock(m_lock);
+        if (m_SeveritiesGeneration != m_Generation)
+        {
+            m_Severities.clear();
+            m_SeveritiesGeneration = m_Generation;
+        }
+
+        SeverityMap::const_iterator found = m_Severities.find(module);
+        if (found != m_Severities.end())
+        {
+            return found->second;
+        }
+
+        SCXLogSeverity effectiveSeverity = eSuppress;
         for (ConsumerSet::const_iterator i = m_Consumers.begin();
-             i != m_Consumers.end();
+             i != m_Consumers.end() && effectiveSeverity != eHysterical;
              ++i)
         {
             SCXLogSeverity backendSeverity = (*i)->GetEffectiveSeverity(module);
@@ -125,11 +160,8 @@ namespace SCXCoreLib
             {
                 effectiveSeverity = backendSeverity;
             }
-            if (effectiveSeverity == eHysterical)
-            {
-                return eHysterical;
-            }
         }
+        m_Severities[module] = effectiveSeverity;
         return effectiveSeverity;
     }
 
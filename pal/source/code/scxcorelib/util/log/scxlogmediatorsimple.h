@@ -32,6 +32,7 @@
 #include "scxlogmediator.h"
 #include "scxlogbackend.h"
 #include <scxcorelib/scxhandle.h>
+#include <map>
 #include <set>
 
 namespace SCXCoreLib
@@ -68,6 +69,7 @@ namespace SCXCoreLib
         };
 
         typedef std::set<SCXHandle<SCXLogItemConsumerIf>, HandleCompare> ConsumerSet; //!< Defines a set of consumers.
+        typedef std::map<std::wstring, SCXLogSeverity> SeverityMap; //!< Effective severities by module.
 
     public:
         SCXLogMediatorSimple();
@@ -77,12 +79,17 @@ namespace SCXCoreLib
         virtual SCXLogSeverity GetEffectiveSeverity(const std::wstring& module) const;
         virtual bool RegisterConsumer(SCXHandle<SCXLogItemConsumerIf> consumer);
         virtual bool DeRegisterConsumer(SCXHandle<SCXLogItemConsumerIf> consumer);
+        virtual void InvalidateSeverities();
         virtual void HandleLogRotate();
 
         const std::wstring DumpString() const;
-    private:
+    protected:
         SCXThreadLockHandle m_lock; //!< Thread lock synchronizing access to internal data.
+    private:
         ConsumerSet m_Consumers; //!< Set of currently subscribed consumers.
+        unsigned int m_Generation; //!< Changes whenever effective severities may have changed.
+        mutable SeverityMap m_Severities; //!< Effective severities worked out so far, valid for m_SeveritiesGeneration.
+        mutable unsigned int m_SeveritiesGeneration; //!< Generation m_Severities was worked out for.
     };
 }
 
@@ -0,0 +1,204 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+    \file
+
+    \brief       Encoding of the fields of binary log records.
+
+    \date        2026-10-18 23:00:00
+
+*/
+/*----------------------------------------------------------------------------*/
+
+#include "scxlogrecord.h"
+#include "scxloglineformatter.h"
+#include <scxcorelib/scxexception.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <istream>
+
+namespace SCXCoreLib
+{
+    namespace SCXLogRecord
+    {
+        /*----------------------------------------------------------------------------*/
+        /**
+            Append a number.
+        */
+        void PutNumber(std::string& out, scxulong value)
+        {
+            while (value >= 0x80)
+            {
+                out += static_cast<char>(0x80 | (value & 0x7F));
+                value >>= 7;
+            }
+            out += static_cast<char>(value);
+        }
+
+        /*----------------------------------------------------------------------------*/
+        /**
+            Append a string.
+        */
+        void PutString(std::string& out, const std::wstring& text)
+        {
+            scxulong length = 0;
+            for (std::wstring::const_iterator iter = text.begin(); iter != text.end(); ++iter)
+            {
+                unsigned long c = static_cast<unsigned long>(*iter);
+                length += c < 0x80 ? 1 : c < 0x800 ? 2 : (c < 0x10000 || c >= 0x110000) ? 3 : 4;
+            }
+            PutNumber(out, length);
+            if (length == text.size())
+            {
+                // All ASCII
+                const size_t start = out.size();
+                out.resize(start + text.size());
+                std::copy(text.begin(), text.end(), out.begin() + static_cast<std::ptrdiff_t>(start));
+            }
+            else
+            {
+                SCXLogLineFormatter::AppendUTF8(out, text);
+            }
+        }
+
+        /*----------------------------------------------------------------------------*/
+        /**
+            Append a timestamp.
+        */
+        void PutTimestamp(std::string& out, const SCXCalendarTime& timestamp)
+        {
+            const SCXRelativeTime offset(timestamp.GetOffsetFromUTC());
+            const int minutesFromUTC = offset.GetHours() * 60 + offset.GetMinutes();
+
+            PutNumber(out, static_cast<scxulong>(timestamp.GetYear()));
+            PutNumber(out, static_cast<scxulong>(timestamp.GetMonth()));
+            PutNumber(out, static_cast<scxulong>(timestamp.GetDay()));
+            PutNumber(out, static_cast<scxulong>(timestamp.GetHour()));
+            PutNumber(out, static_cast<scxulong>(timestamp.GetMinute()));
+            PutNumber(out, static_cast<scxulong>(timestamp.GetSecond() * 1000000 + 0.5));
+            PutNumber(out, timestamp.GetDecimalCount());
+            PutNumber(out, minutesFromUTC >= 0 ? static_cast<scxulong>(minutesFromUTC) * 2
+                                               : static_cast<scxulong>(-minutesFromUTC) * 2 - 1);
+        }
+
+        /*----------------------------------------------------------------------------*/
+        /**
+            Constructor.
+            \param[in] in Stream to read from.
+        */
+        Reader::Reader(std::istream& in) :
+            m_In(in),
+            m_Good(true)
+        {
+        }
+
+        /*----------------------------------------------------------------------------*/
+        /**
+            \returns true if a read has failed
+        */
+        bool Reader::Failed() const
+        {
+            return !m_Good;
+        }
+
+        /*----------------------------------------------------------------------------*/
+        /**
+            Read a number.
+        */
+        scxulong Reader::Number()
+        {
+            scxulong value = 0;
+            for (unsigned shift = 0; m_Good; shift += 7)
+            {
+                int c = m_In.get();
+                if (c == std::char_traits<char>::eof() || shift > 63)
+                {
+                    m_Good = false;
+                    break;
+                }
+                value |= static_cast<scxulong>(c & 0x7F) << shift;
+                if (0 == (c & 0x80))
+                {
+                    return value;
+                }
+            }
+            return 0;
+        }
+
+        /*----------------------------------------------------------------------------*/
+        /**
+            Read a string, as UTF-8.
+        */
+        void Reader::String(std::string& text)
+        {
+            scxulong length = Number();
+            text.clear();
+            if (m_Good && length > 0)
+            {
+                text.resize(static_cast<size_t>(length));
+                if (!m_In.read(&text[0], static_cast<std::streamsize>(length)))
+                {
+                    m_Good = false;
+                }
+            }
+        }
+
+        /*----------------------------------------------------------------------------*/
+        /**
+            Read a timestamp; a timestamp that is not a valid calendar time
+            fails the reader.
+        */
+        void Reader::Timestamp(SCXCalendarTime& timestamp)
+        {
+            scxulong fields[8];
+            for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i)
+            {
+                fields[i] = Number();
+            }
+            if (!m_Good)
+            {
+                return;
+            }
+
+            int minutesFromUTC = static_cast<int>(fields[7] / 2);
+            if (fields[7] % 2 != 0)
+            {
+                minutesFromUTC = -minutesFromUTC - 1;
+            }
+            try
+            {
+                timestamp = SCXCalendarTime(static_cast<scxyear>(fields[0]),
+                                            static_cast<scxmonth>(fields[1]),
+                                            static_cast<scxday>(fields[2]),
+                                            static_cast<scxhour>(fields[3]),
+                                            static_cast<scxminute>(fields[4]),
+                                            static_cast<scxsecond>(fields[5]) / 1000000,
+                                            static_cast<scxdecimalnr>(fields[6]),
+                                            SCXRelativeTime().SetMinutes(minutesFromUTC));
+            }
+            catch (const SCXException&)
+            {
+                m_Good = false;
+            }
+        }
+    }
+}
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -0,0 +1,75 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+    \file
+
+    \brief       Encoding of the fields of binary log records.
+
+    \date        2026-10-18 23:00:00
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef SCXLOGRECORD_H
+#define SCXLOGRECORD_H
+
+#include <scxcorelib/scxcmn.h>
+#include <scxcorelib/scxtime.h>
+
+#include <iosfwd>
+#include <string>
+
+namespace SCXCoreLib
+{
+    /**
+        Fields of the records written by the binary log backends. Numbers are
+        unsigned LEB128; strings are their length in bytes followed by UTF-8;
+        a timestamp is year, month, day, hour, minute, microsecond of the
+        minute, number of decimals and minutes from UTC, zigzag encoded.
+    */
+    namespace SCXLogRecord
+    {
+        void PutNumber(std::string& out, scxulong value);
+        void PutString(std::string& out, const std::wstring& text);
+        void PutTimestamp(std::string& out, const SCXCalendarTime& timestamp);
+
+        /*----------------------------------------------------------------------------*/
+        /**
+            Reads the fields of records; once a read fails, the reader stays
+            failed and reads return zero values.
+        */
+        class Reader
+        {
+        public:
+            explicit Reader(std::istream& in);
+
+            bool Failed() const;
+            scxulong Number();
+            void String(std::string& text);
+            void Timestamp(SCXCalendarTime& timestamp);
+
+        private:
+            std::istream& m_In;     //!< Stream to read from
+            bool m_Good;            //!< No read has failed
+        };
+    }
+}
+
+#endif /* SCXLOGRECORD_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
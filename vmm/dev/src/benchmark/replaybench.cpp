@@ -0,0 +1,834 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        replaybench.cpp
+
+   \brief       Replays specializations offline and reports how long each phase
+                took, how much was allocated and the peak resident set size.
+
+                Every replay runs InitializeSystem in a child process of its own,
+                against a scratch agent home and root directory, in new UTS and
+                network namespaces.  Commands are recorded instead of run, and
+                shutdown is never called, so nothing on the host is changed.
+                Phase latencies come from the timeline the agent writes.
+
+   \date        10-18-2026 17:20:05
+
+*/
+/*----------------------------------------------------------------------------*/
+#include <scxcorelib/scxcmn.h>
+#include <scxcorelib/scxthreadlock.h>
+#include <scxcorelib/stringaid.h>
+
+#include <logpolicy.h>
+
+#include <argumentmanager.h>
+#include <commandexecutor.h>
+#include <initializesystem.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using VMM::GuestAgent::Utilities::ArgumentManager;
+using VMM::GuestAgent::Utilities::CommandExecutor;
+using VMM::GuestAgent::Utilities::CommandRunner;
+
+namespace
+{
+
+char const USAGE[] = "replaybench [specdir=<DIR>] [iterations=<N>] [workdir=<DIR>]";
+char const ARG_SPEC_DIR[] = "specdir=";
+char const ARG_ITERATIONS[] = "iterations=";
+char const ARG_WORK_DIR[] = "workdir=";
+
+char const SPEC_FILE[] = "linuxosconfiguration.xml";
+char const RESULT_FILE[] = "result";
+char const COMMANDS_FILE[] = "commands.log";
+char const OUTPUT_FILE[] = "output.log";
+char const TIMELINE_FILE[] = "home/status/timeline.json";
+
+unsigned int const DEFAULT_ITERATIONS = 5;
+
+/** Exit status of a replay that could not be isolated from the host */
+int const EXIT_NOT_ISOLATED = 3;
+
+/** Allocations through operator new since the replay started */
+unsigned long g_allocations = 0;
+unsigned long g_allocatedBytes = 0;
+
+/** A specialization to replay */
+struct Spec
+{
+    std::string m_name;
+    std::string m_xml;
+};
+
+/** Measurements of one replay */
+struct Sample
+{
+    int                                  m_status;
+    double                               m_wallMs;
+    long                                 m_peakRSSKb;
+    unsigned long                        m_allocations;
+    unsigned long                        m_allocatedBytes;
+    unsigned long                        m_commands;
+    std::map<std::string, double>        m_phaseMs;     //!< Summed durations by category/name
+    std::map<std::string, unsigned long> m_phaseCount;  //!< Spans by category/name
+};
+
+/*----------------------------------------------------------------------------*/
+/**
+   Records the commands instead of running them; shutdown ends the replay
+
+*/
+class RecordingRunner : public CommandRunner
+{
+
+public:
+
+    RecordingRunner(const std::string& runDir)
+      : m_lock(SCXCoreLib::ThreadLockHandleGet())
+      , m_runDir(runDir)
+      , m_commands(0)
+      , m_log((runDir + "/" + COMMANDS_FILE).c_str())
+    {}
+
+    int Execute(const std::wstring& command,
+                const std::string& component,
+                unsigned int const /* timeoutSecs */)
+    {
+        SCXCoreLib::SCXThreadLock lock(m_lock);
+        ++m_commands;
+        m_log << component << '\t' << SCXCoreLib::StrToUTF8(command) << std::endl;
+        return 0;
+    }
+
+    void Shutdown(char const* option)
+    {
+        {
+            SCXCoreLib::SCXThreadLock lock(m_lock);
+            m_log << "shutdown\t" << option << std::endl;
+        }
+
+        WriteResult();
+        _exit(EXIT_SUCCESS);
+    }
+
+    /** Hand the counters to the parent; called once however the replay ends */
+    void WriteResult()
+    {
+        SCXCoreLib::SCXThreadLock lock(m_lock);
+        if (m_runDir.empty())
+        {
+            return;
+        }
+
+        char result[128];
+        int length = snprintf(result, sizeof(result), "%lu %lu %lu\n",
+                              g_allocations, g_allocatedBytes, m_commands);
+        int fd = open((m_runDir + "/" + RESULT_FILE).c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+        if (fd >= 0)
+        {
+            if (write(fd, result, length) != length)
+            {
+                std::cerr << "Unable to write replay result" << std::endl;
+            }
+            close(fd);
+        }
+        m_runDir.clear();
+    }
+
+private:
+
+    SCXCoreLib::SCXThreadLockHandle m_lock;
+    std::string                     m_runDir;
+    unsigned long                   m_commands;
+    std::ofstream                   m_log;
+
+}; // End of RecordingRunner class
+
+RecordingRunner* g_runner = 0;
+
+void
+WriteResultAtExit()
+{
+    if (0 != g_runner)
+    {
+        g_runner->WriteResult();
+    }
+}
+
+bool
+WriteFile(
+    const std::string& path,
+    const std::string& contents)
+{
+    std::ofstream stream(path.c_str(), std::ios_base::out | std::ios_base::trunc);
+    stream << contents;
+    stream.close();
+    return !stream.fail();
+}
+
+bool
+MakeDirs(
+    const std::string& path)
+{
+    std::string::size_type pos = 0;
+    while (std::string::npos != pos)
+    {
+        pos = path.find('/', pos + 1);
+        std::string dir = path.substr(0, pos);
+        if (0 != mkdir(dir.c_str(), S_IRWXU) && EEXIST != errno)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+   Build a specialization file
+
+   \param  adapters         Number of network adapters
+   \param  staticAddresses  Whether the adapters have static addresses or use DHCP
+   \param  runOnceCommands  Number of run once commands
+   \param  rootUser         Whether the root password is set
+
+*/
+std::string
+MakeSpec(
+    unsigned int adapters,
+    bool staticAddresses,
+    unsigned int runOnceCommands,
+    bool rootUser)
+{
+    std::ostringstream xml;
+    xml << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+        << "<LinuxOSSpecialization>\n"
+        << "  <SchemaVersion>1.0</SchemaVersion>\n"
+        << "  <OSConfiguration>\n"
+        << "    <HostName>replaybench</HostName>\n"
+        << "    <DNSDomainName>bench.example</DNSDomainName>\n"
+        << "    <TimeZone>4</TimeZone>\n";
+
+    if (adapters > 0)
+    {
+        xml << "    <VNetAdapters>\n";
+        for (unsigned int i = 0; i < adapters; ++i)
+        {
+            xml << "      <VNetAdapter>\n"
+                << "        <MACAddress>00:15:5D:00:" << std::hex << std::uppercase << std::setfill('0')
+                << std::setw(2) << (i >> 8 & 0xff) << ':' << std::setw(2) << (i & 0xff)
+                << std::dec << "</MACAddress>\n";
+            if (staticAddresses)
+            {
+                xml << "        <IPV4Property AddressType=\"STATIC\">\n"
+                    << "          <StaticIP><Address>10." << (i >> 8 & 0xff) << '.' << (i & 0xff)
+                    << ".10/24</Address></StaticIP>\n"
+                    << "        </IPV4Property>\n"
+                    << "        <NameServers><NameServer>10.0.0.2</NameServer></NameServers>\n"
+                    << "        <Gateways><Gateway><Address>10." << (i >> 8 & 0xff) << '.' << (i & 0xff)
+                    << ".1</Address><Metric>1</Metric></Gateway></Gateways>\n"
+                    << "        <DNSSearchSuffixes><DNSSearchSuffix>bench.example</DNSSearchSuffix></DNSSearchSuffixes>\n";
+            }
+            else
+            {
+                xml << "        <IPV4Property AddressType=\"DHCP\"/>\n";
+            }
+            xml << "      </VNetAdapter>\n";
+        }
+        xml << "    </VNetAdapters>\n";
+    }
+
+    if (rootUser)
+    {
+        xml << "    <Users>\n"
+            << "      <User><UserName>root</UserName><Password>cmVwbGF5YmVuY2g=</Password></User>\n"
+            << "    </Users>\n";
+    }
+
+    if (runOnceCommands > 0)
+    {
+        xml << "    <RunOnceCommands>\n";
+        for (unsigned int i = 0; i < runOnceCommands; ++i)
+        {
+            xml << "      <RunOnceCommand Sequence=\"" << i << "\">echo " << i << "</RunOnceCommand>\n";
+        }
+        xml << "    </RunOnceCommands>\n";
+    }
+
+    xml << "  </OSConfiguration>\n"
+        << "</LinuxOSSpecialization>\n";
+    return xml.str();
+}
+
+void
+AddBuiltinSpecs(
+    std::vector<Spec>& specs)
+{
+    Spec spec;
+
+    spec.m_name = "small";
+    spec.m_xml = MakeSpec(1, false, 0, false);
+    specs.push_back(spec);
+
+    spec.m_name = "typical";
+    spec.m_xml = MakeSpec(2, true, 5, true);
+    specs.push_back(spec);
+
+    spec.m_name = "adapters64";
+    spec.m_xml = MakeSpec(64, true, 0, true);
+    specs.push_back(spec);
+
+    spec.m_name = "runonce500";
+    spec.m_xml = MakeSpec(1, false, 500, true);
+    specs.push_back(spec);
+}
+
+bool
+AddRecordedSpecs(
+    const std::string& specDir,
+    std::vector<Spec>& specs)
+{
+    DIR* dir = opendir(specDir.c_str());
+    if (0 == dir)
+    {
+        return false;
+    }
+
+    std::vector<std::string> names;
+    for (struct dirent* entry = readdir(dir); 0 != entry; entry = readdir(dir))
+    {
+        std::string name(entry->d_name);
+        if (name.size() > 4 && 0 == name.compare(name.size() - 4, 4, ".xml"))
+        {
+            names.push_back(name);
+        }
+    }
+    closedir(dir);
+
+    std::sort(names.begin(), names.end());
+    for (std::vector<std::string>::const_iterator iter = names.begin(); iter != names.end(); ++iter)
+    {
+        std::ifstream stream((specDir + "/" + *iter).c_str());
+        std::ostringstream contents;
+        contents << stream.rdbuf();
+
+        Spec spec;
+        spec.m_name = iter->substr(0, iter->size() - 4);
+        spec.m_xml = contents.str();
+        specs.push_back(spec);
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+   Lay out the agent home and root directory of one replay.  The status file
+   says the preconfigurator has run, as on the boot after its reboot, so the
+   replay covers the configurators.
+
+*/
+bool
+PrepareRun(
+    const std::string& runDir,
+    const Spec& spec)
+{
+    return MakeDirs(runDir + "/spec") &&
+           MakeDirs(runDir + "/home/status") &&
+           MakeDirs(runDir + "/home/etc") &&
+           MakeDirs(runDir + "/root/etc/sysconfig/network-scripts") &&
+           MakeDirs(runDir + "/root/usr/share/zoneinfo/US") &&
+           MakeDirs(runDir + "/root/var/opt/microsoft/scvmmguestagent/log") &&
+           WriteFile(runDir + "/spec/" + SPEC_FILE, spec.m_xml) &&
+           WriteFile(runDir + "/home/status/statusmessage.xml",
+                     "<OSConfigurationStatus SchemaVersion=\"1.1\">"
+                     "<PreConfiguratorStatus>Successful</PreConfiguratorStatus>"
+                     "</OSConfigurationStatus>") &&
+           WriteFile(runDir + "/home/etc/scvmm.conf",
+                     "FILE (\nPATH: " + runDir + "/scvmm.log\nMODULE: TRACE\n)\n") &&
+           WriteFile(runDir + "/root/etc/hosts", "127.0.0.1 localhost\n") &&
+           WriteFile(runDir + "/root/etc/resolv.conf", "nameserver 10.0.0.2\n") &&
+           WriteFile(runDir + "/root/etc/sysconfig/network", "NETWORKING=yes\n") &&
+           WriteFile(runDir + "/root/usr/share/zoneinfo/US/Pacific", "");
+}
+
+bool
+WriteProcFile(
+    const char* path,
+    const std::string& contents)
+{
+    int fd = open(path, O_WRONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    bool written = write(fd, contents.data(), contents.size()) == static_cast<ssize_t>(contents.size());
+    close(fd);
+    return written;
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+   Give the replay a hostname and network stack of its own.  Without root a
+   user namespace is needed, in which the replay runs as root.
+
+*/
+bool
+Isolate()
+{
+    if (0 == unshare(CLONE_NEWUTS | CLONE_NEWNET))
+    {
+        return true;
+    }
+
+    uid_t uid = getuid();
+    gid_t gid = getgid();
+    if (EPERM != errno || 0 != unshare(CLONE_NEWUSER | CLONE_NEWUTS | CLONE_NEWNET))
+    {
+        return false;
+    }
+
+    std::ostringstream uidMap;
+    uidMap << "0 " << uid << " 1\n";
+    std::ostringstream gidMap;
+    gidMap << "0 " << gid << " 1\n";
+
+    // setgroups has to be denied before an unprivileged gid_map is accepted;
+    // kernels older than 3.19 do not have the file
+    WriteProcFile("/proc/self/setgroups", "deny");
+    return WriteProcFile("/proc/self/uid_map", uidMap.str()) &&
+           WriteProcFile("/proc/self/gid_map", gidMap.str());
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+   Replay one specialization; runs in the child and does not return
+
+*/
+void
+RunChild(
+    const std::string& runDir)
+{
+    int output = open((runDir + "/" + OUTPUT_FILE).c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (output >= 0)
+    {
+        dup2(output, STDOUT_FILENO);
+        dup2(output, STDERR_FILENO);
+        close(output);
+    }
+
+    if (!Isolate())
+    {
+        std::cerr << "Unable to isolate the replay errno: " << errno << std::endl;
+        _exit(EXIT_NOT_ISOLATED);
+    }
+
+    setenv("SCVMM_HOME", (runDir + "/home").c_str(), 1);
+    setenv("SCVMM_ROOT", (runDir + "/root").c_str(), 1);
+
+    std::string mountPath = "mntpath=" + runDir + "/spec/";
+    char const* argv[] = { "replaybench", mountPath.c_str(), 0 };
+
+    // Load the arguments before the first log handle is made, so logging is
+    // configured from the scratch home
+    SCXCoreLib::SCXLogHandle quiet;
+    ArgumentManager::Instance().LoadArgs(2, argv, quiet);
+
+    RecordingRunner runner(runDir);
+    g_runner = &runner;
+    CommandExecutor::SetRunner(&runner);
+    atexit(WriteResultAtExit);
+
+    g_allocations = 0;
+    g_allocatedBytes = 0;
+
+    InitializeSystem(2, argv, false);
+
+    runner.WriteResult();
+    _exit(EXIT_SUCCESS);
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+   Extract a field from a trace event line
+
+*/
+bool
+FindField(
+    const std::string& line,
+    const std::string& field,
+    bool quoted,
+    std::string& value)
+{
+    std::string key = "\"" + field + "\":" + (quoted ? "\"" : "");
+    std::string::size_type start = line.find(key);
+    if (std::string::npos == start)
+    {
+        return false;
+    }
+
+    start += key.size();
+    std::string::size_type end = start;
+    if (quoted)
+    {
+        while (end < line.size() && '"' != line[end])
+        {
+            end += '\\' == line[end] ? 2 : 1;
+        }
+    }
+    else
+    {
+        end = line.find_first_of(",}", start);
+    }
+
+    if (std::string::npos == end || end > line.size())
+    {
+        return false;
+    }
+
+    value = line.substr(start, end - start);
+    return true;
+}
+
+void
+ReadTimeline(
+    const std::string& path,
+    Sample& sample)
+{
+    std::ifstream stream(path.c_str());
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        std::string phase;
+        std::string name;
+        std::string category;
+        std::string duration;
+        if (!FindField(line, "ph", true, phase) || "X" != phase ||
+            !FindField(line, "name", true, name) ||
+            !FindField(line, "cat", true, category) ||
+            !FindField(line, "dur", false, duration))
+        {
+            continue;
+        }
+
+        std::string key = category + "/" + name;
+        sample.m_phaseMs[key] += strtod(duration.c_str(), 0) / 1000;
+        ++sample.m_phaseCount[key];
+    }
+}
+
+bool
+RunOnce(
+    const std::string& runDir,
+    const Spec& spec,
+    Sample& sample)
+{
+    if (!PrepareRun(runDir, spec))
+    {
+        std::cerr << "Unable to prepare " << runDir << " errno: " << errno << std::endl;
+        return false;
+    }
+
+    std::cout.flush();
+
+    struct timeval start;
+    gettimeofday(&start, 0);
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        std::cerr << "Unable to start replay errno: " << errno << std::endl;
+        return false;
+    }
+
+    if (0 == pid)
+    {
+        RunChild(runDir);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    while (wait4(pid, &status, 0, &usage) < 0 && EINTR == errno)
+    {
+    }
+
+    struct timeval finish;
+    gettimeofday(&finish, 0);
+
+    sample.m_status = WIFEXITED(status) ? WEXITSTATUS(status) : -WTERMSIG(status);
+    sample.m_wallMs = (finish.tv_sec - start.tv_sec) * 1000.0 + (finish.tv_usec - start.tv_usec) / 1000.0;
+    sample.m_peakRSSKb = usage.ru_maxrss;
+    sample.m_allocations = 0;
+    sample.m_allocatedBytes = 0;
+    sample.m_commands = 0;
+
+    std::ifstream result((runDir + "/" + RESULT_FILE).c_str());
+    result >> sample.m_allocations >> sample.m_allocatedBytes >> sample.m_commands;
+
+    ReadTimeline(runDir + "/" + TIMELINE_FILE, sample);
+
+    if (EXIT_NOT_ISOLATED == sample.m_status)
+    {
+        std::cerr << "Replays need user namespaces or root; see " << runDir << "/" << OUTPUT_FILE << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+double
+Median(
+    std::vector<double> values)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return 0 == values.size() % 2 ? (values[middle - 1] + values[middle]) / 2 : values[middle];
+}
+
+void
+PrintRow(
+    const std::string& label,
+    const std::vector<double>& values,
+    double count)
+{
+    std::cout << "  " << std::left << std::setw(44) << label << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << Median(values)
+              << std::setw(12) << *std::min_element(values.begin(), values.end())
+              << std::setw(12) << *std::max_element(values.begin(), values.end())
+              << std::setw(8) << std::setprecision(0) << count << std::endl;
+}
+
+void
+Report(
+    const Spec& spec,
+    const std::vector<Sample>& samples)
+{
+    std::vector<double> wall;
+    std::vector<double> rss;
+    std::vector<double> allocations;
+    std::vector<double> allocatedKb;
+    std::vector<double> commands;
+    std::map<std::string, std::vector<double> > phases;
+    std::map<std::string, unsigned long> counts;
+    unsigned int failed = 0;
+
+    for (std::vector<Sample>::const_iterator iter = samples.begin(); iter != samples.end(); ++iter)
+    {
+        failed += 0 != iter->m_status ? 1 : 0;
+        wall.push_back(iter->m_wallMs);
+        rss.push_back(static_cast<double>(iter->m_peakRSSKb));
+        allocations.push_back(static_cast<double>(iter->m_allocations));
+        allocatedKb.push_back(iter->m_allocatedBytes / 1024.0);
+        commands.push_back(static_cast<double>(iter->m_commands));
+
+        for (std::map<std::string, double>::const_iterator phase = iter->m_phaseMs.begin();
+             phase != iter->m_phaseMs.end();
+             ++phase)
+        {
+            phases[phase->first].push_back(phase->second);
+            counts[phase->first] = iter->m_phaseCount.find(phase->first)->second;
+        }
+    }
+
+    std::cout << spec.m_name << ": " << samples.size() << " replays";
+    if (failed > 0)
+    {
+        std::cout << ", " << failed << " ended with a failure status";
+    }
+    std::cout << std::endl
+              << "  " << std::left << std::setw(44) << "phase (ms)" << std::right
+              << std::setw(12) << "median" << std::setw(12) << "min" << std::setw(12) << "max"
+              << std::setw(8) << "spans" << std::endl;
+
+    PrintRow("total", wall, 1);
+    for (std::map<std::string, std::vector<double> >::const_iterator iter = phases.begin();
+         iter != phases.end();
+         ++iter)
+    {
+        PrintRow(iter->first, iter->second, static_cast<double>(counts[iter->first]));
+    }
+
+    PrintRow("peak RSS (KB)", rss, 1);
+    PrintRow("allocations", allocations, 1);
+    PrintRow("allocated (KB)", allocatedKb, 1);
+    PrintRow("commands recorded", commands, 1);
+    std::cout << std::endl;
+}
+
+}
+
+// Dynamic exception specifications are an error from C++17 on, so the
+// replacements match the declarations of whichever standard is built for
+#if __cplusplus < 201103L
+#define REPLAY_THROW_BAD_ALLOC throw (std::bad_alloc)
+#define REPLAY_NOTHROW         throw ()
+#else
+#define REPLAY_THROW_BAD_ALLOC
+#define REPLAY_NOTHROW         noexcept
+#endif
+
+/*----------------------------------------------------------------------------*/
+/**
+   Count the allocations of the replay; everything else is left to malloc
+
+*/
+void*
+operator new(
+    std::size_t size) REPLAY_THROW_BAD_ALLOC
+{
+    __sync_fetch_and_add(&g_allocations, 1);
+    __sync_fetch_and_add(&g_allocatedBytes, size);
+
+    void* p = malloc(0 == size ? 1 : size);
+    if (0 == p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void*
+operator new[](
+    std::size_t size) REPLAY_THROW_BAD_ALLOC
+{
+    return operator new(size);
+}
+
+// Not inlined, so that the compiler does not pair new expressions with free
+__attribute__((noinline)) void
+operator delete(
+    void* p) REPLAY_NOTHROW
+{
+    free(p);
+}
+
+__attribute__((noinline)) void
+operator delete[](
+    void* p) REPLAY_NOTHROW
+{
+    free(p);
+}
+
+int
+main(
+    int const argc,
+    char const* const* argv)
+{
+    std::string specDir;
+    std::string workDir;
+    unsigned int iterations = DEFAULT_ITERATIONS;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (0 == strncmp(ARG_SPEC_DIR, argv[i], strlen(ARG_SPEC_DIR)))
+        {
+            specDir = argv[i] + strlen(ARG_SPEC_DIR);
+        }
+        else if (0 == strncmp(ARG_ITERATIONS, argv[i], strlen(ARG_ITERATIONS)) &&
+                 0 < atoi(argv[i] + strlen(ARG_ITERATIONS)))
+        {
+            iterations = static_cast<unsigned int>(atoi(argv[i] + strlen(ARG_ITERATIONS)));
+        }
+        else if (0 == strncmp(ARG_WORK_DIR, argv[i], strlen(ARG_WORK_DIR)))
+        {
+            workDir = argv[i] + strlen(ARG_WORK_DIR);
+        }
+        else
+        {
+            std::cerr << "Unknown argument \"" << argv[i] << "\"" << std::endl << USAGE << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<Spec> specs;
+    AddBuiltinSpecs(specs);
+    if (!specDir.empty() && !AddRecordedSpecs(specDir, specs))
+    {
+        std::cerr << "Unable to read specializations from " << specDir << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (workDir.empty())
+    {
+        char tempDir[] = "/tmp/replaybench.XXXXXX";
+        if (0 == mkdtemp(tempDir))
+        {
+            std::cerr << "Unable to create a work directory errno: " << errno << std::endl;
+            return EXIT_FAILURE;
+        }
+        workDir = tempDir;
+    }
+
+    std::cout << "Replays are kept in " << workDir << std::endl << std::endl;
+
+    for (std::vector<Spec>::const_iterator spec = specs.begin(); spec != specs.end(); ++spec)
+    {
+        std::vector<Sample> samples;
+        for (unsigned int i = 0; i < iterations; ++i)
+        {
+            std::ostringstream runDir;
+            runDir << workDir << "/" << spec->m_name << "." << i;
+
+            Sample sample;
+            if (!RunOnce(runDir.str(), *spec, sample))
+            {
+                return EXIT_FAILURE;
+            }
+            samples.push_back(sample);
+        }
+
+        Report(*spec, samples);
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -0,0 +1,215 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        blockdevicemonitor.cpp
+
+   \brief       Waits for block devices to be announced through kobject uevents.
+
+   \date        10-18-2026 10:12:40
+
+*/
+/*----------------------------------------------------------------------------*/
+#include <blockdevicemonitor.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+
+#include <scxcorelib/stringaid.h>
+#include <util/LogHandleCache.h>
+
+using VMM::GuestAgent::Fetcher::BlockDeviceMonitor;
+
+namespace
+{
+
+/** Multicast group the kernel sends kobject uevents to */
+unsigned int const KERNEL_UEVENT_GROUP = 1;
+
+/** Large enough for any single uevent message */
+size_t const UEVENT_BUFFER_SIZE = 8192;
+
+char const ACTION_KEY[] = "ACTION=";
+char const SUBSYSTEM_KEY[] = "SUBSYSTEM=";
+char const DEVNAME_KEY[] = "DEVNAME=";
+
+inline bool
+StartsWith(
+    const char* value,
+    const char* prefix)
+{
+    return 0 == strncmp(value, prefix, strlen(prefix));
+}
+
+}
+
+BlockDeviceMonitor::BlockDeviceMonitor()
+    : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
+                      "scx.vmmguestagent.src.fetcher.blockdevicemonitor"))
+    , m_socket(-1)
+{
+    m_socket = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_KOBJECT_UEVENT);
+    if (m_socket < 0)
+    {
+        SCX_LOGWARNING(m_logHandle, "Unable to open uevent socket errno: " +
+                       SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+        return;
+    }
+
+    fcntl(m_socket, F_SETFD, FD_CLOEXEC);
+
+    struct sockaddr_nl address;
+    memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+    address.nl_pid = 0;
+    address.nl_groups = KERNEL_UEVENT_GROUP;
+
+    if (bind(m_socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        SCX_LOGWARNING(m_logHandle, "Unable to bind uevent socket errno: " +
+                       SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+        close(m_socket);
+        m_socket = -1;
+    }
+}
+
+BlockDeviceMonitor::~BlockDeviceMonitor()
+{
+    if (m_socket >= 0)
+    {
+        close(m_socket);
+    }
+}
+
+bool BlockDeviceMonitor::WaitForDevices(scxulong timeoutMs,
+                                        std::vector<std::string>& devices)
+{
+    devices.clear();
+
+    if (!IsOpen())
+    {
+        return false;
+    }
+
+    scxulong deadline = GetMonotonicMilliseconds() + timeoutMs;
+    std::vector<char> buffer(UEVENT_BUFFER_SIZE);
+
+    // Unrelated uevents (network, input, ...) wake us up as well, so keep
+    // waiting until a block device shows up or the time is spent
+    while (devices.empty())
+    {
+        scxulong now = GetMonotonicMilliseconds();
+        if (now >= deadline)
+        {
+            break;
+        }
+
+        struct pollfd pfd;
+        pfd.fd = m_socket;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ready = poll(&pfd, 1, static_cast<int>(deadline - now));
+        if (ready < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            // Would most likely fail again right away; give up on uevents so
+            // that the caller falls back to polling the device nodes
+            SCX_LOGERROR(m_logHandle, "poll on uevent socket failed errno: " +
+                         SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+            close(m_socket);
+            m_socket = -1;
+            break;
+        }
+        else if (0 == ready)
+        {
+            break;
+        }
+
+        // Drain everything that is queued so one wakeup handles a burst of events
+        ssize_t length;
+        while ((length = recv(m_socket, &buffer[0], buffer.size() - 1, MSG_DONTWAIT)) > 0)
+        {
+            buffer[length] = '\0';
+            ParseEvent(&buffer[0], static_cast<size_t>(length), devices);
+        }
+    }
+
+    return !devices.empty();
+}
+
+void BlockDeviceMonitor::ParseEvent(const char* message,
+                                    size_t length,
+                                    std::vector<std::string>& devices)
+{
+    // Kernel uevents are "ACTION@DEVPATH" followed by NUL separated KEY=VALUE pairs
+    std::string action;
+    std::string subsystem;
+    std::string devName;
+
+    const char* end = message + length;
+    for (const char* field = message; field < end; field += strlen(field) + 1)
+    {
+        if (StartsWith(field, ACTION_KEY))
+        {
+            action = field + strlen(ACTION_KEY);
+        }
+        else if (StartsWith(field, SUBSYSTEM_KEY))
+        {
+            subsystem = field + strlen(SUBSYSTEM_KEY);
+        }
+        else if (StartsWith(field, DEVNAME_KEY))
+        {
+            devName = field + strlen(DEVNAME_KEY);
+        }
+    }
+
+    if (subsystem != "block" ||
+        devName.empty() ||
+        (action != "add" && action != "change"))
+    {
+        return;
+    }
+
+    std::string device = devName[0] == '/' ? devName : "/dev/" + devName;
+
+    SCX_LOGINFO(m_logHandle, "Block device event: " + action + " " + device);
+
+    devices.push_back(device);
+}
+
+scxulong BlockDeviceMonitor::GetMonotonicMilliseconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return static_cast<scxulong>(ts.tv_sec) * 1000 +
+           static_cast<scxulong>(ts.tv_nsec) / 1000000;
+}
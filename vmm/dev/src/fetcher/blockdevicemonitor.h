@@ -0,0 +1,138 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        blockdevicemonitor.h
+
+   \brief       Waits for block devices (and media changes on them) to be
+                announced by the kernel through kobject uevents.
+
+   \date        10-18-2026 10:12:40
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef BLOCKDEVICEMONITOR_H
+#define BLOCKDEVICEMONITOR_H
+
+#include <string>
+#include <vector>
+
+#include <scxcorelib/scxcmn.h>
+#include <scxcorelib/scxlog.h>
+
+namespace VMM
+{
+
+    namespace GuestAgent
+    {
+
+        namespace Fetcher
+        {
+
+            class BlockDeviceMonitor
+            {
+
+            public:
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Constructor for BlockDeviceMonitor.  Opens and binds the uevent socket;
+                   if that fails the monitor is left closed and IsOpen() returns false.
+
+                */
+                BlockDeviceMonitor();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Destructor for BlockDeviceMonitor
+
+                */
+                ~BlockDeviceMonitor();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Is the uevent socket available?
+
+                   \return     true if WaitForDevices() can be used
+
+                */
+                inline bool IsOpen() const
+                {
+                    return m_socket >= 0;
+                }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Wait for block devices to be added or to report a media change.
+                   If the uevent socket fails it is closed, and IsOpen() returns false
+                   from then on.
+
+                   \param      timeoutMs   Maximum time to wait in milliseconds
+                   \param      devices     Receives the device nodes (e.g. /dev/sr0) that
+                                           were announced
+
+                   \return     true if at least one block device event was received
+
+                */
+                bool WaitForDevices(scxulong timeoutMs,
+                                    std::vector<std::string>& devices);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Returns the current value of the monotonic clock.
+
+                   \return     milliseconds since an arbitrary, fixed point in time
+
+                */
+                static scxulong GetMonotonicMilliseconds();
+
+            private:
+
+                /** Intentionally not implemented */
+                BlockDeviceMonitor(const BlockDeviceMonitor&);
+                BlockDeviceMonitor& operator=(const BlockDeviceMonitor&);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Parse one uevent message and record the device node if the event
+                   is a block device add or change.
+
+                */
+                void ParseEvent(const char* message,
+                                size_t length,
+                                std::vector<std::string>& devices);
+
+                /** Log Handle */
+                SCXCoreLib::SCXLogHandle m_logHandle;
+
+                /** Netlink kobject uevent socket */
+                int                      m_socket;
+
+            }; // End of BlockDeviceMonitor class
+
+        } // End of Fetcher namespace
+
+    } // End of GuestAgent
+
+} // End of VMM
+
+#endif /* BLOCKDEVICEMONITOR_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
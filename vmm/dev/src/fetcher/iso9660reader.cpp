@@ -0,0 +1,342 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        iso9660reader.cpp
+
+   \brief       Reads files from the root directory of an ISO9660 (optionally
+                Joliet) volume directly from the block device, without mounting it.
+
+   \date        10-18-2026 11:02:15
+
+*/
+/*----------------------------------------------------------------------------*/
+#include <iso9660reader.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <scxcorelib/stringaid.h>
+#include <util/LogHandleCache.h>
+
+using VMM::GuestAgent::Fetcher::ISO9660Reader;
+
+namespace
+{
+
+/** Volume descriptors start at sector 16 and are always 2048 bytes */
+off_t const DESCRIPTOR_START = 16 * 2048;
+size_t const DESCRIPTOR_SIZE = 2048;
+
+/** Stop looking for the terminator after this many descriptors */
+unsigned int const MAX_DESCRIPTORS = 32;
+
+unsigned char const DESCRIPTOR_PRIMARY = 1;
+unsigned char const DESCRIPTOR_SUPPLEMENTARY = 2;
+unsigned char const DESCRIPTOR_TERMINATOR = 255;
+
+char const STANDARD_IDENTIFIER[] = "CD001";
+
+/** Offsets inside a volume descriptor */
+size_t const VD_IDENTIFIER_OFFSET = 1;
+size_t const VD_ESCAPE_OFFSET = 88;
+size_t const VD_BLOCK_SIZE_OFFSET = 128;
+size_t const VD_ROOT_RECORD_OFFSET = 156;
+
+/** Offsets inside a directory record */
+size_t const DR_EXTENT_OFFSET = 2;
+size_t const DR_SIZE_OFFSET = 10;
+size_t const DR_FLAGS_OFFSET = 25;
+size_t const DR_NAME_LENGTH_OFFSET = 32;
+size_t const DR_NAME_OFFSET = 33;
+
+unsigned char const DR_FLAG_DIRECTORY = 0x02;
+unsigned char const DR_FLAG_MULTI_EXTENT = 0x80;
+
+/** Specialization ISOs are tiny; refuse anything that looks unreasonable */
+unsigned int const MAX_DIRECTORY_SIZE = 1024 * 1024;
+unsigned int const MAX_FILE_SIZE = 16 * 1024 * 1024;
+
+inline unsigned int
+ReadLE16(
+    const unsigned char* p)
+{
+    return static_cast<unsigned int>(p[0]) |
+           (static_cast<unsigned int>(p[1]) << 8);
+}
+
+inline unsigned int
+ReadLE32(
+    const unsigned char* p)
+{
+    return static_cast<unsigned int>(p[0]) |
+           (static_cast<unsigned int>(p[1]) << 8) |
+           (static_cast<unsigned int>(p[2]) << 16) |
+           (static_cast<unsigned int>(p[3]) << 24);
+}
+
+std::string
+ToLower(
+    const std::string& value)
+{
+    std::string result(value);
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        result[i] = static_cast<char>(tolower(static_cast<unsigned char>(result[i])));
+    }
+    return result;
+}
+
+}
+
+ISO9660Reader::ISO9660Reader(const std::string& device)
+    : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
+                      "scx.vmmguestagent.src.fetcher.iso9660reader"))
+    , m_device(device)
+    , m_fd(-1)
+    , m_blockSize(DESCRIPTOR_SIZE)
+    , m_rootExtent(0)
+    , m_rootSize(0)
+    , m_joliet(false)
+{
+}
+
+ISO9660Reader::~ISO9660Reader()
+{
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+    }
+}
+
+bool ISO9660Reader::Open()
+{
+    if (m_fd < 0)
+    {
+        m_fd = open(m_device.c_str(), O_RDONLY | O_CLOEXEC);
+        if (m_fd < 0)
+        {
+            SCX_LOGTRACE(m_logHandle, "Unable to open " + m_device + " errno: " +
+                         SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+            return false;
+        }
+    }
+
+    bool found = false;
+    std::vector<unsigned char> descriptor;
+    for (unsigned int i = 0; i < MAX_DESCRIPTORS; ++i)
+    {
+        if (!ReadAt(DESCRIPTOR_START + static_cast<off_t>(i) * DESCRIPTOR_SIZE,
+                    DESCRIPTOR_SIZE, descriptor) ||
+            0 != memcmp(&descriptor[VD_IDENTIFIER_OFFSET], STANDARD_IDENTIFIER,
+                        strlen(STANDARD_IDENTIFIER)))
+        {
+            break;
+        }
+
+        unsigned char type = descriptor[0];
+        if (DESCRIPTOR_TERMINATOR == type)
+        {
+            break;
+        }
+
+        bool joliet = false;
+        if (DESCRIPTOR_SUPPLEMENTARY == type)
+        {
+            // Joliet is flagged by the UCS-2 level 1, 2 or 3 escape sequence
+            const unsigned char* escape = &descriptor[VD_ESCAPE_OFFSET];
+            joliet = escape[0] == '%' && escape[1] == '/' &&
+                     (escape[2] == '@' || escape[2] == 'C' || escape[2] == 'E');
+            if (!joliet)
+            {
+                continue;
+            }
+        }
+        else if (DESCRIPTOR_PRIMARY != type)
+        {
+            continue;
+        }
+
+        // Take the primary descriptor unless a Joliet one shows up
+        if (found && !joliet)
+        {
+            continue;
+        }
+
+        const unsigned char* root = &descriptor[VD_ROOT_RECORD_OFFSET];
+        size_t blockSize = ReadLE16(&descriptor[VD_BLOCK_SIZE_OFFSET]);
+        if (0 == blockSize || 0 != (blockSize & (blockSize - 1)) || blockSize > DESCRIPTOR_SIZE)
+        {
+            continue;
+        }
+
+        m_blockSize = blockSize;
+        m_rootExtent = ReadLE32(&root[DR_EXTENT_OFFSET]);
+        m_rootSize = ReadLE32(&root[DR_SIZE_OFFSET]);
+        m_joliet = joliet;
+        found = true;
+
+        if (joliet)
+        {
+            break;
+        }
+    }
+
+    if (!found)
+    {
+        SCX_LOGTRACE(m_logHandle, "No ISO9660 volume descriptor on " + m_device);
+        return false;
+    }
+
+    if (m_rootSize > MAX_DIRECTORY_SIZE)
+    {
+        SCX_LOGWARNING(m_logHandle, "Root directory on " + m_device + " is too large");
+        return false;
+    }
+
+    return true;
+}
+
+bool ISO9660Reader::ReadRootFile(const std::string& name,
+                                 std::vector<unsigned char>& contents)
+{
+    contents.clear();
+
+    std::vector<unsigned char> directory;
+    if (!ReadAt(static_cast<off_t>(m_rootExtent) * m_blockSize, m_rootSize, directory))
+    {
+        return false;
+    }
+
+    std::string wanted = ToLower(name);
+    size_t offset = 0;
+    while (offset < directory.size())
+    {
+        unsigned int recordLength = directory[offset];
+        if (0 == recordLength)
+        {
+            // Records never cross a sector boundary; the rest of this sector is padding
+            offset = (offset / DESCRIPTOR_SIZE + 1) * DESCRIPTOR_SIZE;
+            continue;
+        }
+
+        if (recordLength <= DR_NAME_OFFSET || offset + recordLength > directory.size())
+        {
+            SCX_LOGWARNING(m_logHandle, "Malformed directory record on " + m_device);
+            return false;
+        }
+
+        const unsigned char* record = &directory[offset];
+        offset += recordLength;
+
+        size_t nameLength = record[DR_NAME_LENGTH_OFFSET];
+        if (DR_NAME_OFFSET + nameLength > recordLength ||
+            0 != (record[DR_FLAGS_OFFSET] & DR_FLAG_DIRECTORY) ||
+            ToLower(DecodeName(&record[DR_NAME_OFFSET], nameLength)) != wanted)
+        {
+            continue;
+        }
+
+        if (0 != (record[DR_FLAGS_OFFSET] & DR_FLAG_MULTI_EXTENT))
+        {
+            SCX_LOGWARNING(m_logHandle, "Multi-extent file " + name + " is not supported");
+            return false;
+        }
+
+        unsigned int size = ReadLE32(&record[DR_SIZE_OFFSET]);
+        if (size > MAX_FILE_SIZE)
+        {
+            SCX_LOGWARNING(m_logHandle, "File " + name + " on " + m_device + " is too large");
+            return false;
+        }
+
+        off_t location = static_cast<off_t>(ReadLE32(&record[DR_EXTENT_OFFSET])) * m_blockSize;
+        if (!ReadAt(location, size, contents))
+        {
+            contents.clear();
+            return false;
+        }
+
+        SCX_LOGINFO(m_logHandle, "Read " + name + " (" +
+                    SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(size)) + " bytes) from " + m_device);
+        return true;
+    }
+
+    return false;
+}
+
+bool ISO9660Reader::ReadAt(off_t offset, size_t size, std::vector<unsigned char>& buffer)
+{
+    buffer.resize(size);
+
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t count = pread(m_fd, &buffer[done], size - done, offset + static_cast<off_t>(done));
+        if (count < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            SCX_LOGTRACE(m_logHandle, "Short read on " + m_device + " errno: " +
+                         SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+            return false;
+        }
+        done += static_cast<size_t>(count);
+    }
+
+    return true;
+}
+
+std::string ISO9660Reader::DecodeName(const unsigned char* identifier, size_t length) const
+{
+    std::string name;
+
+    if (m_joliet)
+    {
+        // UCS-2 big endian; the names we look for are plain ASCII
+        for (size_t i = 0; i + 1 < length; i += 2)
+        {
+            unsigned int ch = (static_cast<unsigned int>(identifier[i]) << 8) | identifier[i + 1];
+            name += ch < 0x80 ? static_cast<char>(ch) : '?';
+        }
+    }
+    else
+    {
+        name.assign(reinterpret_cast<const char*>(identifier), length);
+    }
+
+    std::string::size_type version = name.find(';');
+    if (std::string::npos != version)
+    {
+        name.erase(version);
+    }
+
+    if (!name.empty() && '.' == name[name.size() - 1])
+    {
+        name.erase(name.size() - 1);
+    }
+
+    return name;
+}
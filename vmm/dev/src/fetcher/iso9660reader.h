@@ -0,0 +1,146 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        iso9660reader.h
+
+   \brief       Reads files from the root directory of an ISO9660 (optionally
+                Joliet) volume directly from the block device, without mounting it.
+
+   \date        10-18-2026 11:02:15
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef ISO9660READER_H
+#define ISO9660READER_H
+
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <scxcorelib/scxlog.h>
+
+namespace VMM
+{
+
+    namespace GuestAgent
+    {
+
+        namespace Fetcher
+        {
+
+            class ISO9660Reader
+            {
+
+            public:
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Constructor for ISO9660Reader
+
+                   \param      device    Block device (or image file) holding the volume
+
+                */
+                explicit ISO9660Reader(const std::string& device);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Destructor for ISO9660Reader
+
+                */
+                ~ISO9660Reader();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Open the device and locate the root directory.  The Joliet root is
+                   preferred when present so that long, mixed case names are found.
+
+                   \return     true if a usable volume descriptor was found
+
+                */
+                bool Open();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Read a file from the root directory of the volume
+
+                   \param      name      File name, compared case insensitively and
+                                         without the ";1" version suffix
+                   \param      contents  Receives the file contents
+
+                   \return     true if the file was found and read completely
+
+                */
+                bool ReadRootFile(const std::string& name,
+                                  std::vector<unsigned char>& contents);
+
+            private:
+
+                /** Intentionally not implemented */
+                ISO9660Reader(const ISO9660Reader&);
+                ISO9660Reader& operator=(const ISO9660Reader&);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Read exactly size bytes at offset
+
+                */
+                bool ReadAt(off_t offset, size_t size, std::vector<unsigned char>& buffer);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Convert a directory record identifier to a plain file name
+
+                */
+                std::string DecodeName(const unsigned char* identifier, size_t length) const;
+
+                /** Log Handle */
+                SCXCoreLib::SCXLogHandle m_logHandle;
+
+                /** Device being read */
+                std::string              m_device;
+
+                /** Open descriptor of the device */
+                int                      m_fd;
+
+                /** Logical block size of the volume */
+                size_t                   m_blockSize;
+
+                /** Location (in logical blocks) of the root directory extent */
+                unsigned int             m_rootExtent;
+
+                /** Size in bytes of the root directory extent */
+                unsigned int             m_rootSize;
+
+                /** Does the root belong to a Joliet (UCS-2) descriptor? */
+                bool                     m_joliet;
+
+            }; // End of ISO9660Reader class
+
+        } // End of Fetcher namespace
+
+    } // End of GuestAgent
+
+} // End of VMM
+
+#endif /* ISO9660READER_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -28,31 +28,50 @@
    
 */
 /*----------------------------------------------------------------------------*/
+#include <argumentmanager.h>
+#include <blockdevicemonitor.h>
 #include <commandexecutor.h>
+#include <inputdigest.h>
 #include <isofetcher.h>
 #include <isofetcherexception.h>
 #include <osspecializationreader.h>
+#include <paralleldeviceprobe.h>
+#include <phasetimeline.h>
 #include <statusmessage.h>
 #include <statusmessagestrings.h>
 
+#include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include <sys/mount.h>
 #include <sys/utsname.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <string>
-#include <fstream>
+#include <set>
 #include <vector>
 #include <cerrno>
 
 #include <scxcorelib/scxdirectoryinfo.h>
+#include <scxcorelib/scxthread.h>
 
+using VMM::GuestAgent::Fetcher::BlockDeviceMonitor;
 using VMM::GuestAgent::Fetcher::ISOFetcher;
 using VMM::GuestAgent::Fetcher::ISOFetcherException;
+using VMM::GuestAgent::Fetcher::ParallelDeviceProbe;
 using VMM::GuestAgent::SpecializationReader::OSSpecializationReader;
+using VMM::GuestAgent::Utilities::ArgumentManager;
 using VMM::GuestAgent::StatusManager::StatusMessage;
 using VMM::GuestAgent::Utilities::CommandExecutor;
+using VMM::GuestAgent::Utilities::InputDigest;
+using VMM::GuestAgent::Utilities::PhaseSpan;
+using VMM::GuestAgent::Utilities::PhaseTimeline;
+using VMM::GuestAgent::Utilities::PHASE_CATEGORY_AGENT;
+using VMM::GuestAgent::Utilities::readConfig;
 
 using SCX::Util::Xml::XElement;
 using SCX::Util::Xml::XElementPtr;
@@ -62,54 +81,69 @@ using namespace VMM::GuestAgent::StatusManager;
 
 // Constants
 std::string const MOUNT_POINT = "/mnt/vmmcdrom/";
+
+// Support multiple cdrom drives. With certain versions of LIC, even hdd/hdc needs
+// to be looked into.
+const char* const POSSIBLE_DEVICES[] = {
+    "/dev/cdrom",
+    "/dev/cdrom1",
+    "/dev/cdrom2",
+    "/dev/cdrom3",
+    "/dev/cdrom4",
+    "/dev/cdrom5",
+    "/dev/cdrom6",
+    "/dev/cdrom7",
+    "/dev/cdrom8",
+    "/dev/cdrom9",
+    "/dev/hdd",
+    "/dev/hdc"
+};
+size_t const POSSIBLE_DEVICE_COUNT = sizeof(POSSIBLE_DEVICES) / sizeof(POSSIBLE_DEVICES[0]);
+
+// How long to wait for a device carrying the specialization file to show up
+unsigned int const DEVICE_WAIT_TIMEOUT = 30;
+unsigned int const INSMOD_DEVICE_WAIT_TIMEOUT = 90;
+char const DEVICE_TIMEOUT_CONFIG_FILE_NAME[] =
+    "/opt/microsoft/scvmmguestagent/etc/devicetimeout";
+scxulong const DEVICE_POLL_INTERVAL_MS = 1000;
+
+// Digest of the specialization file last applied; the agent removal deletes
+// SCVMM_HOME, so it is kept next to the agent log instead
+std::string const APPLIED_DIGEST_FILE = "/var/opt/microsoft/scvmmguestagent/specialization.digest";
+
+// The agent removal deletes the timeline in SCVMM_HOME along with the status file
+std::string const TIMELINE_COPY_FILE = "/var/opt/microsoft/scvmmguestagent/log/timeline.json";
+
 std::string const LINUX_OS_CONFIG_FILE = "linuxosconfiguration.xml";
 std::string const INSTALL_UPGRADE = "setsid /mnt/vmmcdrom/install -u -v ";
 std::string const GRUB_COMMAND = "grub-editenv - set recordfail=0";
 std::string const GRUB_FILE = "/usr/bin/grub-editenv";
+std::string const AGENT_VERSION_FILE = "/etc/version";
 
 
 void ISOFetcher::ObtainMountPoint()
 {
     SCX_LOGINFO(m_logHandle, "Obtaining CD ROM mount point");
 
-    // Support multiple cdrom drives. With certain versions of LIC, even hdd/hdc needs
-    // to be looked into.
-    const char* possibleDevices[] = { 
-        "/dev/cdrom", 
-        "/dev/cdrom1", 
-        "/dev/cdrom2",
-        "/dev/cdrom3",
-        "/dev/cdrom4",
-        "/dev/cdrom5",
-        "/dev/cdrom6",
-        "/dev/cdrom7",
-        "/dev/cdrom8",
-        "/dev/cdrom9", 
-        "/dev/hdd",
-        "/dev/hdc"
-    };
+    // Start listening for block device events before looking at /dev so
+    // that a device showing up in between the scan and the wait is not missed.
+    BlockDeviceMonitor monitor;
 
     // check for the existence of any cdrom device.  If none are found,
     // load the driver.
-    int size = sizeof(possibleDevices)/sizeof(char*);
     bool deviceFound = false;
-    for (int i=0; i<size; i++)
+    for (size_t i = 0; i < POSSIBLE_DEVICE_COUNT; i++)
     {
         struct stat statbuf;
 
-        int status = stat(possibleDevices[i], &statbuf);
-
-        if (status != 0)
-        {
-            continue;
-        }
-        else
+        if (stat(POSSIBLE_DEVICES[i], &statbuf) == 0)
         {
             deviceFound = true;
+            break;
         }
     }
 
-    int numRetries = 1;
+    unsigned int waitSecs = DEVICE_WAIT_TIMEOUT;
 
     if (deviceFound == false)
     {
@@ -121,56 +155,45 @@ void ISOFetcher::ObtainMountPoint()
             return;
         }
 
-        numRetries = 3;
+        // insmod sometimes takes time and does not make the device available immediately.
+        waitSecs = INSMOD_DEVICE_WAIT_TIMEOUT;
     }
 
-    int retryCount = 0;
-    bool foundSpecialization = false;
-    while (retryCount < numRetries && (!foundSpecialization))
+    waitSecs = readConfig(DEVICE_TIMEOUT_CONFIG_FILE_NAME, waitSecs);
+
+    std::vector<std::string> candidates(POSSIBLE_DEVICES,
+                                        POSSIBLE_DEVICES + POSSIBLE_DEVICE_COUNT);
+    scxulong deadline = BlockDeviceMonitor::GetMonotonicMilliseconds() +
+                        static_cast<scxulong>(waitSecs) * 1000;
+
+    bool foundSpecialization = ProbeDevices(candidates);
+    while (!foundSpecialization)
     {
-        for (int i=0; i<size; i++)
+        scxulong now = BlockDeviceMonitor::GetMonotonicMilliseconds();
+        if (now >= deadline)
         {
-            struct stat statbuf;
-
-            int status = stat(possibleDevices[i], &statbuf);
+            break;
+        }
 
-            if (status != 0)
+        std::vector<std::string> devices;
+        if (monitor.IsOpen())
+        {
+            if (!monitor.WaitForDevices(deadline - now, devices))
             {
-                SCX_LOGERROR(
-                    m_logHandle, SCXCoreLib::StrFromMultibyte(
-                    std::string("Unable to stat ") +
-                    std::string(possibleDevices[i]) + 
-                    std::string(" errno: ") + 
-                    SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno))));
                 continue;
             }
-            else
-            {
-                SCX_LOGINFO(m_logHandle, SCXCoreLib::StrFromMultibyte(
-                            "CD ROM device already present:" + 
-                            std::string(possibleDevices[i]) +
-                            ", checking for OSSpecialization file"));
-                m_mountSource = possibleDevices[i];
-                if (MountISO() && ReadDataFromMountPoint())
-                {
-                    foundSpecialization = true;
-                    break;
-                }
-                else
-                {
-                    if (m_targetMounted)
-                    {
-                        UnmountISO();
-                    }
-                    continue;
-                }
-            }
-            
+        }
+        else
+        {
+            // No uevents on this system, or the socket failed; fall back to
+            // polling the device nodes
+            SCXCoreLib::SCXThread::Sleep(std::min(deadline - now, DEVICE_POLL_INTERVAL_MS));
         }
 
-        // Sleep and retry - insmod sometimes takes time and does not make the device available immediately.
-        sleep (30);
-        retryCount++;
+        // Try the announced devices first, then the well known names whose
+        // symlinks udev may have created in the meantime
+        devices.insert(devices.end(), candidates.begin(), candidates.end());
+        foundSpecialization = ProbeDevices(devices);
     }
 
     if (!foundSpecialization)
@@ -186,9 +209,121 @@ void ISOFetcher::ObtainMountPoint()
     }
 }
 
+bool ISOFetcher::ProbeDevices(const std::vector<std::string>& devices)
+{
+    std::set<std::string> probed;
+    std::vector<std::string> present;
+
+    for (std::vector<std::string>::const_iterator iter = devices.begin();
+         iter != devices.end();
+         ++iter)
+    {
+        if (!probed.insert(*iter).second)
+        {
+            continue;
+        }
+
+        struct stat statbuf;
+
+        if (stat(iter->c_str(), &statbuf) != 0)
+        {
+            SCX_LOGTRACE(
+                m_logHandle, SCXCoreLib::StrFromMultibyte(
+                std::string("Unable to stat ") +
+                *iter +
+                std::string(" errno: ") +
+                SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno))));
+            continue;
+        }
+
+        SCX_LOGINFO(m_logHandle, SCXCoreLib::StrFromMultibyte(
+                    "CD ROM device already present:" +
+                    *iter +
+                    ", checking for OSSpecialization file"));
+        present.push_back(*iter);
+    }
+
+    // Read the specialization file straight off the devices, all of them at
+    // once; the cd rom is only mounted later on if the installer on it has to be run
+    ParallelDeviceProbe probe(LINUX_OS_CONFIG_FILE);
+    std::string device;
+    std::vector<unsigned char> data;
+    std::vector<std::string> volumes;
+
+    bool found = false;
+    {
+        PhaseSpan span("ReadXML", PHASE_CATEGORY_AGENT);
+        found = probe.Run(present, device, data, volumes);
+    }
+
+    if (found)
+    {
+        m_mountSource = device;
+        m_osConfigurationXMLPath = SCXCoreLib::StrFromMultibyte(MOUNT_POINT);
+        m_osConfigurationXMLString.Assign(data);
+        SCX_LOGINFO(
+            m_logHandle,
+            "Specialization file contents len:" + SCXCoreLib::StrToMultibyte(
+                SCXCoreLib::StrFrom(m_osConfigurationXMLString.Size())));
+        m_foundOSSpecializationFile = true;
+        return true;
+    }
+
+    // Fall back to mounting the iso9660 volumes; they share the mount point,
+    // so this is done one device at a time
+    for (std::vector<std::string>::const_iterator iter = volumes.begin();
+         iter != volumes.end();
+         ++iter)
+    {
+        m_mountSource = *iter;
+        if (MountISO() && ReadDataFromMountPoint())
+        {
+            return true;
+        }
+
+        if (m_targetMounted)
+        {
+            UnmountISO();
+        }
+    }
+
+    return false;
+}
+
+bool ISOFetcher::EnsureMounted()
+{
+    if (IsMountPoint(MOUNT_POINT))
+    {
+        return true;
+    }
+
+    if (m_mountSource.empty())
+    {
+        SCX_LOGERROR(m_logHandle, "No CD ROM device to mount");
+        return false;
+    }
+
+    return MountISO();
+}
+
+bool ISOFetcher::IsMountPoint(const std::string& path)
+{
+    struct stat pathStat;
+    struct stat parentStat;
+
+    if (stat(path.c_str(), &pathStat) != 0 ||
+        stat((path + "..").c_str(), &parentStat) != 0)
+    {
+        return false;
+    }
+
+    return pathStat.st_dev != parentStat.st_dev;
+}
+
 bool ISOFetcher::MountISO()
 {
     SCX_LOGINFO(m_logHandle, "Mounting CD ROM");
+    PhaseSpan span("Mount", PHASE_CATEGORY_AGENT);
 
     SCXCoreLib::SCXFilePath mountPointPath(SCXCoreLib::StrFromMultibyte((MOUNT_POINT)));
 
@@ -233,17 +368,23 @@ void ISOFetcher::UnmountISO()
     std::string tagValue;
     bool insModPerformed = StatusMessage::Instance().ReadChildOfRoot(StatusMessageStrings::InsmodStatus, tagValue);
 
-    SCX_LOGINFO(m_logHandle, "Unmounting CD ROM");
-
-    if (umount(MOUNT_POINT.c_str()) != 0)
+    // Nothing to unmount when the specialization file was read off the device
+    if (IsMountPoint(MOUNT_POINT))
     {
-        SCX_LOGERROR(m_logHandle, "umount /mnt/vmmcdrom failed");
-        return;
-    }
+        SCX_LOGINFO(m_logHandle, "Unmounting CD ROM");
 
-    if (rmdir(MOUNT_POINT.c_str()) != 0)
-    {
-        SCX_LOGERROR(m_logHandle, "rmdir /mnt/vmmcdrom failed");
+        if (umount(MOUNT_POINT.c_str()) != 0)
+        {
+            SCX_LOGERROR(m_logHandle, "umount /mnt/vmmcdrom failed");
+            return;
+        }
+
+        m_targetMounted = false;
+
+        if (rmdir(MOUNT_POINT.c_str()) != 0)
+        {
+            SCX_LOGERROR(m_logHandle, "rmdir /mnt/vmmcdrom failed");
+        }
     }
 
     if (insModPerformed)
@@ -314,6 +455,7 @@ bool
 ISOFetcher::ReadDataFromMountPoint()
 {
     SCX_LOGTRACE(m_logHandle, "Entering ReadDataFromMountPoint");
+    PhaseSpan span("ReadXML", PHASE_CATEGORY_AGENT);
 
     m_foundOSSpecializationFile = false;
     
@@ -383,47 +525,93 @@ ISOFetcher::ReadConfigFile(
     SCX_LOGINFO(
         m_logHandle,
         L"Attempting to open Specialization file:\"" + filename + L"\"");
-    // Read the file contents
-    std::ifstream fileStream(SCXCoreLib::StrToMultibyte(filename).c_str());
 
-    if (fileStream.is_open() &&
-        fileStream.good())
-    {
-        // Find the length of the file
-        fileStream.seekg(0, std::ios::end);
-        std::streampos length = fileStream.tellg();
-        fileStream.seekg(0, std::ios::beg);
+    // Map the file and decode it straight into the XML string, so the
+    // contents are not copied around on their way to the parser
+    int fd = open(SCXCoreLib::StrToMultibyte(filename).c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat statbuf;
 
-        std::vector<char> buffer(length);
-        std::vector<unsigned char> data(length);
+    if (fd >= 0 &&
+        fstat(fd, &statbuf) == 0)
+    {
+        size_t length = static_cast<size_t>(statbuf.st_size);
 
-        // Create a buffer of length to read the file into
         SCX_LOGINFO(m_logHandle,
                     "File Len:" + SCXCoreLib::StrToMultibyte(
                         SCXCoreLib::StrFrom(length)));
 
-        fileStream.read(&(buffer[0]), length);
-        data.assign(&(buffer[0]), &(buffer[0]) + length);
+        void* data = 0 < length ? mmap(0, length, PROT_READ, MAP_PRIVATE, fd, 0) : 0;
+        if (MAP_FAILED == data)
+        {
+            SCX_LOGERROR(m_logHandle, "Could not map specialization file errno: " +
+                         SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+            result = EXIT_FAILURE;
+        }
+        else
+        {
+            if (0 < length)
+            {
+                // XML String
+                madvise(data, length, MADV_SEQUENTIAL);
+                try
+                {
+                    m_osConfigurationXMLString.Assign(
+                        static_cast<const SCX::Util::Utf8Char*>(data), length);
+                }
+                catch (...)
+                {
+                    munmap(data, length);
+                    close(fd);
+                    throw;
+                }
+                munmap(data, length);
+            }
+            else
+            {
+                m_osConfigurationXMLString.clear();
+            }
 
-        // XML String
-        SCX::Util::Utf8String temp(data);
-        m_osConfigurationXMLString = temp;
-        SCX_LOGINFO(
-            m_logHandle,
-            "Specialization file contents len:" + SCXCoreLib::StrToMultibyte(
-                SCXCoreLib::StrFrom(m_osConfigurationXMLString.Size())));
-        m_foundOSSpecializationFile = true;
+            SCX_LOGINFO(
+                m_logHandle,
+                "Specialization file contents len:" + SCXCoreLib::StrToMultibyte(
+                    SCXCoreLib::StrFrom(m_osConfigurationXMLString.Size())));
+            m_foundOSSpecializationFile = true;
+        }
     }
     else
     {
         SCX_LOGERROR(m_logHandle, "Could not read specialization file");
         result = EXIT_FAILURE;
     }
-    fileStream.close();
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
 
     return result;
 }
 
+// Would the installer upgrade from the installed version?  Compares the
+// major.minor.patch.build fields the way the installer does; anything that
+// does not parse is left for the installer to decide.
+bool isNewerAgentVersion(std::string const& newVersion, std::string const& installedVersion)
+{
+    unsigned int newFields[4];
+    unsigned int installedFields[4];
+
+    if (sscanf(newVersion.c_str(), "%u.%u.%u.%u",
+               &newFields[0], &newFields[1], &newFields[2], &newFields[3]) != 4 ||
+        sscanf(installedVersion.c_str(), "%u.%u.%u.%u",
+               &installedFields[0], &installedFields[1], &installedFields[2], &installedFields[3]) != 4)
+    {
+        return true;
+    }
+
+    return std::lexicographical_compare(installedFields, installedFields + 4,
+                                        newFields, newFields + 4);
+}
+
 void ISOFetcher::InstallOrUpgradeAgent()
 {
     if (FoundSpecializationFile())
@@ -431,9 +619,22 @@ void ISOFetcher::InstallOrUpgradeAgent()
         std::string newAgentVersion = GetNewAgentVersion();
         std::string installUpgradeCommand = INSTALL_UPGRADE + newAgentVersion;
 
+        std::string installedVersion;
+        std::ifstream versionFile((ArgumentManager::Instance().GetVMMHome() + AGENT_VERSION_FILE).c_str());
+        std::getline(versionFile, installedVersion);
 
-        if (newAgentVersion != "")
+        if (newAgentVersion != "" && !isNewerAgentVersion(newAgentVersion, installedVersion))
         {
+            SCX_LOGINFO(m_logHandle, "No upgrade was required - installed version " + installedVersion +
+                        " is not older than " + newAgentVersion);
+        }
+        else if (newAgentVersion != "")
+        {
+            if (!EnsureMounted())
+            {
+                SCX_LOGERROR(m_logHandle, ("Unable to mount CD ROM to run the installer"));
+                return;
+            }
 
             CommandExecutor ce;
             int ret = ce.Execute(SCXCoreLib::StrFromMultibyte(installUpgradeCommand), "Install/Upgrade");
@@ -459,6 +660,76 @@ void ISOFetcher::InstallOrUpgradeAgent()
 }
 
 
+std::string ISOFetcher::GetOSConfigurationDigest() const
+{
+    // Hash the UTF-8 encoding so the digest does not depend on the in-memory representation
+    const std::string content = m_osConfigurationXMLString.Str();
+    return InputDigest().Add(content.data(), content.size()).Str();
+}
+
+bool ISOFetcher::IsSpecializationApplied() const
+{
+    const std::string digestFile = ArgumentManager::Instance().GetRootDir() + APPLIED_DIGEST_FILE;
+
+    std::string applied;
+    std::ifstream digestStream(digestFile.c_str());
+    std::getline(digestStream, applied);
+
+    return !applied.empty() && applied == GetOSConfigurationDigest();
+}
+
+void ISOFetcher::RecordAppliedSpecialization()
+{
+    const std::string digestFile = ArgumentManager::Instance().GetRootDir() + APPLIED_DIGEST_FILE;
+
+    // Replace the digest as a whole, so that a crash leaves the old one or the new one
+    const std::string tempFile = digestFile + ".tmp";
+    std::ofstream digestStream(tempFile.c_str(), std::ios::trunc);
+    digestStream << GetOSConfigurationDigest() << std::endl;
+    digestStream.close();
+
+    if (!digestStream || 0 != rename(tempFile.c_str(), digestFile.c_str()))
+    {
+        SCX_LOGERROR(m_logHandle, "Unable to record the applied specialization in " + digestFile);
+        unlink(tempFile.c_str());
+    }
+}
+
+void ISOFetcher::LeaveAppliedSpecialization()
+{
+    SCX_LOGINFO(m_logHandle, "Specialization file was applied before; removing the agent");
+
+    std::wstring path = SCXCoreLib::StrFromMultibyte(MOUNT_POINT);
+    bool onCDRom = 0 == m_osConfigurationXMLPath.compare(0, path.length(), path);
+
+    RemoveAgent(onCDRom);
+
+    if (onCDRom)
+    {
+        UnmountISO();
+    }
+}
+
+void ISOFetcher::RemoveAgent(bool onCDRom)
+{
+    CommandExecutor ce;
+
+    if (onCDRom && !EnsureMounted())
+    {
+        SCX_LOGERROR(m_logHandle, ("daemon removal failed, unable to mount CD ROM"));
+    }
+    else if (0 != ce.Execute(m_osConfigurationXMLPath +
+                            SCXCoreLib::StrFromMultibyte("install -r "),
+                        "install"))
+    {
+        SCX_LOGERROR(m_logHandle, ("daemon removal failed"));
+    }
+    else
+    {
+        SCX_LOGINFO(m_logHandle, ("daemon removal complete"));
+    }
+}
+
 std::string ISOFetcher::GetNewAgentVersion()
 {
     SCX_LOGINFO(m_logHandle, ("Entering GetNewAgentVersion"));
@@ -470,11 +741,11 @@ std::string ISOFetcher::GetNewAgentVersion()
     }
 
     // Get OSSpecialization
-    OSSpecializationReader::LinuxOSSpecialization spec;
-    OSSpecializationReader::Instance().GetLinuxOSSpecialization(spec);
+    const OSSpecializationReader::LinuxOSSpecialization* spec =
+        OSSpecializationReader::Instance().GetLinuxOSSpecialization();
 
     SCX::Util::Utf8String agentVersion;
-    if (spec.GetAgentVersion(agentVersion))
+    if (NULL != spec && spec->GetAgentVersion(agentVersion))
     {
         return agentVersion.Str();
     }
@@ -493,45 +764,40 @@ void ISOFetcher::TerminateSetup()
     bool specializationComplete = StatusMessage::Instance().ReadChildOfRoot(
         StatusMessageStrings::SpecializationComplete, tagValue);
 
+    std::wstring path = SCXCoreLib::StrFromMultibyte(MOUNT_POINT);
+    bool onCDRom = 0 == m_osConfigurationXMLPath.compare(0, path.length(), path);
+
     if (specializationComplete)
     {
-        CommandExecutor ce;
-        
-        if (0 != ce.Execute(m_osConfigurationXMLPath +
-                                SCXCoreLib::StrFromMultibyte("install -r "),
-                            "install"))
-        {
-            SCX_LOGERROR(m_logHandle, ("daemon removal failed"));
-        }
-        else
-        {
-            SCX_LOGINFO(m_logHandle, ("daemon removal complete"));
-        }
+        // An agent installed again later has nothing to do with the same file
+        RecordAppliedSpecialization();
+
+        PhaseTimeline::Instance().CopyTo(ArgumentManager::Instance().GetRootDir() + TIMELINE_COPY_FILE);
+
+        RemoveAgent(onCDRom);
     }
 
     // working here
-    std::wstring path = SCXCoreLib::StrFromMultibyte(MOUNT_POINT);
-    if (0 == m_osConfigurationXMLPath.compare(0, path.length(), path))
+    if (onCDRom)
     {
         UnmountISO();
     }
 
-
     if (specializationComplete)
     {
         // bug workaround for ubuntu
         ModifyGrub();
 
-        char const* args[] = { "shutdown", "-h", "now", 0 };
-
-        execv ("/sbin/shutdown", const_cast<char* const*>(args));
-        execv ("/etc/shutdown", const_cast<char* const*>(args));
-        execv ("/bin/shutdown", const_cast<char* const*>(args));
+        CommandExecutor::Shutdown("-h");
 
         SCX_LOGERROR(m_logHandle, ("system shutdown failed"));
     }
     else
     {
+        // The agent stays installed; leave the complete status document behind
+        // for the next run and whoever looks into the failure
+        StatusMessage::Instance().Compact();
+
         SCX_LOGERROR(m_logHandle, ("Terminating abnormally due to a failed specialization step."));
         exit(-1);
     }
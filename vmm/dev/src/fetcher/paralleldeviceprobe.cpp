@@ -0,0 +1,205 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        paralleldeviceprobe.cpp
+
+   \brief       Looks for a file on several cd rom devices at once, using the
+                thread pool, and reports the first device that has it.
+
+   \date        10-18-2026 12:20:31
+
+*/
+/*----------------------------------------------------------------------------*/
+#include <iso9660reader.h>
+#include <paralleldeviceprobe.h>
+
+#include <algorithm>
+
+#include <scxcorelib/scxassert.h>
+#include <scxcorelib/scxexception.h>
+#include <scxcorelib/scxthreadpool.h>
+#include <scxcorelib/stringaid.h>
+#include <util/LogHandleCache.h>
+
+using VMM::GuestAgent::Fetcher::ISO9660Reader;
+using VMM::GuestAgent::Fetcher::ParallelDeviceProbe;
+
+namespace
+{
+
+/** Thread pool limits the worker count to this */
+size_t const MAX_PROBE_THREADS = 256;
+
+/*----------------------------------------------------------------------------*/
+/**
+   Thread parameter for a single device probe
+
+*/
+class ProbeThreadParam : public SCXCoreLib::SCXThreadParam
+{
+public:
+    ProbeThreadParam(ParallelDeviceProbe* probe, size_t index)
+        : SCXCoreLib::SCXThreadParam()
+        , m_probe(probe)
+        , m_index(index)
+    {
+    }
+
+    ParallelDeviceProbe* m_probe;   //!< Probe the task belongs to
+    size_t               m_index;   //!< Index of the device to probe
+};
+
+}
+
+ParallelDeviceProbe::ParallelDeviceProbe(const std::string& fileName)
+    : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
+                      "scx.vmmguestagent.src.fetcher.paralleldeviceprobe"))
+    , m_fileName(fileName)
+    , m_pending(0)
+    , m_winner(0)
+{
+    m_cond.SetSleep(0);
+}
+
+ParallelDeviceProbe::~ParallelDeviceProbe()
+{
+}
+
+bool ParallelDeviceProbe::Run(const std::vector<std::string>& devices,
+                              std::string& device,
+                              std::vector<unsigned char>& contents,
+                              std::vector<std::string>& volumes)
+{
+    device.clear();
+    contents.clear();
+    volumes.clear();
+
+    m_devices = devices;
+    m_hasVolume.assign(devices.size(), false);
+    m_contents.clear();
+    m_pending = devices.size();
+    m_winner = devices.size();
+
+    if (devices.empty())
+    {
+        return false;
+    }
+
+    {
+        SCXCoreLib::SCXThreadPool pool;
+        pool.SetThreadLimit(static_cast<long>(std::min(devices.size(), MAX_PROBE_THREADS)));
+        pool.Start();
+
+        for (size_t i = 0; i < devices.size(); ++i)
+        {
+            SCXCoreLib::SCXThreadParamHandle param(new ProbeThreadParam(this, i));
+            pool.QueueTask(SCXCoreLib::SCXThreadPoolTaskHandle(
+                               new SCXCoreLib::SCXThreadPoolTask(ProbeThreadBody, param)));
+        }
+
+        {
+            SCXCoreLib::SCXConditionHandle h(m_cond);
+            while (m_winner == m_devices.size() && m_pending > 0)
+            {
+                h.Wait();
+            }
+        }
+
+        // Drops the probes still queued and waits for the ones in flight.
+        // They see the cancellation and stop at their next check, but one
+        // blocked in a read of an unresponsive device is waited for until
+        // the read returns
+        pool.Shutdown();
+    }
+
+    if (m_winner < m_devices.size())
+    {
+        device = m_devices[m_winner];
+        contents.swap(m_contents);
+        return true;
+    }
+
+    for (size_t i = 0; i < m_devices.size(); ++i)
+    {
+        if (m_hasVolume[i])
+        {
+            volumes.push_back(m_devices[i]);
+        }
+    }
+
+    return false;
+}
+
+void ParallelDeviceProbe::ProbeThreadBody(SCXCoreLib::SCXThreadParamHandle& param)
+{
+    ProbeThreadParam* p = static_cast<ProbeThreadParam*>(param.GetData());
+    SCXASSERT(p != 0);
+
+    p->m_probe->Probe(p->m_index);
+}
+
+void ParallelDeviceProbe::Probe(size_t index)
+{
+    const std::string& device = m_devices[index];
+    bool hasVolume = false;
+    bool found = false;
+    std::vector<unsigned char> contents;
+
+    try
+    {
+        if (!IsCancelled())
+        {
+            ISO9660Reader reader(device);
+            hasVolume = reader.Open();
+            if (hasVolume && !IsCancelled())
+            {
+                found = reader.ReadRootFile(m_fileName, contents);
+            }
+        }
+    }
+    catch (const SCXCoreLib::SCXException& e)
+    {
+        SCX_LOGERROR(m_logHandle, L"Probe of " + SCXCoreLib::StrFromMultibyte(device) +
+                     L" failed: " + e.What());
+    }
+    catch (const std::exception& e)
+    {
+        SCX_LOGERROR(m_logHandle, "Probe of " + device + " failed: " + e.what());
+    }
+
+    SCXCoreLib::SCXConditionHandle h(m_cond);
+
+    m_hasVolume[index] = hasVolume;
+    if (found && m_winner == m_devices.size())
+    {
+        SCX_LOGINFO(m_logHandle, "Found " + m_fileName + " on " + device);
+        m_winner = index;
+        m_contents.swap(contents);
+    }
+
+    --m_pending;
+    h.Signal();
+}
+
+bool ParallelDeviceProbe::IsCancelled()
+{
+    SCXCoreLib::SCXConditionHandle h(m_cond);
+    return m_winner != m_devices.size();
+}
@@ -0,0 +1,156 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        paralleldeviceprobe.h
+
+   \brief       Looks for a file on several cd rom devices at once, using the
+                thread pool, and reports the first device that has it.
+
+   \date        10-18-2026 12:20:31
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef PARALLELDEVICEPROBE_H
+#define PARALLELDEVICEPROBE_H
+
+#include <string>
+#include <vector>
+
+#include <scxcorelib/scxcondition.h>
+#include <scxcorelib/scxlog.h>
+#include <scxcorelib/scxthread.h>
+
+namespace VMM
+{
+
+    namespace GuestAgent
+    {
+
+        namespace Fetcher
+        {
+
+            class ParallelDeviceProbe
+            {
+
+            public:
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Constructor for ParallelDeviceProbe
+
+                   \param      fileName  Root directory file to look for on each device
+
+                */
+                explicit ParallelDeviceProbe(const std::string& fileName);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Destructor for ParallelDeviceProbe
+
+                */
+                ~ParallelDeviceProbe();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Probe all devices concurrently.  Once one device yields the file,
+                   probes that have not started yet are dropped and the ones in flight
+                   stop at their next check, between reads.  Run() returns when those
+                   have stopped, so a read that hangs on a slow or dead device still
+                   holds it up; probing at the same time keeps that to the slowest
+                   single read rather than the sum over all devices.
+
+                   \param      devices   Device nodes to probe
+                   \param      device    Receives the device the file was read from
+                   \param      contents  Receives the file contents
+                   \param      volumes   Receives, in the order given, the devices that hold
+                                         an iso9660 volume (filled in only when no device
+                                         yielded the file)
+
+                   \return     true if the file was read from one of the devices
+
+                */
+                bool Run(const std::vector<std::string>& devices,
+                         std::string& device,
+                         std::vector<unsigned char>& contents,
+                         std::vector<std::string>& volumes);
+
+            private:
+
+                /** Intentionally not implemented */
+                ParallelDeviceProbe(const ParallelDeviceProbe&);
+                ParallelDeviceProbe& operator=(const ParallelDeviceProbe&);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Thread pool task body probing a single device
+
+                */
+                static void ProbeThreadBody(SCXCoreLib::SCXThreadParamHandle& param);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Probe one device and record the result
+
+                */
+                void Probe(size_t index);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Has some device already yielded the file?
+
+                */
+                bool IsCancelled();
+
+                /** Log Handle */
+                SCXCoreLib::SCXLogHandle   m_logHandle;
+
+                /** File to look for */
+                std::string                m_fileName;
+
+                /** Devices being probed */
+                std::vector<std::string>   m_devices;
+
+                /** Per device: does it hold an iso9660 volume? */
+                std::vector<bool>          m_hasVolume;
+
+                /** Protects the members below and signals probe completion */
+                SCXCoreLib::SCXCondition   m_cond;
+
+                /** Number of probes that have not completed yet */
+                size_t                     m_pending;
+
+                /** Index of the device the file was read from, or m_devices.size() */
+                size_t                     m_winner;
+
+                /** Contents read from the winning device */
+                std::vector<unsigned char> m_contents;
+
+            }; // End of ParallelDeviceProbe class
+
+        } // End of Fetcher namespace
+
+    } // End of GuestAgent
+
+} // End of VMM
+
+#endif /* PARALLELDEVICEPROBE_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
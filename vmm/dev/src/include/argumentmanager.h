@@ -74,9 +74,14 @@ public:
     std::string const& GetVMMHome() const;
     std::string const& GetConfigFilename() const;
 
+    /// @return the root directory configuration files are written under;
+    ///         empty for the running system
+    std::string const& GetRootDir() const;
+
 private:
     std::string m_vmmHome;
     std::string m_configFilename;
+    std::string m_rootDir;
 };
 
 
@@ -92,6 +97,12 @@ ArgumentManager::GetConfigFilename() const
     return m_configFilename;
 }
 
+inline std::string const&
+ArgumentManager::GetRootDir() const
+{
+    return m_rootDir;
+}
+
 
 } // namespace Utilities
 } // namespace GuestAgent
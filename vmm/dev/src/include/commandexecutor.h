@@ -32,6 +32,7 @@
 #define SCRIPTEXECUTOR_H
 
 #include <scxcorelib/stringaid.h>
+#include <scxcorelib/scxhandle.h>
 #include <scxcorelib/scxprocess.h>
 
 #include <util/LogHandleCache.h>
@@ -53,6 +54,12 @@ namespace VMM
             char const CONFIG_FILE_NAME[] =
                 "/opt/microsoft/scvmmguestagent/etc/commandtimeout";
 
+            /** Commands started with ExecuteAsync() that run at the same time */
+            unsigned int const DEFAULT_CONCURRENT_COMMANDS = 8;
+
+            /** Output lines longer than this are logged in pieces */
+            size_t const MAXIMUM_OUTPUT_LINE = 4096;
+
             /**
               \brief Attempts to open and read a timeout value from
                      CONFIG_FILE_NAME.  The value is also clamped between
@@ -65,6 +72,92 @@ namespace VMM
               */
             unsigned int readConfig ();
 
+            /**
+              \brief Attempts to open and read a timeout value from
+                     fileName.  The value is clamped the same way as by
+                     readConfig().
+
+              \return The clamped value read from fileName, or defaultValue
+                      if the file does not exist or cannot be parsed.
+              */
+            unsigned int readConfig (char const* fileName,
+                                     unsigned int const defaultValue);
+
+            /**
+              \brief Clamps a timeout between MINIMUM_TIMEOUT and
+                     MAXIMUM_TIMEOUT, the same way readConfig() does.
+              */
+            unsigned int clampTimeout (unsigned long const timeoutSecs);
+
+            /**
+              \brief Runs commands in place of CommandExecutor, e.g. to record
+                     them when a specialization is replayed offline.  Install
+                     one with CommandExecutor::SetRunner().
+              */
+            class CommandRunner
+            {
+
+            public:
+
+                virtual ~CommandRunner()
+                {}
+
+                /**
+                  \brief Runs a script; same contract as CommandExecutor::Execute()
+                  */
+                virtual int Execute(const std::wstring& command,
+                                    const std::string& component,
+                                    unsigned int const timeoutSecs) = 0;
+
+                /**
+                  \brief Shuts the system down; same contract as
+                         CommandExecutor::Shutdown()
+                  */
+                virtual void Shutdown(char const* option) = 0;
+
+            }; // End of CommandRunner class
+
+            class CommandState;
+
+            /**
+              \brief A command started by CommandExecutor::ExecuteAsync().
+                     Destroying it waits for the command to complete.
+              */
+            class PendingCommand
+            {
+
+            public:
+
+                explicit PendingCommand(const SCXCoreLib::SCXHandle<CommandState>& state);
+
+                ~PendingCommand();
+
+                /**
+                  \brief Waits for the command to complete.
+
+                  \return int Return value of the command executed, as
+                              returned by CommandExecutor::Execute()
+                  */
+                int Wait();
+
+                /**
+                  \brief Has the command completed?
+                  */
+                bool IsDone() const;
+
+            private:
+
+                /** Intentionally not implemented */
+                PendingCommand(const PendingCommand&);
+                PendingCommand& operator=(const PendingCommand&);
+
+                /** Command and, once it completed, its return value */
+                SCXCoreLib::SCXHandle<CommandState> m_state;
+
+            }; // End of PendingCommand class
+
+            typedef SCXCoreLib::SCXHandle<PendingCommand> PendingCommandHandle;
+
             class CommandExecutor 
             {
 
@@ -101,14 +194,60 @@ namespace VMM
                   \param command The script to run
                   \param component Text identifier used in log output
                   \param timeoutSecs The time to wait for the script to
-                                     run in seconds
+                                     run in seconds; clamped by clampTimeout()
 
                   \return int Return value of the command executed
+
+                  Output is logged line by line while the script runs, so
+                  it is never held in memory as a whole.
                   */
                 int Execute(const std::wstring& command, 
                             const std::string& component,
                             unsigned int const timeoutSecs = DEFAULT_TIMEOUT);
 
+                /**
+                  \brief Starts a script and returns without waiting for it.
+                         The scripts started this way are run and reaped by
+                         one supervisor thread.  At most the concurrency limit
+                         of them run at once; the others start as earlier
+                         ones exit.
+
+                  \param command The script to run
+                  \param component Text identifier used in log output
+                  \param timeoutSecs The time to wait for the script to
+                                     run in seconds; clamped by clampTimeout()
+
+                  \return Handle to wait for the script with
+                  */
+                PendingCommandHandle ExecuteAsync(const std::wstring& command,
+                                                  const std::string& component,
+                                                  unsigned int const timeoutSecs = DEFAULT_TIMEOUT);
+
+                /**
+                  \brief Sets how many scripts started with ExecuteAsync()
+                         run at once.
+
+                  \param limit Number of scripts; at least one
+                  */
+                static void SetConcurrencyLimit(unsigned int const limit);
+
+                /**
+                  \brief Replaces the agent with shutdown(8).
+
+                  \param option "-r" to reboot, "-h" to halt
+
+                  \return Only if shutdown could not be run
+                  */
+                static void Shutdown(char const* option);
+
+                /**
+                  \brief Sends all commands, and shutdown, to a runner instead
+                         of the shell.
+
+                  \param runner Runner to use; 0 to run commands again
+                  */
+                static void SetRunner(CommandRunner* runner);
+
 
             }; // End of CommandExecutor class
 
@@ -60,8 +60,8 @@ namespace VMM
 
             private:
 
-                /** XML object with specialization */
-                VMM::GuestAgent::SpecializationReader::OSSpecializationReader::OSConfiguration m_xmlConfigurator;
+                /** XML object with specialization; must outlive the visitor */
+                const VMM::GuestAgent::SpecializationReader::OSSpecializationReader::OSConfiguration& m_xmlConfigurator;
 
                 /** Log Handle */
                 SCXCoreLib::SCXLogHandle m_logHandle;
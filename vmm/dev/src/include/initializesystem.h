@@ -0,0 +1,49 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        initializesystem.h
+
+   \brief       Runs the specialization: finds and reads the specialization file,
+                then creates and executes the configurators
+
+   \date        10-18-2026 17:02:40
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef INITIALIZESYSTEM_H
+#define INITIALIZESYSTEM_H
+
+/*----------------------------------------------------------------------------*/
+/**
+   Run the specialization the agent was started for
+
+   \param      argc        Number of command line tokens
+   \param      argv        Command line tokens
+   \param      daemonize   Detach from the caller first, as the agent does at boot
+
+*/
+void
+InitializeSystem(
+    int const& argc,
+    char const* const* argv,
+    bool daemonize);
+
+#endif /* INITIALIZESYSTEM_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -0,0 +1,122 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        inputdigest.h
+
+   \brief       Digest of the inputs of a specialization step, to tell whether the
+                step has already been applied with the same inputs.  FNV-1a; it
+                detects changes, it does not protect what it digests.
+
+   \date        10-18-2026 18:40:26
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef INPUTDIGEST_H
+#define INPUTDIGEST_H
+
+#include <cstdio>
+#include <string>
+
+#include <scxcorelib/scxcmn.h>
+
+namespace VMM
+{
+
+    namespace GuestAgent
+    {
+
+        namespace Utilities
+        {
+
+            class InputDigest
+            {
+
+            public:
+
+                InputDigest()
+                  : m_hash(OFFSET_BASIS)
+                {}
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Add bytes to the digest
+
+                */
+                InputDigest& Add(const char* data, size_t size)
+                {
+                    for (size_t i = 0; i < size; ++i)
+                    {
+                        m_hash ^= static_cast<unsigned char>(data[i]);
+                        m_hash *= PRIME;
+                    }
+                    return *this;
+                }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Add a field; fields are length prefixed so that "ab","c" and "a","bc"
+                   digest differently
+
+                */
+                InputDigest& Add(const std::string& field)
+                {
+                    Add(static_cast<scxulong>(field.size()));
+                    return Add(field.data(), field.size());
+                }
+
+                InputDigest& Add(scxulong value)
+                {
+                    char bytes[sizeof(value)];
+                    for (size_t i = 0; i < sizeof(value); ++i)
+                    {
+                        bytes[i] = static_cast<char>(value >> (8 * i));
+                    }
+                    return Add(bytes, sizeof(bytes));
+                }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   The digest as 16 hex digits
+
+                */
+                std::string Str() const
+                {
+                    char text[17];
+                    snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(m_hash));
+                    return text;
+                }
+
+            private:
+
+                static const scxulong OFFSET_BASIS = 0xcbf29ce484222325ULL;
+                static const scxulong PRIME = 0x100000001b3ULL;
+
+                scxulong m_hash;
+
+            }; // End of InputDigest class
+
+        } // End of Utilities namespace
+
+    } // End of GuestAgent namespace
+
+} // End of VMM namespace
+
+#endif /* INPUTDIGEST_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -35,6 +35,7 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
 
 #include <util/LogHandleCache.h>
 
@@ -67,7 +68,7 @@ namespace VMM
                    \throws     ISOFetcherException if unable to fetch file
 
                 */
-                inline SCX::Util::Utf8String GetOSConfigurationXMLString()
+                inline const SCX::Util::Utf8String& GetOSConfigurationXMLString() const
                 {
                     return m_osConfigurationXMLString;
                 }
@@ -86,6 +87,39 @@ namespace VMM
                     return m_foundOSSpecializationFile;
                 }
 
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Digest of the specialization file, recorded once the specialization
+                   completes, to recognize the same file on later boots
+
+                   \return     The digest as hex digits
+
+                */
+                std::string GetOSConfigurationDigest() const;
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Check whether the specialization file found is the one the last
+                   successful specialization applied.  The digest is kept under the
+                   root directory but outside SCVMM_HOME, so it outlives the agent
+                   removal that ends a specialization.
+
+                   \return     true if the digests match
+
+                */
+                bool IsSpecializationApplied() const;
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   The agent was installed again on a machine the specialization file was
+                   applied to already.  Nothing is configured; the agent removes itself
+                   again, as after the original specialization, and the machine keeps
+                   running.
+
+                */
+                void LeaveAppliedSpecialization();
+
                 /*----------------------------------------------------------------------------*/
                 /**
                    Return path to the guest agent upgrade bits.
@@ -185,6 +219,8 @@ namespace VMM
                     : m_logHandle(
                           SCX::Util::LogHandleCache::Instance().GetLogHandle(
                           "scx.vmmguestagent.src.fetcher.isofetcher"))
+                    , m_targetMounted(false)
+                    , m_foundOSSpecializationFile(false)
                 {
                 }
 
@@ -196,6 +232,59 @@ namespace VMM
                 */
                 bool MountISO();
 
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Record the digest of the specialization file as applied
+
+                */
+                void RecordAppliedSpecialization();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Run the installer to remove the agent from the system
+
+                   \param      onCDRom   Whether the installer is on the cd rom
+
+                */
+                void RemoveAgent(bool onCDRom);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Look for the specialization file on all of the given devices at once
+
+                   \param      devices   Device nodes to try; duplicates and missing nodes are skipped
+
+                   \return     true once the specialization file was read from one of the devices
+
+                */
+                bool ProbeDevices(const std::vector<std::string>& devices);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Mount the cd rom the specialization file was read from, unless it is
+                   mounted already.  Needed only to run the installer on it.
+
+                   \return     true if the cd rom contents are available under the mount point
+
+                */
+                bool EnsureMounted();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Check whether a file system is mounted on the given directory
+
+                   \param      path      Directory, with a trailing slash
+
+                   \return     true if path lives on a different device than its parent
+
+                */
+                static bool IsMountPoint(const std::string& path);
+
                 /*----------------------------------------------------------------------------*/
                 /**
                    
@@ -44,6 +44,8 @@ namespace VMM
         {
             typedef std::vector<SCX::Util::Utf8String> stringArray;
 
+            class SpecializationParser;
+
             /*----------------------------------------------------------------------------*/
             /**
                 wrapper class Optional, used to implement getter which can fail if the value
@@ -90,6 +92,15 @@ namespace VMM
                     return m_val;
                 }
 
+                /*----------------------------------------------------------------------------*/
+                /**
+                    inner value if valid, to read it without a copy
+                */
+                inline const T* Get() const
+                {
+                    return m_isValid ? &m_val : 0;
+                }
+
                 /*----------------------------------------------------------------------------*/
                 /**
                     assignment operator
@@ -136,9 +147,9 @@ namespace VMM
                 public:
                     /*----------------------------------------------------------------------------*/
                     /**
-                        read from node tree
+                        read from the parser, which is at the start of the element
                     */
-                    void Read(const SCX::Util::Xml::XElementPtr& ptr);
+                    void Read(SpecializationParser& parser);
                     /*----------------------------------------------------------------------------*/
                     /**
                         get gateway address
@@ -165,9 +176,15 @@ namespace VMM
 
                     /*----------------------------------------------------------------------------*/
                     /**
-                        read from node tree
+                        NetworkProperties constructor
+                    */
+                    NetworkProperties() : m_isStatic(false) {}
+
+                    /*----------------------------------------------------------------------------*/
+                    /**
+                        read from the parser, which is at the start of the element
                     */
-                    void Read(const SCX::Util::Xml::XElementPtr& ptr);
+                    void Read(SpecializationParser& parser);
                     /*----------------------------------------------------------------------------*/
                     /**
                         return static IP if exists
@@ -193,9 +210,9 @@ namespace VMM
                 public:
                     /*----------------------------------------------------------------------------*/
                     /**
-                        read from node tree
+                        read from the parser, which is at the start of the element
                     */
-                    void Read(const SCX::Util::Xml::XElementPtr& ptr);
+                    void Read(SpecializationParser& parser);
                     /*----------------------------------------------------------------------------*/
                     /**
                         return MAC Address if exists
@@ -229,7 +246,7 @@ namespace VMM
                     std::vector<SCX::Util::Utf8String> DNSSearchSuffixes;
 
                 private:
-                    void ReadGateways(const SCX::Util::Xml::XElementPtr& ptr);
+                    void ReadGateways(SpecializationParser& parser);
 
                     OptionalString                m_macAddress;
                     Optional<NetworkProperties>   m_ipV4;
@@ -245,9 +262,9 @@ namespace VMM
                 public:
                     /*----------------------------------------------------------------------------*/
                     /**
-                        read from node tree
+                        read from the parser, which is at the start of the element
                     */
-                    void Read(const SCX::Util::Xml::XElementPtr& xElementPtr);
+                    void Read(SpecializationParser& parser);
                     /*----------------------------------------------------------------------------*/
                     /**
                         return user name if exists
@@ -297,9 +314,9 @@ namespace VMM
                 public:
                     /*----------------------------------------------------------------------------*/
                     /**
-                        read from node tree
+                        read from the parser, which is at the start of the element
                     */
-                    void Read(const SCX::Util::Xml::XElementPtr& xElementPtr);
+                    void Read(SpecializationParser& parser);
 
                     /*----------------------------------------------------------------------------*/
                     /**
@@ -321,6 +338,11 @@ namespace VMM
                         return Root user if exists
                     */
                     inline bool GetRoot(User& val) const { return m_root.TryGet(val); }
+                    /*----------------------------------------------------------------------------*/
+                    /**
+                        return the most Run Once commands of a group to run at once, if given
+                    */
+                    inline bool GetMaxConcurrentCommands(unsigned int& val) const { return m_maxConcurrentCommands.TryGet(val); }
 
                     /*----------------------------------------------------------------------------*/
                     /**
@@ -328,19 +350,26 @@ namespace VMM
                     */
                     std::map<int, SCX::Util::Utf8String> RunOnceCommands;
                     /*----------------------------------------------------------------------------*/
+                    /**
+                        group of each Run Once command that has one, by sequence; commands
+                        adjacent in sequence order with the same group run concurrently
+                    */
+                    std::map<int, SCX::Util::Utf8String> RunOnceCommandGroups;
+                    /*----------------------------------------------------------------------------*/
                     /**
                         list of VNet adapters
                     */
                     std::vector<VNetAdapter> VNetAdapters;
                 private:
-                    void ReadVNetAdapters(const SCX::Util::Xml::XElementPtr& vNetAdaptersElementPtr);
-                    void ReadRunOnceCommands(const SCX::Util::Xml::XElementPtr& vNetAdaptersElementPtr);
-                    void ReadRootUser(const SCX::Util::Xml::XElementPtr& vNetAdaptersElementPtr);
+                    void ReadVNetAdapters(SpecializationParser& parser);
+                    void ReadRunOnceCommands(SpecializationParser& parser);
+                    void ReadRootUser(SpecializationParser& parser);
 
                     OptionalString    m_hostName;
                     OptionalString    m_domainName;
                     Optional<int>     m_timeZone;
                     Optional<User>    m_root;
+                    Optional<unsigned int> m_maxConcurrentCommands;
                 };
 
                 /*----------------------------------------------------------------------------*/
@@ -352,15 +381,20 @@ namespace VMM
                 public:
                     /*----------------------------------------------------------------------------*/
                     /**
-                        read from node tree
+                        read from the parser, which is at the start of the element
                     */
-                    void Read(const SCX::Util::Xml::XElementPtr& xElementPtr);
+                    void Read(SpecializationParser& parser);
                     /*----------------------------------------------------------------------------*/
                     /**
                         return OS Configuration if exists
                     */
                     inline bool GetOSConfiguration(OSConfiguration& val) const { return m_osConfiguration.TryGet(val); }
                     /*----------------------------------------------------------------------------*/
+                    /**
+                        return OS Configuration if exists, without a copy
+                    */
+                    inline const OSConfiguration* GetOSConfiguration() const { return m_osConfiguration.Get(); }
+                    /*----------------------------------------------------------------------------*/
                     /**
                         return Schema Version if exists
                     */
@@ -383,8 +417,12 @@ namespace VMM
                 */
                 bool GetLinuxOSSpecialization(LinuxOSSpecialization& val);
 
-                protected:
-                SCX::Util::Xml::XElementPtr  m_pXElementRoot;
+                /*----------------------------------------------------------------------------*/
+                /**
+                    return LinuxOSSpecialization if exists, without a copy; valid until
+                    the next LoadXML()
+                */
+                const LinuxOSSpecialization* GetLinuxOSSpecialization() const;
 
                 private:
 
@@ -396,53 +434,26 @@ namespace VMM
 
                 /*----------------------------------------------------------------------------*/
                 /**
-                    load LinuxOSSpecialization object from xml root element 
+                    read a list of string elements of the given element id
                 */
-                void Load();
+                static void ReadStrings(SpecializationParser& parser,
+                                        int element,
+                                        std::vector<SCX::Util::Utf8String>& values);
 
-                SCX::Util::Utf8String         m_xmlString;
                 Optional<LinuxOSSpecialization> m_specialization;
 
                 /*----------------------------------------------------------------------------*/
                 /**
-                    xsd schema tag values
+                    xsd schema attribute names and values; the element names are in
+                    the table the parser looks them up in
                 */
-                static const std::string sLinuxOSSpecialization;
-                static const std::string sAgentVersion;
-                static const std::string sSchemaVersion;
-                static const std::string sOSConfiguration;
-                static const std::string sHostName;
-                static const std::string sDomainName;
-                static const std::string sTimeZone;
-                static const std::string sVNetAdapters;
-                static const std::string sRunOnceCommands;
-                static const std::string sRunOnceCommand;
                 static const std::string sCommandSequence;
-                static const std::string sVNetAdapter;
-                static const std::string sMACAddress;
+                static const std::string sCommandGroup;
+                static const std::string sMaxConcurrency;
                 static const std::string sAddressType;
-                static const std::string sGateways;
-                static const std::string sGateway;
-                static const std::string sAddress;
                 static const std::string sSTATIC;
                 static const std::string sDHCP;
-                static const std::string sIPV4Property;
-                static const std::string sIPV6Property;
-                static const std::string sStaticIP;
-                static const std::string sMetric;
-                static const std::string sNameServers;
-                static const std::string sNameServer;
-                static const std::string sUsers;
-                static const std::string sUser;
                 static const std::string sRoot;
-                static const std::string sUserName;
-                static const std::string sPassword;
-                static const std::string sSSHKey;
-                static const std::string sUID;
-                static const std::string sGroupID;
-                static const std::string sPrimaryGroup;
-                static const std::string sDNSSearchSuffixes;
-                static const std::string sDNSSearchSuffix;
 
 			public:
 				virtual /*dtor*/ ~OSSpecializationReader () {}
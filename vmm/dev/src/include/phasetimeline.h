@@ -0,0 +1,227 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        phasetimeline.h
+
+   \brief       Records when each phase of the specialization starts and ends, and
+                writes the spans as a Chrome trace-event timeline next to the
+                status file.  A completed specialization copies it next to the
+                agent log, as the agent removal deletes the status directory.
+
+   \date        10-18-2026 16:20:31
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef PHASETIMELINE_H
+#define PHASETIMELINE_H
+
+#include <string>
+#include <vector>
+
+#include <scxcorelib/scxcmn.h>
+#include <scxcorelib/scxsingleton.h>
+#include <scxcorelib/scxthreadlock.h>
+
+#include <util/LogHandleCache.h>
+
+namespace VMM
+{
+
+    namespace GuestAgent
+    {
+
+        namespace Utilities
+        {
+
+            /** Categories the spans are grouped by in the timeline */
+            char const PHASE_CATEGORY_AGENT[]        = "agent";
+            char const PHASE_CATEGORY_CONFIGURATOR[] = "configurator";
+            char const PHASE_CATEGORY_COMMAND[]      = "command";
+
+            class PhaseTimeline : public SCXCoreLib::SCXSingleton<PhaseTimeline>
+            {
+
+            public:
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Constructor for PhaseTimeline
+
+                */
+                PhaseTimeline()
+                  : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
+                                    "scx.vmmguestagent.utilities.phasetimeline"))
+                  , m_lock(SCXCoreLib::ThreadLockHandleGet())
+                  , m_processWritten(false)
+                {}
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Current time for the timeline
+
+                   \return     Microseconds on the monotonic clock
+
+                */
+                static scxulong Now();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Record a span that has ended.  Spans are kept in memory until the
+                   next Flush().
+
+                   \param      name      What ran
+                   \param      category  One of the PHASE_CATEGORY constants
+                   \param      start     Now() when it started
+                   \param      finish    Now() when it ended
+
+                */
+                void Record(const std::string& name,
+                            const char* category,
+                            scxulong start,
+                            scxulong finish);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Set the file the timeline is appended to.  Spans recorded before it
+                   is set are written by the first Flush() after.
+
+                   \param      path      Timeline file
+
+                */
+                void SetFile(const std::string& path);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Set the text the agent run is labeled with in the timeline
+
+                   \param      label     Agent name and version
+
+                */
+                void SetLabel(const std::string& label);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Append the spans recorded since the last flush to the timeline file.
+                   The file is a Chrome trace-event JSON array that every agent run
+                   appends to, so runs before and after a reboot end up side by side;
+                   each run is a process of its own in the trace viewer.
+
+                   \return     False if the file is not set or could not be written;
+                               the spans are kept for the next attempt then
+
+                */
+                bool Flush();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Flush the timeline and copy the file somewhere that outlives the
+                   agent home, replacing any earlier copy
+
+                   \param      path      File to copy the timeline to
+
+                   \return     False if the timeline could not be flushed or copied
+
+                */
+                bool CopyTo(const std::string& path);
+
+            private:
+
+                /** Making the class a friend to enable destruction */
+                friend class SCXCoreLib::SCXSingleton<PhaseTimeline>;
+
+                /** One recorded span */
+                struct Span
+                {
+                    std::string m_name;
+                    const char* m_category;
+                    scxulong    m_start;
+                    scxulong    m_finish;
+                    long        m_thread;
+                };
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Format the trace event naming this agent run
+
+                */
+                std::string FormatProcess(int pid) const;
+
+                /** Log Handle */
+                SCXCoreLib::SCXLogHandle        m_logHandle;
+
+                /** Lock for the recorded spans */
+                SCXCoreLib::SCXThreadLockHandle m_lock;
+
+                /** Timeline file */
+                std::string                     m_file;
+
+                /** Label of the agent run */
+                std::string                     m_label;
+
+                /** Spans not written yet */
+                std::vector<Span>               m_spans;
+
+                /** Whether this run has been named in the file yet */
+                bool                            m_processWritten;
+
+            }; // End of PhaseTimeline class
+
+            /*----------------------------------------------------------------------------*/
+            /**
+               Records a span covering the lifetime of the object
+
+            */
+            class PhaseSpan
+            {
+
+            public:
+
+                PhaseSpan(const std::string& name, const char* category)
+                  : m_name(name)
+                  , m_category(category)
+                  , m_start(PhaseTimeline::Now())
+                {}
+
+                ~PhaseSpan()
+                {
+                    PhaseTimeline::Instance().Record(m_name, m_category, m_start, PhaseTimeline::Now());
+                }
+
+            private:
+
+                /** Intentionally not implemented */
+                PhaseSpan(const PhaseSpan&);
+                PhaseSpan& operator=(const PhaseSpan&);
+
+                std::string m_name;
+                const char* m_category;
+                scxulong    m_start;
+
+            }; // End of PhaseSpan class
+
+        } // End of Utilities namespace
+
+    } // End of GuestAgent namespace
+
+} // End of VMM namespace
+
+#endif /* PHASETIMELINE_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
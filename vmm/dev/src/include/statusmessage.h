@@ -31,6 +31,11 @@
 #ifndef STATUSMESSAGE_H
 #define STATUSMESSAGE_H
 
+#include <map>
+#include <string>
+
+#include <scxcorelib/scxthread.h>
+#include <scxcorelib/scxthreadlock.h>
 #include <scxcorelib/stringaid.h>
 
 #include <util/XElement.h>
@@ -61,7 +66,9 @@ namespace VMM
                 StatusMessage()
                   : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
                                     "scx.vmmguestagent.statusmanager.statusmessage"))
+                  , m_lock(SCXCoreLib::ThreadLockHandleGet())
                   , mp_xelementRoot(NULL)
+                  , m_journalFd(-1)
                     
                 {
                     SetUp();
@@ -73,8 +80,7 @@ namespace VMM
                    Virtual Destructor for StatusMessage
 
                 */
-                virtual ~StatusMessage() 
-                {}
+                virtual ~StatusMessage();
 
                 /*----------------------------------------------------------------------------*/
                 /**
@@ -98,6 +104,70 @@ namespace VMM
                 */
                 bool ReadChildOfRoot(const std::string& elementName, 
                                      std::string&       elementValue);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Fold the journal into the status file and write out the phase
+                   timeline.  Call before the agent shuts the system down or reboots it.
+                   If the status file cannot be written the journal is kept, with the
+                   pending records committed to it.
+
+                   \return     None
+
+                */
+                void Compact();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Start a commit group of the calling thread.  Elements the thread
+                   adds while its group is open are made durable together, with a
+                   single journal write and sync, when its outermost group ends.
+                   The groups of other threads are committed on their own.
+
+                   \return     None
+
+                */
+                void BeginCommitGroup();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   End a commit group started with BeginCommitGroup()
+
+                   \return     bool           True if the pending elements were committed
+
+                */
+                bool EndCommitGroup();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Record that a specialization step has completed.  The record is made
+                   durable before returning, also inside a commit group, so that a
+                   restart does not repeat the step.
+
+                   \param   step           Name of the step
+                   
+                   \param   inputDigest    Digest of the inputs the step was applied with
+
+                   \return  bool           True if the record was made durable
+
+                */
+                bool AddCheckpoint(const std::string& step,
+                                   const std::string& inputDigest);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Has a step completed with the given inputs?  The latest checkpoint of
+                   the step counts.
+
+                   \param   step           Name of the step
+                   
+                   \param   inputDigest    Digest of the inputs the step would be applied with
+
+                   \return  bool           True if the step can be skipped
+
+                */
+                bool IsCheckpointed(const std::string& step,
+                                    const std::string& inputDigest);
                 
             private:
                 
@@ -107,15 +177,45 @@ namespace VMM
                 /** Log Handle */
                 SCXCoreLib::SCXLogHandle                  m_logHandle;
 
-                /** Pointer to the Root Element */
+                /** Lock for the status document */
+                SCXCoreLib::SCXThreadLockHandle           m_lock;
+
+                /** Pointer to the Root Element, resident for the life of the agent */
                 SCX::Util::Xml::XElementPtr  mp_xelementRoot;
 
-                /** XML String */
-                SCX::Util::Utf8String                   m_xmlString;
+                /** First child of the root for each element name */
+                std::map<std::string, SCX::Util::Xml::XElementPtr> m_index;
+
+                /** Input digest of the latest checkpoint of each step */
+                std::map<std::string, std::string>        m_checkpoints;
+
+                /** Status Directory */
+                std::string                               m_statusDir;
 
                 /** Status File */
                 std::string                               m_statusFile;
 
+                /** Journal of elements added since the status file was last written */
+                std::string                               m_journalFile;
+
+                /** Descriptor of the journal, opened on first append */
+                int                                       m_journalFd;
+
+                /** Commit group of a thread */
+                struct CommitGroup
+                {
+                    CommitGroup() : m_depth(0) {}
+
+                    /** Number of nested groups open */
+                    unsigned int                          m_depth;
+
+                    /** Journal records of the group not committed yet */
+                    std::string                           m_pendingJournal;
+                };
+
+                /** Open commit groups, by the thread that opened them */
+                std::map<SCXCoreLib::SCXThreadId, CommitGroup> m_commitGroups;
+
                 /*----------------------------------------------------------------------------*/
                 /**
                    Helper function to set up directories where status will be persisted
@@ -145,15 +245,119 @@ namespace VMM
 
                 /*----------------------------------------------------------------------------*/
                 /**
-                   Helper function to persist xml object in memory to file
+                   Load the status file, then replay the journal on top of it
+
+                   \return     None
+
+                */    
+                void Load();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Add an element to the in-memory document and the index
+
+                   \return     None
+
+                */    
+                void AddToDocument(const SCX::Util::Xml::XElementPtr& element);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Add an element of the document to the index and the checkpoints
 
                    \return     None
 
                 */    
-                void Write();
+                void IndexElement(const SCX::Util::Xml::XElementPtr& element);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Format an element as a journal record
+
+                   \param   journal        Record is appended to this string
+
+                   \return     None
+
+                */    
+                void AppendRecord(std::string& journal, const SCX::Util::Xml::XElementPtr& element);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Write pending records to the journal and sync it
+
+                   \param   journal        Records to write; cleared
+
+                   \return     bool           True if the records were made durable
+
+                */    
+                bool CommitJournal(std::string& journal);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Write all of data to a descriptor
+
+                   \return     bool           True if everything was written
+
+                */    
+                static bool WriteAll(int fd, const std::string& data);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Sync the status directory so that created and renamed files persist
+
+                   \return     None
+
+                */    
+                void SyncStatusDir();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Replay the journal into the in-memory document
+
+                   \return     size_t         Number of elements replayed
+
+                */    
+                size_t ReplayJournal();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Helper function to persist xml object in memory to file
+
+                   \return     bool           True if the status file was replaced
+
+                */    
+                bool Write();
                 
             }; // End of OSConfigurationStatus class
 
+            /*----------------------------------------------------------------------------*/
+            /**
+               Keeps a status commit group open for the lifetime of the object
+
+            */
+            class StatusCommitGroup
+            {
+
+            public:
+
+                StatusCommitGroup()
+                {
+                    StatusMessage::Instance().BeginCommitGroup();
+                }
+
+                ~StatusCommitGroup()
+                {
+                    StatusMessage::Instance().EndCommitGroup();
+                }
+
+            private:
+
+                /** Intentionally not implemented */
+                StatusCommitGroup(const StatusCommitGroup&);
+                StatusCommitGroup& operator=(const StatusCommitGroup&);
+
+            }; // End of StatusCommitGroup class
+
         } // End of StatusManager namespace
 
     } // End of GuestAgent namespace
@@ -47,6 +47,9 @@ namespace VMM
                 static const char* SpecializationFailed;
                 static const char* InsmodStatus;
                 static const char* InsmodCommandComplete;
+                static const char* ConfiguratorTiming;
+                static const char* Checkpoint;
+                static const char* RunOnceCommandResult;
             };
 
         } // End of StatusManager namespace
@@ -0,0 +1,90 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        logdecode.cpp
+
+   \brief       Renders a log written by the binary log backend, or the ring of
+                the flight recorder backend, in the text format of the file
+                backend.
+
+   \date        10-18-2026 22:10:00
+
+*/
+/*----------------------------------------------------------------------------*/
+#include <scxcorelib/scxcmn.h>
+
+#include <logpolicy.h>
+
+#include <scxlogbinarybackend.h>
+#include <scxlogflightrecorderbackend.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+namespace
+{
+
+char const USAGE[] = "logdecode [<binary log or flight recorder file>]";
+
+}
+
+int
+main(
+    int const argc,
+    char const* const* argv)
+{
+    if (argc > 2 || (argc == 2 && 0 == strcmp("-h", argv[1])))
+    {
+        std::cerr << USAGE << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream file;
+    if (argc == 2)
+    {
+        file.open(argv[1], std::ios::in | std::ios::binary);
+        if (!file)
+        {
+            std::cerr << "Unable to open " << argv[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // A flight recorder file starts with its magic; a binary log with text
+    std::istream& source = argc == 2 ? file : std::cin;
+    const std::string content((std::istreambuf_iterator<char>(source)), std::istreambuf_iterator<char>());
+    std::istringstream in(content);
+    const std::string ringMagic(SCXCoreLib::SCXLogFlightRecorderBackend::c_Magic,
+                                sizeof(SCXCoreLib::SCXLogFlightRecorderBackend::c_Magic));
+    bool decoded = 0 == content.compare(0, ringMagic.size(), ringMagic)
+        ? SCXCoreLib::SCXLogFlightRecorderBackend::Decode(in, std::cout)
+        : SCXCoreLib::SCXLogBinaryBackend::Decode(in, std::cout);
+    if (!decoded)
+    {
+        std::cout.flush();
+        std::cerr << "Not a binary log or flight recorder file, or the file is damaged" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,230 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        initializesystem.cpp
+
+   \brief       Runs the specialization: finds and reads the specialization file,
+                then creates and executes the configurators
+
+   \date        10-18-2026 17:02:40
+
+*/
+/*----------------------------------------------------------------------------*/
+#include <scxcorelib/scxcmn.h>
+#include <scxcorelib/scxlog.h>
+#include <scxcorelib/scxlogpolicy.h>
+#include <scxcorelib/stringaid.h>
+
+#include <util/LogHandleCache.h>
+
+#include <initializesystem.h>
+#include <isofetcher.h>
+#include <isofetcherexception.h>
+#include <osspecializationreader.h>
+#include <osspecializationparserexception.h>
+#include <executevisitor.h>
+#include <isofetcher.h>
+#include <argumentmanager.h>
+#include <phasetimeline.h>
+#include <vmmbuildversion.h>
+
+#include <fcntl.h>
+
+#include <sstream>
+
+using SCX::Util::LogHandleCache;
+using SCX::Util::Utf8String;
+using VMM::GuestAgent::Fetcher::ISOFetcher;
+using VMM::GuestAgent::Fetcher::ISOFetcherException;
+using VMM::GuestAgent::SpecializationReader::OSSpecializationReader;
+using VMM::GuestAgent::SpecializationReader::OSSpecializationParserException;
+using VMM::GuestAgent::Fetcher::ISOFetcher;
+using VMM::GuestAgent::Utilities::ArgumentManager;
+using VMM::GuestAgent::Utilities::PhaseSpan;
+using VMM::GuestAgent::Utilities::PhaseTimeline;
+using VMM::GuestAgent::Utilities::PHASE_CATEGORY_AGENT;
+
+//
+// Support making us a daemon
+//
+
+namespace
+{
+
+int Process_Daemonize()
+{
+    int pid;
+
+    /* Fork for the first time */
+    pid = fork();
+    if (pid == -1)
+        return -1;
+
+    /* If parent, then exit; let child live on. */
+    if (pid > 0)
+        exit(0);
+
+    /* Become the session leader (return if this fails) */
+    if (setsid() == -1)
+        return -1;
+
+    /* Fork a second time */
+    pid = fork();
+    if (pid == -1)
+        return -1;
+
+    /* If parent (first child), then exit; let second child live on */
+    if (pid > 0)
+        exit(0);
+
+    /* Close all file descriptors inherited by this process */
+    close(0);
+    close(1);
+    close(2);
+
+    /* Tie stdin to /dev/null */
+    open("/dev/null", O_RDONLY);
+
+    /* Tie stdout to /dev/null */
+    open("/dev/null", O_RDWR);
+
+    /* Tie stderr to /dev/null */
+    open("/dev/null", O_RDWR);
+
+    return 0;
+}
+
+}
+
+void
+InitializeSystem(
+    int const& argc,
+    char const* const* argv,
+    bool daemonize)
+{
+
+    // Set the locale for the program
+    std::setlocale(LC_ALL, "en_US.UTF8");
+
+    // Create handle
+    SCXCoreLib::SCXLogHandle logHandle =
+        LogHandleCache::Instance().GetLogHandle("scx.vmmguestagent.main.main");
+
+    SCX_LOGINFO(logHandle, "Initializing VMM Guest Agent");
+
+    // Get Specialization file and execute actions
+    try
+    {
+        ArgumentManager& argMgr = ArgumentManager::Instance();
+        ISOFetcher& fetcher = ISOFetcher::Instance();
+        // parse commandline
+        argMgr.LoadArgs(argc, argv, logHandle);
+
+        std::ostringstream label;
+        label << "scvmmguestagent " << VMM_BUILDVERSION_MAJOR << '.' << VMM_BUILDVERSION_MINOR << '.'
+              << VMM_BUILDVERSION_PATCH << '-' << VMM_BUILDVERSION_BUILDNR;
+        PhaseTimeline::Instance().SetLabel(label.str());
+
+        scxulong daemonizeStart = PhaseTimeline::Now();
+        if (daemonize && Process_Daemonize() == -1)
+        {
+            SCX_LOGERROR(
+                logHandle,
+                "Error converting the agent process to a daemon.  errno=" +
+                    SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+            exit (1);
+        }
+        PhaseTimeline::Instance().Record("Daemonize", PHASE_CATEGORY_AGENT,
+                                         daemonizeStart, PhaseTimeline::Now());
+
+        if (!argMgr.GetConfigFilename().empty())
+        {
+            PhaseSpan span("ReadConfigFile", PHASE_CATEGORY_AGENT);
+            fetcher.ReadConfigFile(SCXCoreLib::StrFromMultibyte(
+                argMgr.GetConfigFilename()));
+        }
+        else
+        {
+            // obtain a cdrom mountpoint
+            PhaseSpan span("DeviceDiscovery", PHASE_CATEGORY_AGENT);
+            fetcher.ObtainMountPoint();
+        }
+
+        bool applied = false;
+        if (fetcher.FoundSpecializationFile())
+        {
+            PhaseSpan span("CompareDigest", PHASE_CATEGORY_AGENT);
+            applied = fetcher.IsSpecializationApplied();
+        }
+
+        if (applied)
+        {
+            // The agent was installed again on a specialized machine; the agent
+            // version was settled when this file was applied
+            fetcher.LeaveAppliedSpecialization();
+        }
+        else if (fetcher.FoundSpecializationFile())
+        {
+            // Fetch specialization XML String
+            const Utf8String& osSpecializationString =
+                fetcher.GetOSConfigurationXMLString();
+            {
+                PhaseSpan span("LoadXML", PHASE_CATEGORY_AGENT);
+                OSSpecializationReader::Instance().LoadXML(osSpecializationString);
+            }
+
+            // upgrade if new agent is present
+            if (argMgr.GetConfigFilename().empty())
+            {
+                PhaseSpan span("InstallOrUpgradeAgent", PHASE_CATEGORY_AGENT);
+                fetcher.InstallOrUpgradeAgent();
+            }
+
+            // Get configuration values; the configurators read them in place
+            const OSSpecializationReader::LinuxOSSpecialization* spec =
+                OSSpecializationReader::Instance().GetLinuxOSSpecialization();
+            const OSSpecializationReader::OSConfiguration* osconf =
+                NULL != spec ? spec->GetOSConfiguration() : NULL;
+
+            // Create and execute all configurators
+            VMM::GuestAgent::OSConfigurator::CreateOSConfigurators(
+                NULL != osconf ? *osconf : OSSpecializationReader::OSConfiguration());
+
+            SCX_LOGINFO(logHandle, "Sucessfully initialized VMM Guest Agent!");
+        
+        }
+    }
+    catch (ISOFetcherException& e)
+    {
+        SCX_LOGERROR(
+            logHandle,
+            L"Error Initializing the VMM Guest Agent! Exception:" + e.What());
+    }
+    catch (OSSpecializationParserException& e)
+    {
+        SCX_LOGERROR(
+            logHandle,
+            "Error Initializing the VMM Guest Agent! Exception:" + e.What());
+    }
+
+    PhaseTimeline::Instance().Flush();
+}
+
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -64,12 +64,5 @@ namespace SCXCoreLib
                       << L"* Log format: <date> <severity>     [<code module>:<line number>:<process id>:<thread id>] <message>" << std::endl
                       << L"*" << std::endl;
         }
-
-        void WrtieItemToLog( SCXHandle<std::wfstream> &stream, const SCXLogItem& item, const std::wstring& message )
-        {
-            (void) item;
-
-            (*stream) << message << std::endl;
-        }
     }
 }
@@ -0,0 +1,164 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        configfiles.cpp
+
+   \brief       Helpers for configurators that edit system configuration files
+                in process instead of through the configuration scripts.
+
+   \date        10-18-2026 15:10:44
+
+*/
+/*----------------------------------------------------------------------------*/
+#include <configfiles.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+using VMM::GuestAgent::OSConfigurator::ConfigFiles;
+
+namespace
+{
+
+/** Mode of newly created configuration files */
+mode_t const DEFAULT_FILE_MODE = 0644;
+
+bool
+Exists(
+    const std::string& path)
+{
+    struct stat st;
+    return 0 == stat(path.c_str(), &st);
+}
+
+}
+
+ConfigFiles::Distro ConfigFiles::DetectDistro(const std::string& rootDir)
+{
+    struct utsname name;
+
+    if (Exists(rootDir + "/etc/debian_version") ||
+        (0 == uname(&name) && 0 != strstr(name.version, "Ubuntu")))
+    {
+        return eDebian;
+    }
+
+    if (!Exists(rootDir + "/etc/sysconfig/networking") &&
+        !Exists(rootDir + "/etc/sysconfig/network-scripts"))
+    {
+        return eSUSE;
+    }
+
+    return eRHEL;
+}
+
+bool ConfigFiles::ReadLines(const std::string& path, std::vector<std::string>& lines)
+{
+    lines.clear();
+
+    std::ifstream stream(path.c_str());
+    if (!stream.is_open())
+    {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(stream, line))
+    {
+        lines.push_back(line);
+    }
+
+    return !stream.bad();
+}
+
+bool ConfigFiles::WriteFile(const std::string& path, const std::string& contents)
+{
+    mode_t mode = DEFAULT_FILE_MODE;
+    struct stat st;
+    if (0 == stat(path.c_str(), &st))
+    {
+        mode = st.st_mode & 07777;
+    }
+
+    std::string tempPath = path + ".tmp";
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    bool written = true;
+    size_t done = 0;
+    while (written && done < contents.size())
+    {
+        ssize_t count = write(fd, contents.data() + done, contents.size() - done);
+        if (count < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        written = count > 0;
+        done += written ? static_cast<size_t>(count) : 0;
+    }
+
+    // open() applies the umask; make the mode match the original file
+    written = written && 0 == fchmod(fd, mode) && 0 == fsync(fd);
+    if (0 != close(fd))
+    {
+        written = false;
+    }
+
+    if (!written || 0 != rename(tempPath.c_str(), path.c_str()))
+    {
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool ConfigFiles::WriteLines(const std::string& path, const std::vector<std::string>& lines)
+{
+    std::string contents;
+    for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
+    {
+        contents += *iter;
+        contents += '\n';
+    }
+
+    return WriteFile(path, contents);
+}
+
+void ConfigFiles::SplitWords(const std::string& value, std::vector<std::string>& words)
+{
+    std::istringstream stream(value);
+    std::string word;
+    while (stream >> word)
+    {
+        words.push_back(word);
+    }
+}
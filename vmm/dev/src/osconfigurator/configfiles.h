@@ -0,0 +1,131 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        configfiles.h
+
+   \brief       Helpers for configurators that edit system configuration files
+                in process instead of through the configuration scripts.
+
+   \date        10-18-2026 15:10:44
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef CONFIGFILES_H
+#define CONFIGFILES_H
+
+#include <string>
+#include <vector>
+
+namespace VMM
+{
+
+    namespace GuestAgent
+    {
+
+        namespace OSConfigurator
+        {
+
+            class ConfigFiles
+            {
+
+            public:
+
+                /** Distribution families, as told apart by the configuration scripts */
+                enum Distro
+                {
+                    eDebian,
+                    eRHEL,
+                    eSUSE
+                };
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Tell the distribution family the same way GetDistroFamily in the
+                   scripts' utilities does
+
+                   \param      rootDir   Root directory of the system
+
+                   \return     Distribution family
+
+                */
+                static Distro DetectDistro(const std::string& rootDir);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Read a text file
+
+                   \param      path      File to read
+                   \param      lines     Receives the lines without their line ends
+
+                   \return     false if the file could not be read
+
+                */
+                static bool ReadLines(const std::string& path, std::vector<std::string>& lines);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Replace a file atomically: the contents go to a temporary file that is
+                   synced and renamed over the original, keeping its permissions
+
+                   \param      path      File to replace
+                   \param      contents  New contents
+
+                   \return     false if the file could not be replaced; it is unchanged then
+
+                */
+                static bool WriteFile(const std::string& path, const std::string& contents);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Replace a file atomically with the given lines
+
+                   \param      path      File to replace
+                   \param      lines     Lines to write, each terminated by a new line
+
+                   \return     false if the file could not be replaced
+
+                */
+                static bool WriteLines(const std::string& path, const std::vector<std::string>& lines);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Split on whitespace
+
+                   \param      value     Text to split
+                   \param      words     Receives the words, appended
+
+                */
+                static void SplitWords(const std::string& value, std::vector<std::string>& words);
+
+            private:
+
+                /** Intentionally not implemented */
+                ConfigFiles();
+
+            }; // End of ConfigFiles class
+
+        } // End of OSConfigurator namespace
+
+    } // End of GuestAgent namespace
+
+} // End of VMM namespace
+
+#endif /* CONFIGFILES_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -0,0 +1,61 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        configuratornames.h
+
+   \brief       Names of the configurators, used to declare dependencies between
+                them and to identify them in the status xml file
+                
+   \date        10-18-2026 13:05:12
+   
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef CONFIGURATORNAMES_H
+#define CONFIGURATORNAMES_H
+
+namespace VMM
+{
+
+    namespace GuestAgent
+    {
+
+        namespace OSConfigurator
+        {
+
+            class ConfiguratorNames
+            {
+            public:
+                static const char* Pre;
+                static const char* TimeZone;
+                static const char* HostDomain;
+                static const char* Users;
+                static const char* Network;
+                static const char* RunOnce;
+                static const char* Post;
+            };
+
+        } // End of OSConfigurator namespace
+
+    } // End of GuestAgent namespace
+
+} // End of VMM namespace
+
+#endif /* CONFIGURATORNAMES_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -0,0 +1,401 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        configuratorscheduler.cpp
+
+   \brief       Runs configurators on a thread pool as soon as the configurators
+                they depend on have completed.
+                
+   \date        10-18-2026 13:21:47
+   
+*/
+/*----------------------------------------------------------------------------*/
+#include <configuratorscheduler.h>
+
+#include <scxcorelib/scxassert.h>
+#include <scxcorelib/scxexception.h>
+#include <scxcorelib/scxfilesystem.h>
+#include <scxcorelib/scxthreadpool.h>
+#include <scxcorelib/scxtime.h>
+#include <scxcorelib/stringaid.h>
+
+#include <util/LogHandleCache.h>
+#include <util/XElement.h>
+
+#include <isofetcher.h>
+#include <isofetcherexception.h>
+#include <osspecializationparserexception.h>
+#include <phasetimeline.h>
+#include <statusmessage.h>
+#include <statusmessagestrings.h>
+#include <terminatesetupexception.h>
+
+#include <new>
+
+#include <stdlib.h>
+
+using VMM::GuestAgent::Fetcher::ISOFetcher;
+using VMM::GuestAgent::Fetcher::ISOFetcherException;
+using VMM::GuestAgent::OSConfigurator::ConfiguratorScheduler;
+using VMM::GuestAgent::OSConfigurator::TerminateSetupException;
+using VMM::GuestAgent::SpecializationReader::OSSpecializationParserException;
+using VMM::GuestAgent::StatusManager::StatusCommitGroup;
+using VMM::GuestAgent::StatusManager::StatusMessage;
+using VMM::GuestAgent::StatusManager::StatusMessageStrings;
+using VMM::GuestAgent::Utilities::PhaseSpan;
+using VMM::GuestAgent::Utilities::PHASE_CATEGORY_CONFIGURATOR;
+using SCX::Util::Xml::XElement;
+using SCX::Util::Xml::XElementPtr;
+
+const std::string AttributeNameConfigurator            = "Name";
+const std::string AttributeNameStart                   = "Start";
+const std::string AttributeNameFinish                  = "Finish";
+
+namespace
+{
+
+/*----------------------------------------------------------------------------*/
+/**
+   Thread parameter for a single configurator run
+
+*/
+class RunThreadParam : public SCXCoreLib::SCXThreadParam
+{
+public:
+    RunThreadParam(ConfiguratorScheduler* scheduler, size_t index)
+        : SCXCoreLib::SCXThreadParam()
+        , m_scheduler(scheduler)
+        , m_index(index)
+    {
+    }
+
+    ConfiguratorScheduler* m_scheduler;   //!< Scheduler the task belongs to
+    size_t                 m_index;       //!< Index of the configurator to run
+};
+
+std::string
+CurrentTime()
+{
+    return SCXCoreLib::StrToUTF8(SCXCoreLib::SCXCalendarTime::CurrentUTC().ToExtendedISO8601());
+}
+
+}
+
+ConfiguratorScheduler::ConfiguratorScheduler(VMM::GuestAgent::OSConfigurator::Visitor& visitor,
+                                             VMM::GuestAgent::OSConfigurator::InputDigestVisitor* digestVisitor)
+    : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
+                      "scx.vmmguestagent.osconfigurator.configuratorscheduler"))
+    , m_visitor(visitor)
+    , m_digestVisitor(digestVisitor)
+    , m_running(0)
+    , m_terminateSetup(false)
+{
+    m_cond.SetSleep(0);
+}
+
+ConfiguratorScheduler::~ConfiguratorScheduler()
+{
+}
+
+void ConfiguratorScheduler::Add(VMM::GuestAgent::OSConfigurator::OSConfigurator* configurator)
+{
+    Entry entry;
+    entry.m_configurator = configurator;
+    entry.m_name = configurator->GetName();
+    entry.m_state = eWaiting;
+
+    m_entries.push_back(entry);
+}
+
+void ConfiguratorScheduler::Run()
+{
+    ResolveDependencies();
+    ComputeDigests();
+
+    m_running = 0;
+    m_failure = NULL;
+    m_terminateSetup = false;
+
+    if (m_entries.empty())
+    {
+        return;
+    }
+
+    // Keep the commands the configurators run out of the shell history.  Set
+    // once before the threads start, so none of them changes the environment
+    // while another one forks a command
+    if (setenv("HISTIGNORE", "*", 1) != 0)
+    {
+        SCX_LOGERROR(m_logHandle, "failed to set HISTIGNORE");
+    }
+
+    {
+        SCXCoreLib::SCXThreadPool pool;
+        pool.SetThreadLimit(static_cast<long>(m_entries.size()));
+        pool.Start();
+
+        SCXCoreLib::SCXConditionHandle h(m_cond);
+        for (;;)
+        {
+            // Start everything whose dependencies are done; after a failure
+            // or the end of the setup only wait for the configurators already
+            // running
+            if (NULL == m_failure && !m_terminateSetup)
+            {
+                for (size_t i = 0; i < m_entries.size(); ++i)
+                {
+                    if (eWaiting == m_entries[i].m_state && IsReady(m_entries[i]))
+                    {
+                        SCX_LOGINFO(m_logHandle, "Starting " + m_entries[i].m_name);
+
+                        m_entries[i].m_state = eRunning;
+                        ++m_running;
+
+                        SCXCoreLib::SCXThreadParamHandle param(new RunThreadParam(this, i));
+                        pool.QueueTask(SCXCoreLib::SCXThreadPoolTaskHandle(
+                                           new SCXCoreLib::SCXThreadPoolTask(RunThreadBody, param)));
+                    }
+                }
+            }
+
+            if (0 == m_running)
+            {
+                break;
+            }
+
+            h.Wait();
+        }
+        h.Unlock();
+
+        pool.Shutdown();
+    }
+
+    // Terminating may exit the process or shut the system down; that is done
+    // from this thread, with no configurator running
+    if (m_terminateSetup)
+    {
+        ISOFetcher::Instance().TerminateSetup();
+    }
+
+    if (NULL != m_failure)
+    {
+        m_failure->Rethrow();
+    }
+
+    if (m_terminateSetup)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < m_entries.size(); ++i)
+    {
+        if (eCompleted != m_entries[i].m_state)
+        {
+            throw SCXCoreLib::SCXInternalErrorException(
+                L"Circular configurator dependency: " +
+                SCXCoreLib::StrFromMultibyte(m_entries[i].m_name), SCXSRCLOCATION);
+        }
+    }
+}
+
+void ConfiguratorScheduler::ResolveDependencies()
+{
+    for (size_t i = 0; i < m_entries.size(); ++i)
+    {
+        std::vector<std::string> names;
+        m_entries[i].m_configurator->GetDependencies(names);
+
+        m_entries[i].m_dependencies.clear();
+        m_entries[i].m_state = eWaiting;
+
+        for (std::vector<std::string>::const_iterator iter = names.begin();
+             iter != names.end();
+             ++iter)
+        {
+            size_t j = 0;
+            while (j < m_entries.size() && m_entries[j].m_name != *iter)
+            {
+                ++j;
+            }
+
+            if (j == m_entries.size())
+            {
+                throw SCXCoreLib::SCXInternalErrorException(
+                    SCXCoreLib::StrFromMultibyte(m_entries[i].m_name + " depends on unknown " + *iter),
+                    SCXSRCLOCATION);
+            }
+
+            m_entries[i].m_dependencies.push_back(j);
+        }
+    }
+}
+
+void ConfiguratorScheduler::ComputeDigests()
+{
+    for (size_t i = 0; i < m_entries.size(); ++i)
+    {
+        m_entries[i].m_digest.clear();
+        if (NULL != m_digestVisitor)
+        {
+            m_entries[i].m_configurator->Accept(*m_digestVisitor);
+            m_entries[i].m_digest = m_digestVisitor->GetDigest();
+        }
+    }
+}
+
+bool ConfiguratorScheduler::IsReady(const Entry& entry) const
+{
+    for (std::vector<size_t>::const_iterator iter = entry.m_dependencies.begin();
+         iter != entry.m_dependencies.end();
+         ++iter)
+    {
+        if (eCompleted != m_entries[*iter].m_state)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ConfiguratorScheduler::RunThreadBody(SCXCoreLib::SCXThreadParamHandle& param)
+{
+    RunThreadParam* p = static_cast<RunThreadParam*>(param.GetData());
+    SCXASSERT(p != 0);
+
+    p->m_scheduler->Execute(p->m_index);
+}
+
+void ConfiguratorScheduler::Execute(size_t index)
+{
+    Entry& entry = m_entries[index];
+    SCXCoreLib::SCXHandle<Failure> failure;
+    std::wstring description;
+    bool terminateSetup = false;
+
+    if (!entry.m_digest.empty() &&
+        StatusMessage::Instance().IsCheckpointed(entry.m_name, entry.m_digest))
+    {
+        SCX_LOGINFO(m_logHandle, entry.m_name + " already completed with the same inputs; skipping");
+    }
+    else
+    {
+        // Status updates of one configurator are committed together
+        StatusCommitGroup statusCommit;
+
+        std::string start = CurrentTime();
+        PhaseSpan span(entry.m_name, PHASE_CATEGORY_CONFIGURATOR);
+
+        // The exception is kept to be rethrown from Run(); the types callers
+        // tell apart are kept as they are, others as an internal error
+        try
+        {
+            entry.m_configurator->Accept(m_visitor);
+        }
+        catch (const TerminateSetupException& e)
+        {
+            terminateSetup = true;
+            description = e.What();
+        }
+        catch (const ISOFetcherException& e)
+        {
+            failure = new FailureOf<ISOFetcherException>(e);
+            description = e.What();
+        }
+        catch (const OSSpecializationParserException& e)
+        {
+            failure = new FailureOf<OSSpecializationParserException>(e);
+            description = SCXCoreLib::StrFromMultibyte(e.What());
+        }
+        catch (const SCXCoreLib::SCXInternalErrorException& e)
+        {
+            failure = new FailureOf<SCXCoreLib::SCXInternalErrorException>(e);
+            description = e.What();
+        }
+        catch (const SCXCoreLib::SCXFilePathNotFoundException& e)
+        {
+            failure = new FailureOf<SCXCoreLib::SCXFilePathNotFoundException>(e);
+            description = e.What();
+        }
+        catch (const SCXCoreLib::SCXUnauthorizedFileSystemAccessException& e)
+        {
+            failure = new FailureOf<SCXCoreLib::SCXUnauthorizedFileSystemAccessException>(e);
+            description = e.What();
+        }
+        catch (const SCXCoreLib::SCXException& e)
+        {
+            description = e.What();
+            failure = new FailureOf<SCXCoreLib::SCXInternalErrorException>(
+                SCXCoreLib::SCXInternalErrorException(
+                    SCXCoreLib::StrFromMultibyte(entry.m_name) + L" failed: " + description, SCXSRCLOCATION));
+        }
+        catch (const std::bad_alloc& e)
+        {
+            failure = new FailureOf<std::bad_alloc>(e);
+            description = SCXCoreLib::StrFromMultibyte(e.what());
+        }
+        catch (const std::exception& e)
+        {
+            description = SCXCoreLib::StrFromMultibyte(e.what());
+            failure = new FailureOf<SCXCoreLib::SCXInternalErrorException>(
+                SCXCoreLib::SCXInternalErrorException(
+                    SCXCoreLib::StrFromMultibyte(entry.m_name) + L" failed: " + description, SCXSRCLOCATION));
+        }
+
+        XElementPtr timing(new XElement(StatusMessageStrings::ConfiguratorTiming));
+        timing->SetAttributeValue(AttributeNameConfigurator, entry.m_name);
+        timing->SetAttributeValue(AttributeNameStart, start);
+        timing->SetAttributeValue(AttributeNameFinish, CurrentTime());
+        StatusMessage::Instance().AddChildToRoot(timing);
+
+        if (NULL == failure && !terminateSetup && !entry.m_digest.empty())
+        {
+            StatusMessage::Instance().AddCheckpoint(entry.m_name, entry.m_digest);
+        }
+    }
+
+    if (NULL != failure)
+    {
+        SCX_LOGERROR(m_logHandle, SCXCoreLib::StrFromMultibyte(entry.m_name) + L" failed: " + description);
+    }
+    else if (terminateSetup)
+    {
+        SCX_LOGINFO(m_logHandle, SCXCoreLib::StrFromMultibyte(entry.m_name) + L" ends the setup: " + description);
+    }
+    else
+    {
+        SCX_LOGINFO(m_logHandle, "Completed " + entry.m_name);
+    }
+
+    SCXCoreLib::SCXConditionHandle h(m_cond);
+
+    entry.m_state = eCompleted;
+    if (NULL != failure && NULL == m_failure)
+    {
+        m_failure = failure;
+    }
+    if (terminateSetup)
+    {
+        m_terminateSetup = true;
+    }
+
+    --m_running;
+    h.Signal();
+}
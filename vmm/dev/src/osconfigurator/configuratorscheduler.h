@@ -0,0 +1,225 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        configuratorscheduler.h
+
+   \brief       Runs configurators on a thread pool as soon as the configurators
+                they depend on have completed.
+                
+   \date        10-18-2026 13:21:47
+   
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef CONFIGURATORSCHEDULER_H
+#define CONFIGURATORSCHEDULER_H
+
+#include <string>
+#include <vector>
+
+#include <scxcorelib/scxcondition.h>
+#include <scxcorelib/scxhandle.h>
+#include <scxcorelib/scxlog.h>
+#include <scxcorelib/scxthread.h>
+
+#include <inputdigestvisitor.h>
+#include <osconfigurator.h>
+#include <osconfiguratorvisitor.h>
+
+namespace VMM
+{
+
+    namespace GuestAgent
+    {
+
+        namespace OSConfigurator
+        {
+
+            class ConfiguratorScheduler
+            {
+
+            public:
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   
+                   Constructor for ConfiguratorScheduler
+
+                   \param  visitor          Visitor every configurator accepts; shared by all threads
+
+                   \param  digestVisitor    Digests the inputs of the configurators; configurators
+                                            that completed before with the same inputs are skipped.
+                                            NULL runs every configurator.
+
+                */
+                ConfiguratorScheduler(VMM::GuestAgent::OSConfigurator::Visitor& visitor,
+                                      VMM::GuestAgent::OSConfigurator::InputDigestVisitor* digestVisitor = NULL);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   
+                   Destructor for ConfiguratorScheduler
+
+                */
+                ~ConfiguratorScheduler();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Add a configurator to be run.  The scheduler does not take ownership.
+
+                   \param  configurator    Configurator to run
+
+                */
+                void Add(VMM::GuestAgent::OSConfigurator::OSConfigurator* configurator);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Run all configurators, each one once its dependencies have completed,
+                   and record their start and finish times in the status xml file.  Each
+                   configurator that completes is checkpointed with its input digest.
+                   Once a configurator fails or ends the setup no more are started.
+                   When the running ones are done, the setup is terminated if a
+                   configurator asked for it, and then the first failure is rethrown.
+
+                   \throws     The exception the first failing configurator threw
+                   \throws     SCXInternalErrorException if the dependencies cannot be
+                               satisfied
+
+                */
+                void Run();
+
+            private:
+
+                /** Intentionally not implemented */
+                ConfiguratorScheduler(const ConfiguratorScheduler&);
+                ConfiguratorScheduler& operator=(const ConfiguratorScheduler&);
+
+                /** Scheduling state of a configurator */
+                enum State
+                {
+                    eWaiting,
+                    eRunning,
+                    eCompleted
+                };
+
+                /** Exception of a failed configurator, kept until the threads are joined */
+                class Failure
+                {
+                public:
+                    virtual ~Failure() {}
+
+                    /** Throw the kept exception */
+                    virtual void Rethrow() const = 0;
+                };
+
+                /** Keeps an exception of type E */
+                template <class E>
+                class FailureOf : public Failure
+                {
+                public:
+                    explicit FailureOf(const E& exception) : m_exception(exception) {}
+
+                    void Rethrow() const
+                    {
+                        throw m_exception;
+                    }
+
+                private:
+                    E m_exception;
+                };
+
+                /** A configurator along with its resolved dependencies */
+                struct Entry
+                {
+                    VMM::GuestAgent::OSConfigurator::OSConfigurator* m_configurator;
+                    std::string                                       m_name;
+                    std::vector<size_t>                               m_dependencies;
+                    std::string                                       m_digest;
+                    State                                             m_state;
+                };
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Translate dependency names into entry indexes
+
+                */
+                void ResolveDependencies();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Digest the inputs of every configurator
+
+                */
+                void ComputeDigests();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Can the entry start, i.e. have all its dependencies completed?
+
+                */
+                bool IsReady(const Entry& entry) const;
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Thread pool task body running a single configurator
+
+                */
+                static void RunThreadBody(SCXCoreLib::SCXThreadParamHandle& param);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Run one configurator and record its timing
+
+                */
+                void Execute(size_t index);
+
+                /** Log Handle */
+                SCXCoreLib::SCXLogHandle                   m_logHandle;
+
+                /** Visitor the configurators accept */
+                VMM::GuestAgent::OSConfigurator::Visitor& m_visitor;
+
+                /** Digests the inputs of the configurators, may be NULL */
+                VMM::GuestAgent::OSConfigurator::InputDigestVisitor* m_digestVisitor;
+
+                /** Configurators in the order they were added */
+                std::vector<Entry>                         m_entries;
+
+                /** Protects the scheduling state and signals completions */
+                SCXCoreLib::SCXCondition                   m_cond;
+
+                /** Number of configurators currently running */
+                size_t                                     m_running;
+
+                /** Exception of the first configurator that failed, if any */
+                SCXCoreLib::SCXHandle<Failure>             m_failure;
+
+                /** Has a configurator asked to terminate the setup? */
+                bool                                       m_terminateSetup;
+
+            }; // End of ConfiguratorScheduler class
+
+        } // End of OSConfigurator namespace
+
+    } // End of GuestAgent namespace
+
+} // End of VMM namespace
+
+#endif /* CONFIGURATORSCHEDULER_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -29,7 +29,9 @@
    
 */
 /*----------------------------------------------------------------------------*/
+#include <configuratorscheduler.h>
 #include <executevisitor.h>
+#include <inputdigestvisitor.h>
 
 using VMM::GuestAgent::OSConfigurator::PreConfigurator;
 using VMM::GuestAgent::OSConfigurator::HostDomainConfigurator;
@@ -104,7 +106,12 @@ void ExecuteVisitor::Visit(RunOnceCommandConfigurator* runOnceConfigurator)
 {
     if (m_xmlConfigurator.RunOnceCommands.size())
     {
-        runOnceConfigurator->Execute(m_xmlConfigurator.RunOnceCommands);
+        unsigned int maxConcurrent = 0;
+        m_xmlConfigurator.GetMaxConcurrentCommands(maxConcurrent);
+
+        runOnceConfigurator->Execute(m_xmlConfigurator.RunOnceCommands,
+                                     m_xmlConfigurator.RunOnceCommandGroups,
+                                     maxConcurrent);
     }
     else
     {
@@ -121,7 +128,8 @@ void VMM::GuestAgent::OSConfigurator::CreateOSConfigurators(
 	const VMM::GuestAgent::SpecializationReader::OSSpecializationReader::OSConfiguration& 
 	xmlConfigurator)
 {
-	// Create the configurators. Order is important
+	// Create the configurators. Each one declares the configurators it has to
+	// run after; the scheduler runs the independent ones concurrently
 	VMM::GuestAgent::OSConfigurator::OSConfigurator *configurators[] = 
 		{
 			new VMM::GuestAgent::OSConfigurator::PreConfigurator(), 
@@ -135,10 +143,15 @@ void VMM::GuestAgent::OSConfigurator::CreateOSConfigurators(
 	
 	// Double dispatch actions
 	VMM::GuestAgent::OSConfigurator::ExecuteVisitor executeVisitor(xmlConfigurator);
+	// Configurators that completed with the same inputs before a restart are skipped
+	VMM::GuestAgent::OSConfigurator::InputDigestVisitor digestVisitor(xmlConfigurator);
+	VMM::GuestAgent::OSConfigurator::ConfiguratorScheduler scheduler(executeVisitor, &digestVisitor);
 	for (int i = 0; i < 7; i++)
 	{
-		configurators[i]->Accept(executeVisitor);
+		scheduler.Add(configurators[i]);
 	}
+
+	scheduler.Run();
 	
 	// Clean up
 	for (int i = 0; i < 7; i++)
@@ -20,8 +20,8 @@
 /**
    \file        hostdomainconfigurator.cpp
 
-   \brief       This class provides an abstraction layer to execute host/domain configuration
-                scripts based on 
+   \brief       This class provides an abstraction layer to configure the hostname and
+                DNS domain name based on the values provided in the XML file
                 
    \date        06-24-2012 20:46:03
 
@@ -31,22 +31,29 @@
 /*----------------------------------------------------------------------------*/
 #include <hostdomainconfigurator.h>
 
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include <string>
+#include <vector>
 
 #include <argumentmanager.h>
-#include <commandexecutor.h>
-#include <isofetcher.h>
+#include <configfiles.h>
 #include <statusmessage.h>
 #include <statusmessagestrings.h>
+#include <terminatesetupexception.h>
 
 #include <util/Unicode.h>
 #include <scxcorelib/stringaid.h>
 
+using VMM::GuestAgent::OSConfigurator::ConfigFiles;
 using VMM::GuestAgent::OSConfigurator::HostDomainConfigurator;
-using VMM::GuestAgent::Fetcher::ISOFetcher;
+using VMM::GuestAgent::OSConfigurator::TerminateSetupException;
 using VMM::GuestAgent::StatusManager::StatusMessage;
 using VMM::GuestAgent::Utilities::ArgumentManager;
 using SCX::Util::Xml::XElement;
@@ -61,84 +68,103 @@ void HostDomainConfigurator::Execute(Utf8String& hostName,
     
     SCX_LOGINFO(m_logHandle, ("Executing host-domain configuration"));
 
-    if (setenv("HISTIGNORE", "*", 1) != 0)
-    {
-        SCX_LOGERROR(m_logHandle, ("failed to set HISTIGNORE"));
-    }
-
-    std::wstring command;
-
+    const std::string rootDir = ArgumentManager::Instance().GetRootDir();
+    std::string name;
     if (hostName == "*")
     {
-        command = SCXCoreLib::StrFromMultibyte(ArgumentManager::Instance().GetVMMHome() + 
-                                               ("/bin/cfghostdomain hostname=") +
-                                               RandomHostName());
+        name = RandomHostName();
     }
     else
     {
-
         SCX_LOGINFO(m_logHandle, "It was not a * hostname");
-        std::wstring wHostName;
-        hostName.ToWideString(wHostName);
-        command = SCXCoreLib::StrFromMultibyte(ArgumentManager::Instance().GetVMMHome() +
-                                               ("/bin/cfghostdomain hostname=")) + 
-        wHostName;
-
+        name = hostName.Str();
     }
-    // Invoke script
-    if (domainName.Size())
+
+    bool succeeded = ValidHostName(name);
+    if (succeeded)
     {
+        RemoveHostsEntries(rootDir);
 
-        std::wstring wDomainName;
-        domainName.ToWideString(wDomainName);
-        command += SCXCoreLib::StrFromMultibyte(" dnsdomainname=") + 
-            wDomainName;
+        // Under SCVMM_ROOT only the configuration files change, not the running host
+        if (!rootDir.empty())
+        {
+            SCX_LOGINFO(m_logHandle, "Alternate root directory set, runtime hostname not changed");
+        }
+        else if (0 != sethostname(name.c_str(), name.size()))
+        {
+            SCX_LOGERROR(m_logHandle, std::string("Failed to set runtime hostname: ") + strerror(errno));
+            succeeded = false;
+        }
+    }
+    else
+    {
+        SCX_LOGERROR(m_logHandle, "Specified hostname is invalid, cannot proceed");
     }
 
-    // Execute the command - scx logger crashes on printing UTF-8
-    //SCX_LOGINFO(m_logHandle, SCXSTRING("Shell command:") + command);
-    
-    // Use execute script
-    VMM::GuestAgent::Utilities::CommandExecutor commandExec;
-    int ret = commandExec.Execute(command, 
-                                  m_componentName);
-
-    if (ret < 0)
+    if (!succeeded)
     {
         SCX_LOGINFO(m_logHandle, ("Failed to set host/domain. Fatal failure."));
         StatusMessage::Instance().AddChildToRoot(XElementPtr(new XElement(StatusMessageStrings::SpecializationStatus, 
                                                                           StatusMessageStrings::SpecializationFailed)));
-        ISOFetcher::Instance().TerminateSetup();
+        throw TerminateSetupException(L"Failed to set host/domain");
+    }
+
+    if (!WriteHostNameFiles(rootDir, name))
+    {
+        SCX_LOGERROR(m_logHandle, "Failed to write the hostname to the configuration files");
+    }
+
+    if (domainName.Size())
+    {
+        const std::string domain = domainName.Str();
+        if (ValidHostName(domain))
+        {
+            WriteDomainName(rootDir, domain);
+        }
+        else
+        {
+            SCX_LOGWARNING(m_logHandle, "Specified DNS domain name is invalid, resolv.conf not changed");
+        }
+    }
+
+    // Validate
+    if (rootDir.empty())
+    {
+        char currentName[HOST_NAME_MAX + 1] = { 0 };
+        if (0 != gethostname(currentName, HOST_NAME_MAX) || name != currentName)
+        {
+            SCX_LOGERROR(m_logHandle, "Current hostname " + std::string(currentName) +
+                         " does not match expected hostname " + name);
+        }
     }
-     
 
 }
 
 std::string HostDomainConfigurator::RandomHostName()
 {
-    srand(time(NULL));
-    char rndCh = 'a';
-    std::string hostname(8, ' ');
-
-    do
-    {
-        rndCh = rand()/(RAND_MAX/('z' - 'a')) + 'a';
-        hostname[0] = rndCh;
-    }
-    while (!LegitimateCharacter(rndCh));
-
-    for (int i=1; i<8; i++)
-    {
-        do
-        {
-            int rnd = rand()/(RAND_MAX/('z' - 'a' + 10));
-            rndCh = rnd < 26 ? rnd + 'a' : (rnd - 26) + '0';
-            hostname[i] = rndCh;
-        }
-        while (!LegitimateCharacter(rndCh));
-    }
-
-    return hostname;
+    srand(time(NULL));
+    char rndCh = 'a';
+    std::string hostname(8, ' ');
+
+    do
+    {
+        rndCh = rand()/(RAND_MAX/('z' - 'a')) + 'a';
+        hostname[0] = rndCh;
+    }
+    while (!LegitimateCharacter(rndCh));
+
+    for (int i=1; i<8; i++)
+    {
+        do
+        {
+            int rnd = rand()/(RAND_MAX/('z' - 'a' + 10));
+            rndCh = rnd < 26 ? rnd + 'a' : (rnd - 26) + '0';
+            hostname[i] = rndCh;
+        }
+        while (!LegitimateCharacter(rndCh));
+    }
+
+    return hostname;
 }
 
 bool HostDomainConfigurator::LegitimateCharacter(char val)
@@ -159,3 +185,155 @@ bool HostDomainConfigurator::LegitimateCharacter(char val)
             return true;
     }        
 }
+
+bool HostDomainConfigurator::ValidHostName(const std::string& hostName)
+{
+    if (hostName.empty() || hostName.size() > HOST_NAME_MAX)
+    {
+        return false;
+    }
+
+    // The name ends up in configuration files, one entry per line
+    for (std::string::const_iterator iter = hostName.begin(); iter != hostName.end(); ++iter)
+    {
+        unsigned char ch = static_cast<unsigned char>(*iter);
+        if (isspace(ch) || iscntrl(ch) || '/' == ch)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void HostDomainConfigurator::RemoveHostsEntries(const std::string& rootDir)
+{
+    SCX_LOGINFO(m_logHandle, "Removing old host entries from /etc/hosts");
+
+    // Under SCVMM_ROOT the old name is the one in the image, not the running host's
+    std::string current;
+    if (rootDir.empty())
+    {
+        char currentName[HOST_NAME_MAX + 1] = { 0 };
+        if (0 == gethostname(currentName, HOST_NAME_MAX))
+        {
+            current = currentName;
+        }
+    }
+    else
+    {
+        std::vector<std::string> nameLines;
+        if (ConfigFiles::ReadLines(rootDir + "/etc/hostname", nameLines) && !nameLines.empty())
+        {
+            current = nameLines.front();
+        }
+    }
+
+    if (current.empty())
+    {
+        return;
+    }
+
+    // Keep the loopback entries even if the host is still called localhost
+    if (0 == current.compare(0, strlen("localhost"), "localhost"))
+    {
+        return;
+    }
+
+    const std::string hostsFile = rootDir + "/etc/hosts";
+    std::vector<std::string> lines;
+    if (!ConfigFiles::ReadLines(hostsFile, lines))
+    {
+        return;
+    }
+
+    std::vector<std::string> hosts;
+    for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
+    {
+        std::vector<std::string> words;
+        ConfigFiles::SplitWords(*iter, words);
+        bool matches = false;
+        for (std::vector<std::string>::const_iterator word = words.begin(); word != words.end() && !matches; ++word)
+        {
+            // The host name itself or a fully qualified name starting with it
+            matches = *word == current || 0 == word->compare(0, current.size() + 1, current + ".");
+        }
+        if (!matches)
+        {
+            hosts.push_back(*iter);
+        }
+    }
+
+    if (hosts.size() != lines.size() && !ConfigFiles::WriteLines(hostsFile, hosts))
+    {
+        SCX_LOGWARNING(m_logHandle, "Failed to remove old hostnames from /etc/hosts");
+    }
+}
+
+bool HostDomainConfigurator::WriteHostNameFiles(const std::string& rootDir, const std::string& hostName)
+{
+    SCX_LOGINFO(m_logHandle, "Setting hostname to " + hostName);
+
+    switch (ConfigFiles::DetectDistro(rootDir))
+    {
+    case ConfigFiles::eDebian:
+        return ConfigFiles::WriteFile(rootDir + "/etc/hostname", hostName + "\n");
+    case ConfigFiles::eSUSE:
+        return ConfigFiles::WriteFile(rootDir + "/etc/HOSTNAME", hostName + "\n");
+    case ConfigFiles::eRHEL:
+        break;
+    }
+
+    const std::string networkFile = rootDir + "/etc/sysconfig/network";
+    std::vector<std::string> lines;
+    ConfigFiles::ReadLines(networkFile, lines);
+
+    std::vector<std::string> network;
+    for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
+    {
+        if (std::string::npos == iter->find("HOSTNAME="))
+        {
+            network.push_back(*iter);
+        }
+    }
+    network.push_back("HOSTNAME=" + hostName);
+
+    if (!ConfigFiles::WriteLines(networkFile, network))
+    {
+        return false;
+    }
+
+    const std::string hostnameFile = rootDir + "/etc/hostname";
+    if (0 == access(hostnameFile.c_str(), F_OK))
+    {
+        return ConfigFiles::WriteFile(hostnameFile, hostName + "\n");
+    }
+
+    return true;
+}
+
+void HostDomainConfigurator::WriteDomainName(const std::string& rootDir, const std::string& domainName)
+{
+    SCX_LOGINFO(m_logHandle, "Configuring search and domain entries in /etc/resolv.conf");
+
+    const std::string resolvFile = rootDir + "/etc/resolv.conf";
+    std::vector<std::string> lines;
+    ConfigFiles::ReadLines(resolvFile, lines);
+
+    std::vector<std::string> resolv;
+    for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
+    {
+        if (0 != iter->compare(0, strlen("search "), "search ") &&
+            0 != iter->compare(0, strlen("domain "), "domain "))
+        {
+            resolv.push_back(*iter);
+        }
+    }
+    resolv.push_back("search " + domainName);
+    resolv.push_back("domain " + domainName);
+
+    if (!ConfigFiles::WriteLines(resolvFile, resolv))
+    {
+        SCX_LOGWARNING(m_logHandle, "Failed to write search and domain entries to resolv.conf");
+    }
+}
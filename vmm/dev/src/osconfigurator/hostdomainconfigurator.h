@@ -20,8 +20,8 @@
 /**
    \file        hostdomainconfigurator.h
 
-   \brief       This class provides an abstraction layer to execute host/domain configuration
-                scripts based on 
+   \brief       This class provides an abstraction layer to configure the hostname and
+                DNS domain name based on the values provided in the XML file
                 
    \date        06-24-2012 19:46:03
 
@@ -36,6 +36,7 @@
 #include <util/LogHandleCache.h>
 #include <util/Unicode.h>
 
+#include <configuratornames.h>
 #include <osconfigurator.h>
 
 namespace VMM
@@ -62,6 +63,18 @@ namespace VMM
 
                 bool LegitimateCharacter(char val);
 
+                /** Check that the name can be used as a hostname and in configuration files */
+                bool ValidHostName(const std::string& hostName);
+
+                /** Remove the /etc/hosts entries of the current hostname */
+                void RemoveHostsEntries(const std::string& rootDir);
+
+                /** Write the hostname to the distribution's configuration files */
+                bool WriteHostNameFiles(const std::string& rootDir, const std::string& hostName);
+
+                /** Replace the search and domain entries in /etc/resolv.conf */
+                void WriteDomainName(const std::string& rootDir, const std::string& domainName);
+
             public:
 
                 /*----------------------------------------------------------------------------*/
@@ -73,7 +86,7 @@ namespace VMM
                 HostDomainConfigurator()
                   : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
                                 "scx.vmmguestagent.osconfigurator.hostdomainconfigurator"))
-                  , m_componentName("HostDomain-Configurator")
+                  , m_componentName(ConfiguratorNames::HostDomain)
                 {}
 
                 /*----------------------------------------------------------------------------*/
@@ -98,7 +111,30 @@ namespace VMM
 
                 /*----------------------------------------------------------------------------*/
                 /**
-                   Function that invokes the host/domain configuration script
+                   Name of the configurator
+
+                   \return     Configurator name
+                */
+                inline std::string GetName() const
+                {
+                    return m_componentName;
+                }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Configurators that have to complete before this one runs
+
+                   \param  dependencies    Receives the configurator names
+                */
+                inline void GetDependencies(std::vector<std::string>& dependencies) const
+                {
+                    dependencies.push_back(ConfiguratorNames::Pre);
+                }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Function that sets the hostname and DNS domain name; with an
+                   alternate root directory only its configuration files change
 
                    \param      hostName      Hostname of the VM
                    
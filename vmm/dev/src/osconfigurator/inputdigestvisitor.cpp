@@ -0,0 +1,201 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        inputdigestvisitor.cpp
+
+   \brief       Digests the inputs each configurator is applied with, so that a
+                restarted specialization can tell the configurators that already
+                completed with the same inputs.
+                
+   \date        10-18-2026 18:52:10
+   
+*/
+/*----------------------------------------------------------------------------*/
+#include <inputdigestvisitor.h>
+
+#include <inputdigest.h>
+
+using VMM::GuestAgent::OSConfigurator::InputDigestVisitor;
+using VMM::GuestAgent::OSConfigurator::PreConfigurator;
+using VMM::GuestAgent::OSConfigurator::HostDomainConfigurator;
+using VMM::GuestAgent::OSConfigurator::TimeZoneConfigurator;
+using VMM::GuestAgent::OSConfigurator::NetworkConfigurator;
+using VMM::GuestAgent::OSConfigurator::UsersConfigurator;
+using VMM::GuestAgent::OSConfigurator::RunOnceCommandConfigurator;
+using VMM::GuestAgent::OSConfigurator::PostConfigurator;
+using VMM::GuestAgent::SpecializationReader::OSSpecializationReader;
+using VMM::GuestAgent::Utilities::InputDigest;
+using SCX::Util::Utf8String;
+
+namespace
+{
+
+/*----------------------------------------------------------------------------*/
+/**
+   Add an optional value; a missing value digests differently from an empty one
+
+*/
+void
+AddOptional(InputDigest& digest, bool found, const Utf8String& value)
+{
+    digest.Add(static_cast<scxulong>(found));
+    if (found)
+    {
+        digest.Add(value.Str());
+    }
+}
+
+void
+AddStrings(InputDigest& digest, const std::vector<Utf8String>& values)
+{
+    digest.Add(static_cast<scxulong>(values.size()));
+    for (std::vector<Utf8String>::const_iterator iter = values.begin(); iter != values.end(); ++iter)
+    {
+        digest.Add(iter->Str());
+    }
+}
+
+void
+AddNetworkProperties(InputDigest&                                          digest,
+                     bool                                                  found,
+                     const OSSpecializationReader::NetworkProperties&      properties)
+{
+    digest.Add(static_cast<scxulong>(found));
+    if (found)
+    {
+        Utf8String staticIP;
+        digest.Add(static_cast<scxulong>(properties.IsStatic()));
+        AddOptional(digest, properties.GetStaticIP(staticIP), staticIP);
+    }
+}
+
+}
+
+InputDigestVisitor::InputDigestVisitor(const OSSpecializationReader::OSConfiguration& configuration)
+    : m_configuration(configuration)
+{
+}
+
+void InputDigestVisitor::Visit(PreConfigurator*)
+{
+    m_digest.clear();
+}
+
+void InputDigestVisitor::Visit(HostDomainConfigurator*)
+{
+    InputDigest digest;
+    Utf8String value;
+
+    AddOptional(digest, m_configuration.GetHostName(value), value);
+    AddOptional(digest, m_configuration.GetDomainName(value), value);
+
+    m_digest = digest.Str();
+}
+
+void InputDigestVisitor::Visit(TimeZoneConfigurator*)
+{
+    InputDigest digest;
+    int timeZone = 0;
+
+    bool found = m_configuration.GetTimeZone(timeZone);
+    digest.Add(static_cast<scxulong>(found));
+    digest.Add(static_cast<scxulong>(static_cast<scxlong>(timeZone)));
+
+    m_digest = digest.Str();
+}
+
+void InputDigestVisitor::Visit(NetworkConfigurator*)
+{
+    InputDigest digest;
+
+    digest.Add(static_cast<scxulong>(m_configuration.VNetAdapters.size()));
+    for (std::vector<OSSpecializationReader::VNetAdapter>::const_iterator adapter = m_configuration.VNetAdapters.begin();
+         adapter != m_configuration.VNetAdapters.end();
+         ++adapter)
+    {
+        Utf8String value;
+        AddOptional(digest, adapter->GetMACAddress(value), value);
+
+        OSSpecializationReader::NetworkProperties properties;
+        AddNetworkProperties(digest, adapter->GetIPV4(properties), properties);
+        AddNetworkProperties(digest, adapter->GetIPV6(properties), properties);
+
+        digest.Add(static_cast<scxulong>(adapter->Gateways.size()));
+        for (std::vector<OSSpecializationReader::Gateway>::const_iterator gateway = adapter->Gateways.begin();
+             gateway != adapter->Gateways.end();
+             ++gateway)
+        {
+            AddOptional(digest, gateway->GetAddress(value), value);
+            AddOptional(digest, gateway->GetMetric(value), value);
+        }
+
+        AddStrings(digest, adapter->NameServers);
+        AddStrings(digest, adapter->DNSSearchSuffixes);
+    }
+
+    m_digest = digest.Str();
+}
+
+void InputDigestVisitor::Visit(UsersConfigurator*)
+{
+    InputDigest digest;
+    OSSpecializationReader::User user;
+
+    bool found = m_configuration.GetRoot(user);
+    digest.Add(static_cast<scxulong>(found));
+    if (found)
+    {
+        Utf8String value;
+        if (user.GetPassword(value))
+        {
+            m_digest.clear();
+            return;
+        }
+
+        AddOptional(digest, user.GetUserName(value), value);
+        AddOptional(digest, user.GetSSHKey(value), value);
+        AddOptional(digest, user.GetUID(value), value);
+        AddOptional(digest, user.GetGroupID(value), value);
+        AddOptional(digest, user.GetPrimaryGroup(value), value);
+    }
+
+    m_digest = digest.Str();
+}
+
+void InputDigestVisitor::Visit(RunOnceCommandConfigurator*)
+{
+    InputDigest digest;
+
+    digest.Add(static_cast<scxulong>(m_configuration.RunOnceCommands.size()));
+    for (std::map<int, Utf8String>::const_iterator iter = m_configuration.RunOnceCommands.begin();
+         iter != m_configuration.RunOnceCommands.end();
+         ++iter)
+    {
+        digest.Add(static_cast<scxulong>(static_cast<scxlong>(iter->first)));
+        digest.Add(iter->second.Str());
+    }
+
+    m_digest = digest.Str();
+}
+
+void InputDigestVisitor::Visit(PostConfigurator*)
+{
+    m_digest.clear();
+}
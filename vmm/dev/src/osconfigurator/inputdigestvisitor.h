@@ -0,0 +1,123 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        inputdigestvisitor.h
+
+   \brief       Digests the inputs each configurator is applied with, so that a
+                restarted specialization can tell the configurators that already
+                completed with the same inputs.
+                
+   \date        10-18-2026 18:52:10
+   
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef INPUTDIGESTVISITOR_H
+#define INPUTDIGESTVISITOR_H
+
+#include <string>
+
+#include <osspecializationreader.h>
+#include <osconfiguratorvisitor.h>
+
+namespace VMM
+{
+
+    namespace GuestAgent
+    {
+
+        namespace OSConfigurator
+        {
+
+            class InputDigestVisitor : public VMM::GuestAgent::OSConfigurator::Visitor
+            {
+
+            public:
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   
+                   Constructor for InputDigestVisitor
+
+                   \param  configuration    Specialization the configurators are applied with
+
+                */
+                explicit InputDigestVisitor(const VMM::GuestAgent::SpecializationReader::OSSpecializationReader::OSConfiguration& configuration);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Digest of the inputs of the configurator visited last
+
+                   \return     The digest, empty if the configurator is not checkpointed
+
+                */
+                std::string GetDigest() const
+                {
+                    return m_digest;
+                }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Pre-configuration keeps its own status; it is not checkpointed
+
+                */
+                virtual void Visit(VMM::GuestAgent::OSConfigurator::PreConfigurator* preConfigurator);
+
+                virtual void Visit(VMM::GuestAgent::OSConfigurator::HostDomainConfigurator* hostDomainConfigurator);
+
+                virtual void Visit(VMM::GuestAgent::OSConfigurator::TimeZoneConfigurator* timeZoneConfigurator);
+
+                virtual void Visit(VMM::GuestAgent::OSConfigurator::NetworkConfigurator* networkConfigurator);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   A root user with a password is not checkpointed: the digest is kept
+                   in the status file, and one that changes with the password would
+                   let the password be guessed from it
+
+                */
+                virtual void Visit(VMM::GuestAgent::OSConfigurator::UsersConfigurator* usersConfigurator);
+
+                virtual void Visit(VMM::GuestAgent::OSConfigurator::RunOnceCommandConfigurator* runOnceConfigurator);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Post-configuration completes the specialization; it always runs
+
+                */
+                virtual void Visit(VMM::GuestAgent::OSConfigurator::PostConfigurator* postConfigurator);
+
+            private:
+
+                /** Specialization the configurators are applied with */
+                const VMM::GuestAgent::SpecializationReader::OSSpecializationReader::OSConfiguration& m_configuration;
+
+                /** Digest of the configurator visited last */
+                std::string m_digest;
+
+            }; // End of InputDigestVisitor class
+
+        } // End of OSConfigurator namespace
+
+    } // End of GuestAgent namespace
+
+} // End of VMM namespace
+
+#endif /* INPUTDIGESTVISITOR_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -0,0 +1,1067 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        netlinkadapterconfigurator.cpp
+
+   \brief       Configures a network adapter with static addresses in process:
+                addresses and default routes are applied over rtnetlink and the
+                distribution's network configuration files are written directly.
+
+   \date        10-18-2026 14:05:12
+
+*/
+/*----------------------------------------------------------------------------*/
+#include <configfiles.h>
+#include <netlinkadapterconfigurator.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include <scxcorelib/stringaid.h>
+#include <util/LogHandleCache.h>
+
+using VMM::GuestAgent::OSConfigurator::ConfigFiles;
+using VMM::GuestAgent::OSConfigurator::NetlinkAdapterConfigurator;
+using VMM::GuestAgent::SpecializationReader::OSSpecializationReader;
+using SCX::Util::Utf8String;
+
+namespace
+{
+
+/** Large enough for any rtnetlink reply datagram */
+size_t const NETLINK_BUFFER_SIZE = 32768;
+
+/** The network script keeps at most this many name servers of its own */
+size_t const MAX_VMM_NAMESERVERS = 3;
+
+/** Marks resolv.conf entries written by the agent */
+char const VMM_TAG[] = "#vmm";
+
+inline bool
+StartsWith(
+    const std::string& value,
+    const std::string& prefix)
+{
+    return 0 == value.compare(0, prefix.size(), prefix);
+}
+
+inline bool
+EndsWith(
+    const std::string& value,
+    const std::string& suffix)
+{
+    return value.size() >= suffix.size() &&
+           0 == value.compare(value.size() - suffix.size(), suffix.size(), suffix);
+}
+
+inline bool
+Contains(
+    const std::string& value,
+    const std::string& part)
+{
+    return std::string::npos != value.find(part);
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+   Remove the files in a directory whose name starts with prefix and contains part
+
+*/
+void
+RemoveMatchingFiles(
+    const std::string& directory,
+    const std::string& prefix,
+    const std::string& part)
+{
+    DIR* dir = opendir(directory.c_str());
+    if (0 == dir)
+    {
+        return;
+    }
+
+    std::vector<std::string> names;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != 0)
+    {
+        std::string name(entry->d_name);
+        if (StartsWith(name, prefix) && Contains(name.substr(prefix.size()), part))
+        {
+            names.push_back(name);
+        }
+    }
+    closedir(dir);
+
+    for (std::vector<std::string>::const_iterator iter = names.begin(); iter != names.end(); ++iter)
+    {
+        unlink((directory + "/" + *iter).c_str());
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+   Parse a hardware address written as hex digit pairs separated by ':' or '-'
+
+*/
+bool
+ParseMACAddress(
+    const std::string& text,
+    std::vector<unsigned char>& bytes)
+{
+    bytes.clear();
+
+    std::string digits;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        char ch = text[i];
+        if (isxdigit(static_cast<unsigned char>(ch)))
+        {
+            digits += ch;
+        }
+        else if (ch != ':' && ch != '-' && !isspace(static_cast<unsigned char>(ch)))
+        {
+            return false;
+        }
+    }
+
+    if (digits.empty() || 0 != digits.size() % 2)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < digits.size(); i += 2)
+    {
+        bytes.push_back(static_cast<unsigned char>(strtoul(digits.substr(i, 2).c_str(), 0, 16)));
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+   Parse "address/prefixlength"; the prefix length is required
+
+*/
+bool
+ParseAddress(
+    const std::string& text,
+    int family,
+    unsigned char* bytes,
+    unsigned int& prefixLength,
+    std::string& address)
+{
+    std::string::size_type slash = text.find('/');
+    if (std::string::npos == slash)
+    {
+        return false;
+    }
+
+    address = text.substr(0, slash);
+    std::string prefix = text.substr(slash + 1);
+    char* end = 0;
+    unsigned long value = strtoul(prefix.c_str(), &end, 10);
+    unsigned long maxPrefix = AF_INET == family ? 32 : 128;
+    if (prefix.empty() || *end != '\0' || value > maxPrefix)
+    {
+        return false;
+    }
+
+    prefixLength = static_cast<unsigned int>(value);
+    return 1 == inet_pton(family, address.c_str(), bytes);
+}
+
+std::string
+PrefixToNetmask(
+    unsigned int prefixLength)
+{
+    unsigned int mask = 0 == prefixLength ? 0 : 0xffffffffu << (32 - prefixLength);
+
+    char text[INET_ADDRSTRLEN];
+    snprintf(text, sizeof(text), "%u.%u.%u.%u",
+             (mask >> 24) & 0xff, (mask >> 16) & 0xff, (mask >> 8) & 0xff, mask & 0xff);
+    return text;
+}
+
+std::string
+ToString(
+    unsigned int value)
+{
+    return SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(value));
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+   Start a netlink message with its family specific header
+
+*/
+void
+StartMessage(
+    std::vector<char>& message,
+    unsigned short type,
+    unsigned short flags,
+    const void* header,
+    size_t headerLength)
+{
+    message.assign(NLMSG_SPACE(headerLength), 0);
+
+    struct nlmsghdr* nlh = reinterpret_cast<struct nlmsghdr*>(&message[0]);
+    nlh->nlmsg_len = static_cast<__u32>(message.size());
+    nlh->nlmsg_type = type;
+    nlh->nlmsg_flags = static_cast<__u16>(NLM_F_REQUEST | flags);
+    memcpy(NLMSG_DATA(nlh), header, headerLength);
+}
+
+void
+AddAttribute(
+    std::vector<char>& message,
+    unsigned short type,
+    const void* data,
+    size_t length)
+{
+    size_t offset = NLMSG_ALIGN(message.size());
+    message.resize(offset + RTA_SPACE(length), 0);
+
+    struct rtattr* rta = reinterpret_cast<struct rtattr*>(&message[offset]);
+    rta->rta_type = type;
+    rta->rta_len = static_cast<unsigned short>(RTA_LENGTH(length));
+    memcpy(RTA_DATA(rta), data, length);
+
+    reinterpret_cast<struct nlmsghdr*>(&message[0])->nlmsg_len = static_cast<__u32>(message.size());
+}
+
+}
+
+NetlinkAdapterConfigurator::NetlinkAdapterConfigurator(const std::string& rootDir)
+    : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
+                      "scx.vmmguestagent.osconfigurator.netlinkadapterconfigurator"))
+    , m_rootDir(rootDir)
+    , m_socket(-1)
+    , m_sequence(0)
+{
+}
+
+NetlinkAdapterConfigurator::~NetlinkAdapterConfigurator()
+{
+    if (m_socket >= 0)
+    {
+        close(m_socket);
+    }
+}
+
+bool NetlinkAdapterConfigurator::Configure(const OSSpecializationReader::VNetAdapter& netAdapter,
+                                           std::string& device)
+{
+    device.clear();
+
+    Settings settings;
+    if (!ReadSettings(netAdapter, settings))
+    {
+        return false;
+    }
+
+    ConfigFiles::Distro distro;
+    if (!DetectDistro(distro))
+    {
+        SCX_LOGINFO(m_logHandle, "Distribution not handled natively, using network script");
+        return false;
+    }
+
+    int index = 0;
+    std::string name;
+    if (!OpenSocket() || !FindLink(settings.m_macAddress, index, name))
+    {
+        return false;
+    }
+
+    SCX_LOGINFO(m_logHandle, "Configuring network adapter " + name + " (" + settings.m_macText + ")");
+
+    // Live configuration first, so a failure leaves the files for the script
+    if (!SetLinkUp(index) ||
+        (settings.m_hasIPv4 && !ReplaceAddress(index, settings.m_ipv4)) ||
+        (settings.m_hasIPv6 && !ReplaceAddress(index, settings.m_ipv6)))
+    {
+        return false;
+    }
+
+    // Like the network script, use the first gateway of each configured family
+    bool ipv4Gateway = false;
+    bool ipv6Gateway = false;
+    for (std::vector<std::string>::const_iterator iter = settings.m_gateways.begin();
+         iter != settings.m_gateways.end();
+         ++iter)
+    {
+        bool isIPv6 = Contains(*iter, ":");
+        bool& done = isIPv6 ? ipv6Gateway : ipv4Gateway;
+        bool configured = isIPv6 ? settings.m_hasIPv6 : settings.m_hasIPv4;
+        if (done || !configured)
+        {
+            continue;
+        }
+
+        if (!SetDefaultRoute(index, *iter))
+        {
+            return false;
+        }
+        done = true;
+    }
+
+    bool written = false;
+    switch (distro)
+    {
+    case ConfigFiles::eRHEL:
+        written = WriteRHELConfig(name, settings);
+        break;
+    case ConfigFiles::eSUSE:
+        written = WriteSUSEConfig(name, settings);
+        break;
+    case ConfigFiles::eDebian:
+        written = WriteDebianConfig(name, settings);
+        break;
+    }
+
+    if (!written ||
+        !WriteHostsEntries(settings) ||
+        !WriteResolvConf(settings))
+    {
+        SCX_LOGWARNING(m_logHandle, "Unable to write network configuration files for " + name);
+        return false;
+    }
+
+    SCX_LOGINFO(m_logHandle, "Configured network adapter " + name);
+    device = name;
+    return true;
+}
+
+bool NetlinkAdapterConfigurator::ReadSettings(const OSSpecializationReader::VNetAdapter& netAdapter,
+                                              Settings& settings)
+{
+    Utf8String value;
+    if (!netAdapter.GetMACAddress(value) || !ParseMACAddress(value.Str(), settings.m_macAddress))
+    {
+        return false;
+    }
+    settings.m_macText = value.Str();
+
+    // DHCP, and static settings without an address, are left to the script
+    settings.m_hasIPv4 = false;
+    OSSpecializationReader::NetworkProperties ipv4;
+    if (netAdapter.GetIPV4(ipv4))
+    {
+        Utf8String address;
+        if (!ipv4.IsStatic() || !ipv4.GetStaticIP(address) ||
+            !ParseAddress(address.Str(), AF_INET, settings.m_ipv4.m_bytes,
+                          settings.m_ipv4.m_prefixLength, settings.m_ipv4.m_text))
+        {
+            return false;
+        }
+        settings.m_ipv4.m_family = AF_INET;
+        settings.m_hasIPv4 = true;
+    }
+
+    settings.m_hasIPv6 = false;
+    OSSpecializationReader::NetworkProperties ipv6;
+    if (netAdapter.GetIPV6(ipv6))
+    {
+        Utf8String address;
+        if (!ipv6.IsStatic() || !ipv6.GetStaticIP(address) ||
+            !ParseAddress(address.Str(), AF_INET6, settings.m_ipv6.m_bytes,
+                          settings.m_ipv6.m_prefixLength, settings.m_ipv6.m_text))
+        {
+            return false;
+        }
+        settings.m_ipv6.m_family = AF_INET6;
+        settings.m_hasIPv6 = true;
+    }
+
+    if (!settings.m_hasIPv4 && !settings.m_hasIPv6)
+    {
+        return false;
+    }
+
+    for (std::vector<OSSpecializationReader::Gateway>::const_iterator iter = netAdapter.Gateways.begin();
+         iter != netAdapter.Gateways.end();
+         ++iter)
+    {
+        Utf8String address;
+        if (iter->GetAddress(address) && !address.Str().empty())
+        {
+            settings.m_gateways.push_back(address.Str());
+        }
+    }
+
+    for (std::vector<Utf8String>::const_iterator iter = netAdapter.NameServers.begin();
+         iter != netAdapter.NameServers.end();
+         ++iter)
+    {
+        ConfigFiles::SplitWords(iter->Str(), settings.m_nameServers);
+    }
+
+    for (std::vector<Utf8String>::const_iterator iter = netAdapter.DNSSearchSuffixes.begin();
+         iter != netAdapter.DNSSearchSuffixes.end();
+         ++iter)
+    {
+        ConfigFiles::SplitWords(iter->Str(), settings.m_searchSuffixes);
+    }
+
+    return true;
+}
+
+bool NetlinkAdapterConfigurator::DetectDistro(ConfigFiles::Distro& distro) const
+{
+    distro = ConfigFiles::DetectDistro(m_rootDir);
+    if (ConfigFiles::eSUSE != distro)
+    {
+        return true;
+    }
+
+    // SLES 10 names its files after the hardware address; leave it to the script
+    std::vector<std::string> lines;
+    ConfigFiles::ReadLines(RootPath("/etc/SuSE-release"), lines);
+    for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
+    {
+        std::vector<std::string> words;
+        ConfigFiles::SplitWords(*iter, words);
+        if (words.size() >= 3 && "VERSION" == words[0] && "10" == words[2])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool NetlinkAdapterConfigurator::OpenSocket()
+{
+    if (m_socket >= 0)
+    {
+        return true;
+    }
+
+    m_socket = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+    if (m_socket < 0)
+    {
+        SCX_LOGWARNING(m_logHandle, "Unable to open rtnetlink socket errno: " + ToString(errno));
+        return false;
+    }
+
+    fcntl(m_socket, F_SETFD, FD_CLOEXEC);
+
+    struct sockaddr_nl address;
+    memset(&address, 0, sizeof(address));
+    address.nl_family = AF_NETLINK;
+
+    if (bind(m_socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        SCX_LOGWARNING(m_logHandle, "Unable to bind rtnetlink socket errno: " + ToString(errno));
+        close(m_socket);
+        m_socket = -1;
+        return false;
+    }
+
+    return true;
+}
+
+bool NetlinkAdapterConfigurator::Request(std::vector<char>& message)
+{
+    std::vector<std::vector<char> > replies;
+
+    struct nlmsghdr* nlh = reinterpret_cast<struct nlmsghdr*>(&message[0]);
+    nlh->nlmsg_flags |= NLM_F_ACK;
+
+    return Dump(message, replies);
+}
+
+bool NetlinkAdapterConfigurator::Dump(std::vector<char>& message,
+                                      std::vector<std::vector<char> >& replies)
+{
+    replies.clear();
+
+    struct nlmsghdr* request = reinterpret_cast<struct nlmsghdr*>(&message[0]);
+    request->nlmsg_seq = ++m_sequence;
+    bool isDump = NLM_F_DUMP == (request->nlmsg_flags & NLM_F_DUMP);
+
+    struct sockaddr_nl kernel;
+    memset(&kernel, 0, sizeof(kernel));
+    kernel.nl_family = AF_NETLINK;
+
+    ssize_t sent;
+    do
+    {
+        sent = sendto(m_socket, &message[0], message.size(), 0,
+                      reinterpret_cast<struct sockaddr*>(&kernel), sizeof(kernel));
+    } while (sent < 0 && EINTR == errno);
+
+    if (sent < 0)
+    {
+        SCX_LOGWARNING(m_logHandle, "rtnetlink send failed errno: " + ToString(errno));
+        return false;
+    }
+
+    std::vector<char> buffer(NETLINK_BUFFER_SIZE);
+    for (;;)
+    {
+        ssize_t length = recv(m_socket, &buffer[0], buffer.size(), 0);
+        if (length < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            SCX_LOGWARNING(m_logHandle, "rtnetlink receive failed errno: " + ToString(errno));
+            return false;
+        }
+
+        int remaining = static_cast<int>(length);
+        for (struct nlmsghdr* nlh = reinterpret_cast<struct nlmsghdr*>(&buffer[0]);
+             NLMSG_OK(nlh, remaining);
+             nlh = NLMSG_NEXT(nlh, remaining))
+        {
+            if (nlh->nlmsg_seq != m_sequence)
+            {
+                continue;
+            }
+
+            if (NLMSG_DONE == nlh->nlmsg_type)
+            {
+                return true;
+            }
+
+            if (NLMSG_ERROR == nlh->nlmsg_type)
+            {
+                const struct nlmsgerr* error = static_cast<const struct nlmsgerr*>(NLMSG_DATA(nlh));
+                if (0 == error->error)
+                {
+                    return true;
+                }
+
+                SCX_LOGWARNING(m_logHandle, "rtnetlink request " + ToString(request->nlmsg_type) +
+                               " failed errno: " + ToString(-error->error));
+                return false;
+            }
+
+            const char* start = reinterpret_cast<const char*>(nlh);
+            replies.push_back(std::vector<char>(start, start + nlh->nlmsg_len));
+
+            if (!isDump)
+            {
+                return true;
+            }
+        }
+    }
+}
+
+bool NetlinkAdapterConfigurator::FindLink(const std::vector<unsigned char>& macAddress,
+                                          int& index,
+                                          std::string& name)
+{
+    struct ifinfomsg header;
+    memset(&header, 0, sizeof(header));
+    header.ifi_family = AF_UNSPEC;
+
+    std::vector<char> message;
+    StartMessage(message, RTM_GETLINK, NLM_F_DUMP, &header, sizeof(header));
+
+    std::vector<std::vector<char> > replies;
+    if (!Dump(message, replies))
+    {
+        return false;
+    }
+
+    for (std::vector<std::vector<char> >::iterator reply = replies.begin(); reply != replies.end(); ++reply)
+    {
+        struct nlmsghdr* nlh = reinterpret_cast<struct nlmsghdr*>(&(*reply)[0]);
+        if (RTM_NEWLINK != nlh->nlmsg_type)
+        {
+            continue;
+        }
+
+        struct ifinfomsg* ifi = static_cast<struct ifinfomsg*>(NLMSG_DATA(nlh));
+        bool matches = false;
+        std::string linkName;
+
+        int length = static_cast<int>(IFLA_PAYLOAD(nlh));
+        for (struct rtattr* rta = IFLA_RTA(ifi); RTA_OK(rta, length); rta = RTA_NEXT(rta, length))
+        {
+            if (IFLA_ADDRESS == rta->rta_type)
+            {
+                matches = RTA_PAYLOAD(rta) == macAddress.size() &&
+                          0 == memcmp(RTA_DATA(rta), &macAddress[0], macAddress.size());
+            }
+            else if (IFLA_IFNAME == rta->rta_type)
+            {
+                linkName = static_cast<const char*>(RTA_DATA(rta));
+            }
+        }
+
+        if (matches && !linkName.empty())
+        {
+            index = ifi->ifi_index;
+            name = linkName;
+            return true;
+        }
+    }
+
+    SCX_LOGWARNING(m_logHandle, "No network adapter found by rtnetlink for the hardware address");
+    return false;
+}
+
+bool NetlinkAdapterConfigurator::SetLinkUp(int index)
+{
+    struct ifinfomsg header;
+    memset(&header, 0, sizeof(header));
+    header.ifi_family = AF_UNSPEC;
+    header.ifi_index = index;
+    header.ifi_flags = IFF_UP;
+    header.ifi_change = IFF_UP;
+
+    std::vector<char> message;
+    StartMessage(message, RTM_NEWLINK, 0, &header, sizeof(header));
+
+    return Request(message);
+}
+
+bool NetlinkAdapterConfigurator::ReplaceAddress(int index, const Address& address)
+{
+    struct ifaddrmsg header;
+    memset(&header, 0, sizeof(header));
+    header.ifa_family = static_cast<unsigned char>(address.m_family);
+
+    std::vector<char> message;
+    StartMessage(message, RTM_GETADDR, NLM_F_DUMP, &header, sizeof(header));
+
+    std::vector<std::vector<char> > replies;
+    if (!Dump(message, replies))
+    {
+        return false;
+    }
+
+    // Drop what the interface had before, as restarting the network would
+    for (std::vector<std::vector<char> >::iterator reply = replies.begin(); reply != replies.end(); ++reply)
+    {
+        struct nlmsghdr* nlh = reinterpret_cast<struct nlmsghdr*>(&(*reply)[0]);
+        struct ifaddrmsg* ifa = static_cast<struct ifaddrmsg*>(NLMSG_DATA(nlh));
+        if (RTM_NEWADDR != nlh->nlmsg_type ||
+            ifa->ifa_index != static_cast<unsigned int>(index) ||
+            ifa->ifa_family != address.m_family ||
+            (AF_INET6 == address.m_family && RT_SCOPE_LINK == ifa->ifa_scope))
+        {
+            continue;
+        }
+
+        nlh->nlmsg_type = RTM_DELADDR;
+        nlh->nlmsg_flags = NLM_F_REQUEST;
+        if (!Request(*reply))
+        {
+            return false;
+        }
+    }
+
+    size_t length = AF_INET == address.m_family ? 4 : 16;
+
+    header.ifa_prefixlen = static_cast<unsigned char>(address.m_prefixLength);
+    header.ifa_scope = RT_SCOPE_UNIVERSE;
+    header.ifa_index = index;
+
+    StartMessage(message, RTM_NEWADDR, NLM_F_CREATE | NLM_F_REPLACE, &header, sizeof(header));
+    AddAttribute(message, IFA_LOCAL, address.m_bytes, length);
+    AddAttribute(message, IFA_ADDRESS, address.m_bytes, length);
+
+    if (AF_INET == address.m_family && address.m_prefixLength < 31)
+    {
+        unsigned char broadcast[4];
+        memcpy(broadcast, address.m_bytes, sizeof(broadcast));
+        for (unsigned int bit = address.m_prefixLength; bit < 32; ++bit)
+        {
+            broadcast[bit / 8] |= static_cast<unsigned char>(0x80 >> (bit % 8));
+        }
+        AddAttribute(message, IFA_BROADCAST, broadcast, sizeof(broadcast));
+    }
+
+    if (!Request(message))
+    {
+        return false;
+    }
+
+    SCX_LOGINFO(m_logHandle, "Added address " + address.m_text + "/" + ToString(address.m_prefixLength));
+    return true;
+}
+
+bool NetlinkAdapterConfigurator::SetDefaultRoute(int index, const std::string& gateway)
+{
+    int family = Contains(gateway, ":") ? AF_INET6 : AF_INET;
+    unsigned char bytes[16];
+    if (1 != inet_pton(family, gateway.c_str(), bytes))
+    {
+        SCX_LOGWARNING(m_logHandle, "Invalid gateway address " + gateway);
+        return false;
+    }
+
+    struct rtmsg header;
+    memset(&header, 0, sizeof(header));
+    header.rtm_family = static_cast<unsigned char>(family);
+    header.rtm_table = RT_TABLE_MAIN;
+    header.rtm_protocol = RTPROT_BOOT;
+    header.rtm_scope = RT_SCOPE_UNIVERSE;
+    header.rtm_type = RTN_UNICAST;
+
+    std::vector<char> message;
+    StartMessage(message, RTM_NEWROUTE, NLM_F_CREATE | NLM_F_REPLACE, &header, sizeof(header));
+    AddAttribute(message, RTA_GATEWAY, bytes, AF_INET == family ? 4 : 16);
+    AddAttribute(message, RTA_OIF, &index, sizeof(index));
+
+    if (!Request(message))
+    {
+        return false;
+    }
+
+    SCX_LOGINFO(m_logHandle, "Default route set to " + gateway);
+    return true;
+}
+
+bool NetlinkAdapterConfigurator::WriteRHELConfig(const std::string& device, const Settings& settings)
+{
+    std::string networkFile = RootPath("/etc/sysconfig/network");
+    std::vector<std::string> lines;
+    ConfigFiles::ReadLines(networkFile, lines);
+
+    // Same edits as the script: networking on, first gateway as the global default
+    std::vector<std::string> network;
+    for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
+    {
+        if (Contains(*iter, "NETWORKING=") ||
+            (settings.m_hasIPv6 && Contains(*iter, "NETWORKING_IPV6=")) ||
+            (!settings.m_gateways.empty() && (Contains(*iter, "gateway") || Contains(*iter, "GATEWAY"))))
+        {
+            continue;
+        }
+        network.push_back(*iter);
+    }
+
+    network.push_back("NETWORKING=yes");
+    if (settings.m_hasIPv6)
+    {
+        network.push_back("NETWORKING_IPV6=yes");
+    }
+    if (!settings.m_gateways.empty())
+    {
+        network.push_back("GATEWAY=" + settings.m_gateways[0]);
+    }
+
+    if (!ConfigFiles::WriteLines(networkFile, network))
+    {
+        return false;
+    }
+
+    std::string directory = RootPath("/etc/sysconfig/network-scripts");
+    RemoveMatchingFiles(directory, "ifcfg-", device);
+    RemoveMatchingFiles(directory, "route-", device);
+
+    std::string config = "DEVICE='" + device + "'\nSTARTMODE='auto'\n";
+    if (settings.m_hasIPv4)
+    {
+        config += "BOOTPROTO='static'\n";
+        config += "IPADDR='" + settings.m_ipv4.m_text + "'\n";
+        config += "NETMASK='" + PrefixToNetmask(settings.m_ipv4.m_prefixLength) + "'\n";
+    }
+    if (settings.m_hasIPv6)
+    {
+        config += "IPV6INIT='yes'\n";
+        config += "IPV6_AUTOCONF='no'\n";
+        config += "IPV6ADDR='" + settings.m_ipv6.m_text + "/" + ToString(settings.m_ipv6.m_prefixLength) + "'\n";
+    }
+    config += "PEERDNS='no'\n";
+
+    return ConfigFiles::WriteFile(directory + "/ifcfg-" + device, config);
+}
+
+bool NetlinkAdapterConfigurator::WriteSUSEConfig(const std::string& device, const Settings& settings)
+{
+    std::string directory = RootPath("/etc/sysconfig/network");
+    RemoveMatchingFiles(directory, "ifcfg-", device);
+
+    std::string config = "DEVICE='" + device + "'\nSTARTMODE='auto'\n";
+    if (settings.m_hasIPv4)
+    {
+        config += "BOOTPROTO='static'\n";
+        config += "IPADDR='" + settings.m_ipv4.m_text + "'\n";
+        config += "NETMASK='" + PrefixToNetmask(settings.m_ipv4.m_prefixLength) + "'\n";
+    }
+    if (settings.m_hasIPv6)
+    {
+        config += "LABEL_0='0'\n";
+        config += "IPADDR_0='" + settings.m_ipv6.m_text + "'\n";
+        config += "PREFIXLEN_0='" + ToString(settings.m_ipv6.m_prefixLength) + "'\n";
+    }
+
+    if (!ConfigFiles::WriteFile(directory + "/ifcfg-" + device, config))
+    {
+        return false;
+    }
+
+    if (!settings.m_gateways.empty())
+    {
+        RemoveMatchingFiles(directory, "ifroute-", device);
+
+        std::string routes = "# Destination     gateway     Netmask            Device\n";
+        routes += "default\t" + settings.m_gateways[0] + "\t0.0.0.0\t\t" + device + "\n";
+        if (!ConfigFiles::WriteFile(directory + "/ifroute-" + device, routes))
+        {
+            return false;
+        }
+
+        // The global routing table is expected to be invalid now
+        std::string routesFile = directory + "/routes";
+        struct stat st;
+        if (0 == stat(routesFile.c_str(), &st))
+        {
+            rename(routesFile.c_str(), (routesFile + ".bak").c_str());
+        }
+    }
+
+    return true;
+}
+
+bool NetlinkAdapterConfigurator::WriteDebianConfig(const std::string& device, const Settings& settings)
+{
+    std::string interfacesFile = RootPath("/etc/network/interfaces");
+    std::vector<std::string> lines;
+    ConfigFiles::ReadLines(interfacesFile, lines);
+
+    // Remove the stanzas of the device and its sub interfaces, like the script's sed edits
+    std::vector<std::string> interfaces;
+    bool inStanza = false;
+    for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
+    {
+        const std::string& line = *iter;
+        if (line.empty())
+        {
+            inStanza = false;
+        }
+        else if (StartsWith(line, "iface " + device + " ") ||
+                 StartsWith(line, "iface " + device + ".") ||
+                 StartsWith(line, "mapping " + device + " "))
+        {
+            inStanza = true;
+            continue;
+        }
+
+        if (inStanza ||
+            Contains(line, device + " ") ||
+            Contains(line, device + ".") ||
+            EndsWith(line, device))
+        {
+            continue;
+        }
+
+        interfaces.push_back(line);
+    }
+
+    interfaces.push_back("");
+    interfaces.push_back("#" + device);
+    interfaces.push_back("auto " + device);
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        bool isIPv6 = 1 == pass;
+        if (!(isIPv6 ? settings.m_hasIPv6 : settings.m_hasIPv4))
+        {
+            continue;
+        }
+
+        const Address& address = isIPv6 ? settings.m_ipv6 : settings.m_ipv4;
+        if (isIPv6)
+        {
+            interfaces.push_back("");
+            interfaces.push_back("iface " + device + " inet6 static");
+            interfaces.push_back("pre-up modprobe ipv6");
+            interfaces.push_back("     address " + address.m_text);
+            interfaces.push_back("     netmask " + ToString(address.m_prefixLength));
+        }
+        else
+        {
+            interfaces.push_back("iface " + device + " inet static");
+            interfaces.push_back("     address " + address.m_text);
+            interfaces.push_back("     netmask " + PrefixToNetmask(address.m_prefixLength));
+        }
+
+        for (std::vector<std::string>::const_iterator iter = settings.m_gateways.begin();
+             iter != settings.m_gateways.end();
+             ++iter)
+        {
+            if (Contains(*iter, ":") == isIPv6)
+            {
+                interfaces.push_back("     gateway " + *iter);
+                break;
+            }
+        }
+    }
+
+    interfaces.push_back("");
+
+    return ConfigFiles::WriteLines(interfacesFile, interfaces);
+}
+
+bool NetlinkAdapterConfigurator::WriteHostsEntries(const Settings& settings)
+{
+    char hostName[256] = "";
+    if (gethostname(hostName, sizeof(hostName) - 1) != 0)
+    {
+        hostName[0] = '\0';
+    }
+
+    std::string domain;
+    std::vector<std::string> resolv;
+    ConfigFiles::ReadLines(RootPath("/etc/resolv.conf"), resolv);
+    for (std::vector<std::string>::const_iterator iter = resolv.begin(); iter != resolv.end(); ++iter)
+    {
+        std::vector<std::string> words;
+        ConfigFiles::SplitWords(*iter, words);
+        if (words.size() >= 2 && "domain" == words[0])
+        {
+            domain = words[1];
+        }
+    }
+
+    std::string hostsFile = RootPath("/etc/hosts");
+    std::vector<std::string> lines;
+    ConfigFiles::ReadLines(hostsFile, lines);
+
+    std::vector<std::string> addresses;
+    if (settings.m_hasIPv4)
+    {
+        addresses.push_back(settings.m_ipv4.m_text);
+    }
+    if (settings.m_hasIPv6)
+    {
+        addresses.push_back(settings.m_ipv6.m_text);
+    }
+
+    for (std::vector<std::string>::const_iterator address = addresses.begin(); address != addresses.end(); ++address)
+    {
+        std::vector<std::string> hosts;
+        for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
+        {
+            if (!Contains(*iter, *address))
+            {
+                hosts.push_back(*iter);
+            }
+        }
+
+        std::string host(hostName);
+        if (!host.empty())
+        {
+            hosts.push_back(*address + "  " + (domain.empty() ? host : host + "." + domain + "  " + host));
+        }
+
+        lines.swap(hosts);
+    }
+
+    return ConfigFiles::WriteLines(hostsFile, lines);
+}
+
+bool NetlinkAdapterConfigurator::WriteResolvConf(const Settings& settings)
+{
+    if (settings.m_nameServers.empty() && settings.m_searchSuffixes.empty())
+    {
+        return true;
+    }
+
+    std::string resolvFile = RootPath("/etc/resolv.conf");
+    std::vector<std::string> lines;
+    ConfigFiles::ReadLines(resolvFile, lines);
+
+    // Keep the existing search suffixes and the name servers added by the agent
+    std::vector<std::string> search;
+    std::vector<std::string> nameServers;
+    std::vector<std::string> resolv;
+    for (std::vector<std::string>::const_iterator iter = lines.begin(); iter != lines.end(); ++iter)
+    {
+        std::vector<std::string> words;
+        ConfigFiles::SplitWords(*iter, words);
+        if (StartsWith(*iter, "search "))
+        {
+            search.insert(search.end(), words.begin() + 1, words.end());
+        }
+        else if (StartsWith(*iter, "nameserver "))
+        {
+            if (Contains(*iter, VMM_TAG) && words.size() >= 2)
+            {
+                nameServers.push_back(words[1]);
+            }
+        }
+        else
+        {
+            resolv.push_back(*iter);
+        }
+    }
+
+    for (std::vector<std::string>::const_iterator iter = settings.m_searchSuffixes.begin();
+         iter != settings.m_searchSuffixes.end();
+         ++iter)
+    {
+        if (std::find(search.begin(), search.end(), *iter) == search.end())
+        {
+            search.push_back(*iter);
+        }
+    }
+
+    for (std::vector<std::string>::const_iterator iter = settings.m_nameServers.begin();
+         iter != settings.m_nameServers.end() && nameServers.size() < MAX_VMM_NAMESERVERS;
+         ++iter)
+    {
+        if (std::find(nameServers.begin(), nameServers.end(), *iter) == nameServers.end())
+        {
+            nameServers.push_back(*iter);
+        }
+    }
+
+    std::string searchLine = "search";
+    for (std::vector<std::string>::const_iterator iter = search.begin(); iter != search.end(); ++iter)
+    {
+        searchLine += " " + *iter;
+    }
+    resolv.push_back(searchLine);
+
+    for (std::vector<std::string>::const_iterator iter = nameServers.begin(); iter != nameServers.end(); ++iter)
+    {
+        resolv.push_back("nameserver " + *iter + " " + VMM_TAG);
+    }
+
+    return ConfigFiles::WriteLines(resolvFile, resolv);
+}
+
+std::string NetlinkAdapterConfigurator::RootPath(const std::string& path) const
+{
+    return m_rootDir + path;
+}
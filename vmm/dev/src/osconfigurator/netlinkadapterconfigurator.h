@@ -0,0 +1,240 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        netlinkadapterconfigurator.h
+
+   \brief       Configures a network adapter with static addresses in process:
+                addresses and default routes are applied over rtnetlink and the
+                distribution's network configuration files are written directly.
+
+   \date        10-18-2026 14:05:12
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef NETLINKADAPTERCONFIGURATOR_H
+#define NETLINKADAPTERCONFIGURATOR_H
+
+#include <string>
+#include <vector>
+
+#include <netinet/in.h>
+
+#include <scxcorelib/scxlog.h>
+
+#include <configfiles.h>
+#include <osspecializationreader.h>
+
+namespace VMM
+{
+
+    namespace GuestAgent
+    {
+
+        namespace OSConfigurator
+        {
+
+            class NetlinkAdapterConfigurator
+            {
+
+            public:
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Constructor for NetlinkAdapterConfigurator
+
+                   \param      rootDir   Directory the distribution configuration files are
+                                         written under; empty for the running system
+
+                */
+                explicit NetlinkAdapterConfigurator(const std::string& rootDir);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+
+                   Destructor for NetlinkAdapterConfigurator
+
+                */
+                ~NetlinkAdapterConfigurator();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Configure one adapter.  Only adapters whose configured address families
+                   are all static are handled; anything else (DHCP, an unsupported
+                   distribution, a netlink or file failure) is left to the network script.
+
+                   \param      netAdapter  Network Adapter object
+                   \param      device      Receives the name of the configured interface
+
+                   \return     true if the adapter was configured completely, false if the
+                               network script has to configure it
+
+                */
+                bool Configure(const VMM::GuestAgent::SpecializationReader::OSSpecializationReader::VNetAdapter&
+                               netAdapter,
+                               std::string& device);
+
+            private:
+
+                /** Intentionally not implemented */
+                NetlinkAdapterConfigurator(const NetlinkAdapterConfigurator&);
+                NetlinkAdapterConfigurator& operator=(const NetlinkAdapterConfigurator&);
+
+                /** One static address */
+                struct Address
+                {
+                    int           m_family;       //!< AF_INET or AF_INET6
+                    unsigned char m_bytes[16];    //!< Address in network byte order
+                    unsigned int  m_prefixLength; //!< Prefix length
+                    std::string   m_text;         //!< Address without the prefix length
+                };
+
+                /** Settings of one adapter, taken from the specialization file */
+                struct Settings
+                {
+                    std::vector<unsigned char> m_macAddress;
+                    std::string                m_macText;
+                    bool                       m_hasIPv4;
+                    Address                    m_ipv4;
+                    bool                       m_hasIPv6;
+                    Address                    m_ipv6;
+                    std::vector<std::string>   m_gateways;
+                    std::vector<std::string>   m_nameServers;
+                    std::vector<std::string>   m_searchSuffixes;
+                };
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Extract the adapter settings; false if they need the network script
+
+                */
+                bool ReadSettings(const VMM::GuestAgent::SpecializationReader::OSSpecializationReader::VNetAdapter&
+                                  netAdapter,
+                                  Settings& settings);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Tell the distribution family; false if it is left to the network script
+
+                */
+                bool DetectDistro(ConfigFiles::Distro& distro) const;
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Open the rtnetlink socket
+
+                */
+                bool OpenSocket();
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Send a request and wait for its acknowledgement
+
+                */
+                bool Request(std::vector<char>& message);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Send a dump request and collect every message of the reply
+
+                */
+                bool Dump(std::vector<char>& message, std::vector<std::vector<char> >& replies);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Find the interface with the given hardware address (RTM_GETLINK dump)
+
+                */
+                bool FindLink(const std::vector<unsigned char>& macAddress, int& index, std::string& name);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Bring the interface up
+
+                */
+                bool SetLinkUp(int index);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Remove the addresses of one family from the interface, except IPv6
+                   link local ones, and add the configured address
+
+                */
+                bool ReplaceAddress(int index, const Address& address);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Point the default route of the gateway's family at the interface
+
+                */
+                bool SetDefaultRoute(int index, const std::string& gateway);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Write the interface configuration for the distribution
+
+                */
+                bool WriteRHELConfig(const std::string& device, const Settings& settings);
+                bool WriteSUSEConfig(const std::string& device, const Settings& settings);
+                bool WriteDebianConfig(const std::string& device, const Settings& settings);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Point /etc/hosts entries of the static addresses at this host
+
+                */
+                bool WriteHostsEntries(const Settings& settings);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Add the name servers and search suffixes to /etc/resolv.conf
+
+                */
+                bool WriteResolvConf(const Settings& settings);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Path of a configuration file below the root directory
+
+                */
+                std::string RootPath(const std::string& path) const;
+
+                /** Log Handle */
+                SCXCoreLib::SCXLogHandle m_logHandle;
+
+                /** Directory configuration files are written under */
+                std::string              m_rootDir;
+
+                /** rtnetlink socket */
+                int                      m_socket;
+
+                /** Sequence number of the last request */
+                unsigned int             m_sequence;
+
+            }; // End of NetlinkAdapterConfigurator class
+
+        } // End of OSConfigurator namespace
+
+    } // End of GuestAgent namespace
+
+} // End of VMM namespace
+
+#endif /* NETLINKADAPTERCONFIGURATOR_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
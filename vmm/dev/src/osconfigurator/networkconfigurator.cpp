@@ -31,14 +31,21 @@
 /*----------------------------------------------------------------------------*/
 #include <networkconfigurator.h>
 
-#include <isofetcher.h>
+#include <fstream>
+
+#include <stdlib.h>
+#include <unistd.h>
+
 #include <argumentmanager.h>
+#include <netlinkadapterconfigurator.h>
 #include <commandexecutor.h>
 #include <statusmessage.h>
 #include <statusmessagestrings.h>
+#include <terminatesetupexception.h>
 
-using VMM::GuestAgent::Fetcher::ISOFetcher;
+using VMM::GuestAgent::OSConfigurator::NetlinkAdapterConfigurator;
 using VMM::GuestAgent::OSConfigurator::NetworkConfigurator;
+using VMM::GuestAgent::OSConfigurator::TerminateSetupException;
 using VMM::GuestAgent::StatusManager::StatusMessage;
 using VMM::GuestAgent::Utilities::ArgumentManager;
 using SCX::Util::Xml::XElement;
@@ -55,10 +62,47 @@ void NetworkConfigurator::Execute(const std::vector<OSSpecializationReader::VNet
 
     if (vNetAdapters.size())
     {
+        // Static adapters are configured in process; collect the script
+        // arguments of the others
+        NetlinkAdapterConfigurator netlinkConfigurator(ArgumentManager::Instance().GetRootDir());
+        std::vector<std::string> adapterParams;
         std::vector<OSSpecializationReader::VNetAdapter>::const_iterator iter;
         for (iter = vNetAdapters.begin(); iter != vNetAdapters.end(); ++iter)
         {
-            ConfigureNetworkAdapter(*iter);
+            std::string device;
+            if (netlinkConfigurator.Configure(*iter, device))
+            {
+                RecordDefinedAdapter(device);
+                continue;
+            }
+
+            std::string commandParams;
+            BuildAdapterArguments(*iter, commandParams);
+            if (!commandParams.empty())
+            {
+                adapterParams.push_back(commandParams);
+            }
+        }
+
+        std::string script = ArgumentManager::Instance().GetVMMHome() + "/bin/cfgnetadapter";
+        std::string manifest = ArgumentManager::Instance().GetVMMHome() + "/status/netadapters";
+
+        // Several adapters are configured by a single run of the script, which
+        // then detects the distribution and restarts the network only once
+        if (adapterParams.size() > 1 && WriteAdapterManifest(adapterParams, manifest))
+        {
+            SCX_LOGINFO(m_logHandle, ("Executing network configuration script for all adapters"));
+            RunNetworkScript(script + " manifest=" + manifest, adapterParams.size());
+            unlink(manifest.c_str());
+        }
+        else
+        {
+            std::vector<std::string>::const_iterator paramIter;
+            for (paramIter = adapterParams.begin(); paramIter != adapterParams.end(); ++paramIter)
+            {
+                SCX_LOGINFO(m_logHandle, ("Executing network configuration script"));
+                RunNetworkScript(script + *paramIter, 1);
+            }
         }
     }
     else
@@ -75,11 +119,6 @@ void NetworkConfigurator::ConfigureUnspecifiedNetAdaptersForDHCP()
 {
 
     SCX_LOGINFO(m_logHandle, ("Configuring unspecified network adapters as DHCP"));
-    if (setenv("HISTIGNORE", "*", 1) != 0)
-    {
-        SCX_LOGERROR(m_logHandle, ("failed to set HISTIGNORE"));
-    }
-
     std::string command = ArgumentManager::Instance().GetVMMHome() + "/bin/cfgdynnetadapter ";
     SCX_LOGINFO(m_logHandle, "Shell Command:" + command);
 
@@ -94,16 +133,16 @@ void NetworkConfigurator::ConfigureUnspecifiedNetAdaptersForDHCP()
         StatusMessage::Instance().AddChildToRoot(XElementPtr(new XElement(StatusMessageStrings::SpecializationStatus, 
                                                                           StatusMessageStrings::SpecializationFailed)));
         
-        ISOFetcher::Instance().TerminateSetup();
+        throw TerminateSetupException(L"Network configuration failed");
     }
     
 }
 
-void NetworkConfigurator::ConfigureNetworkAdapter(const OSSpecializationReader::VNetAdapter& netAdapter)
+void NetworkConfigurator::BuildAdapterArguments(const OSSpecializationReader::VNetAdapter& netAdapter,
+                                                std::string& commandParams)
 {
     
-    std::string command;
-    std::string commandParams;
+    commandParams.clear();
 
     // Add MACAddress if present
     Utf8String macAddress;
@@ -236,31 +275,66 @@ void NetworkConfigurator::ConfigureNetworkAdapter(const OSSpecializationReader::
         SCX_LOGWARNING(m_logHandle, ("No DNS Search suffixes to configure"));
     }
 
-    // Invoke script
-    if (!commandParams.empty())
+}
+
+bool NetworkConfigurator::WriteAdapterManifest(const std::vector<std::string>& adapterParams,
+                                               const std::string& manifest)
+{
+    std::ofstream manifestStream(manifest.c_str(), std::ios_base::out | std::ios_base::trunc);
+
+    // One line of script arguments per adapter
+    std::vector<std::string>::const_iterator iter;
+    for (iter = adapterParams.begin(); manifestStream.good() && iter != adapterParams.end(); ++iter)
     {
-        SCX_LOGINFO(m_logHandle, ("Executing network configuration script"));
-        if (setenv("HISTIGNORE", "*", 1) != 0)
-        {
-            SCX_LOGERROR(m_logHandle, "failed to set HISTIGNORE");
-        }
+        manifestStream << *iter << "\n";
+    }
 
-        std::string command = ArgumentManager::Instance().GetVMMHome() + "/bin/cfgnetadapter " + commandParams;
-        SCX_LOGINFO(m_logHandle, ("Shell Command:") + (command));
+    manifestStream.close();
+    if (manifestStream.fail())
+    {
+        SCX_LOGWARNING(m_logHandle, "Unable to write network adapter manifest " + manifest +
+                       ", configuring adapters one at a time");
+        unlink(manifest.c_str());
+        return false;
+    }
 
-        // Execute
-        VMM::GuestAgent::Utilities::CommandExecutor commandExec;
-        int ret = commandExec.Execute(SCXCoreLib::StrFromMultibyte(command),
-                                      m_componentName);
-        if (ret < 0)
-        {
-            SCX_LOGERROR(m_logHandle, "Network configuration failed. Fatal failure");
-            
-            StatusMessage::Instance().AddChildToRoot(XElementPtr(new XElement(StatusMessageStrings::SpecializationStatus, 
-                                                                              StatusMessageStrings::SpecializationFailed)));
+    return true;
+}
 
-            ISOFetcher::Instance().TerminateSetup();
-        }
+void NetworkConfigurator::RecordDefinedAdapter(const std::string& device)
+{
+    // cfgdynnetadapter leaves the adapters listed here alone
+    std::string definedAdapters = ArgumentManager::Instance().GetVMMHome() + "/status/definedadapters";
+    std::ofstream stream(definedAdapters.c_str(), std::ios_base::out | std::ios_base::app);
+    stream << device << "\n";
+    stream.close();
+    if (stream.fail())
+    {
+        SCX_LOGWARNING(m_logHandle, "Unable to record configured network adapter " + device);
     }
+}
+
+void NetworkConfigurator::RunNetworkScript(const std::string& command, size_t adapters)
+{
+    SCX_LOGINFO(m_logHandle, ("Shell Command:") + (command));
 
+    // One run of the script may configure every adapter; give it the time
+    // one run per adapter would have had
+    unsigned int timeout = VMM::GuestAgent::Utilities::clampTimeout(
+        static_cast<unsigned long>(VMM::GuestAgent::Utilities::DEFAULT_TIMEOUT) * adapters);
+
+    // Execute
+    VMM::GuestAgent::Utilities::CommandExecutor commandExec;
+    int ret = commandExec.Execute(SCXCoreLib::StrFromMultibyte(command),
+                                  m_componentName,
+                                  timeout);
+    if (ret < 0)
+    {
+        SCX_LOGERROR(m_logHandle, "Network configuration failed. Fatal failure");
+        
+        StatusMessage::Instance().AddChildToRoot(XElementPtr(new XElement(StatusMessageStrings::SpecializationStatus, 
+                                                                          StatusMessageStrings::SpecializationFailed)));
+
+        throw TerminateSetupException(L"Network configuration failed");
+    }
 }
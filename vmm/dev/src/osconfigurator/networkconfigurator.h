@@ -34,6 +34,7 @@
 
 #include <util/LogHandleCache.h>
 
+#include <configuratornames.h>
 #include <osconfigurator.h>
 #include <osspecializationreader.h>
 
@@ -68,7 +69,7 @@ namespace VMM
                 NetworkConfigurator()
                   : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
                                 "scx.vmmguestagent.osconfigurator.networkconfigurator"))
-                  , m_componentName("Network-Configurator")
+                  , m_componentName(ConfiguratorNames::Network)
                 {}
 
                 /*----------------------------------------------------------------------------*/
@@ -91,6 +92,30 @@ namespace VMM
                     visitor.Visit(this);
                 }
 
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Name of the configurator
+
+                   \return     Configurator name
+                */
+                inline std::string GetName() const
+                {
+                    return m_componentName;
+                }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Configurators that have to complete before this one runs
+
+                   \param  dependencies    Receives the configurator names
+                */
+                inline void GetDependencies(std::vector<std::string>& dependencies) const
+                {
+                    // Adapters are configured once the host name is in place
+                    dependencies.push_back(ConfiguratorNames::Pre);
+                    dependencies.push_back(ConfiguratorNames::HostDomain);
+                }
+
                 /*----------------------------------------------------------------------------*/
                 /**
                    Function that invokes the networkconfig script
@@ -104,15 +129,60 @@ namespace VMM
             private:
                 /*----------------------------------------------------------------------------*/
                 /**
-                   Helper function that configures one network adapter configuration
+                   Helper function that builds the network script arguments for one
+                   network adapter configuration
+
+                   \param      vNetAdapter      Network Adapter object
+                   \param      commandParams    Receives the arguments, empty if there is
+                                                nothing to configure
+
+                   \return     None
+
+                */
+                void BuildAdapterArguments(const VMM::GuestAgent::SpecializationReader::OSSpecializationReader::VNetAdapter&
+                                           vNetAdapter,
+                                           std::string& commandParams);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Helper function that writes the manifest the network script reads
+                   when configuring several adapters in one run
+
+                   \param      adapterParams    Script arguments, one entry per adapter
+                   \param      manifest         Path of the manifest file
+
+                   \return     true if the manifest was written completely
+
+                */
+                bool WriteAdapterManifest(const std::vector<std::string>& adapterParams,
+                                          const std::string& manifest);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Helper function that records an adapter configured without the network
+                   script, so that it is not reconfigured for DHCP
+
+                   \param      device    Interface name
+
+                   \return     None
+
+                */
+                void RecordDefinedAdapter(const std::string& device);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Helper function that runs the network script and terminates setup
+                   on a fatal failure
+
+                   \param      command    Full script command line
 
-                   \param      vNetAdapter    Network Adapter object
+                   \param      adapters   Number of adapters the script configures; it
+                                          gets the default command timeout for each
 
                    \return     None
 
                 */
-                void ConfigureNetworkAdapter(const VMM::GuestAgent::SpecializationReader::OSSpecializationReader::VNetAdapter&
-                                             vNetAdapter);
+                void RunNetworkScript(const std::string& command, size_t adapters);
 
                 /*----------------------------------------------------------------------------*/
                 /**
@@ -32,6 +32,9 @@
 #ifndef OSCONFIGURATOR_H
 #define OSCONFIGURATOR_H
 
+#include <string>
+#include <vector>
+
 #include <osconfiguratorvisitor.h>
 
 namespace VMM
@@ -66,6 +69,24 @@ namespace VMM
                 */
                 virtual void Accept(VMM::GuestAgent::OSConfigurator::Visitor& v) = 0;
 
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Name of the configurator - pure virtual function
+
+                   \return     Configurator name, one of ConfiguratorNames
+                */
+                virtual std::string GetName() const = 0;
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Names of the configurators that have to complete before this one may
+                   run - pure virtual function.  Configurators that do not depend on each
+                   other are run concurrently.
+
+                   \param  dependencies    Receives the configurator names
+                */
+                virtual void GetDependencies(std::vector<std::string>& dependencies) const = 0;
+
             }; // End of OSConfigurator class
 
         } // End of OSConfigurator namespace
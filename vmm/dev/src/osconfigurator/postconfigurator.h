@@ -36,12 +36,13 @@
 
 #include <util/LogHandleCache.h>
 
-#include <isofetcher.h>
 #include <argumentmanager.h>
+#include <configuratornames.h>
 #include <osconfigurator.h>
 #include <commandexecutor.h>
 #include <statusmessage.h>
 #include <statusmessagestrings.h>
+#include <terminatesetupexception.h>
 
 
 namespace VMM
@@ -75,7 +76,7 @@ namespace VMM
                 PostConfigurator()
                   : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
                                 "scx.vmmguestagent.osconfigurator.postconfigurator"))
-                  , m_componentName("Post-Configurator")
+                  , m_componentName(ConfiguratorNames::Post)
                 {}
 
                 /*----------------------------------------------------------------------------*/
@@ -98,6 +99,33 @@ namespace VMM
                     visitor.Visit(this);
                 }
 
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Name of the configurator
+
+                   \return     Configurator name
+                */
+                inline std::string GetName() const
+                {
+                    return m_componentName;
+                }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Configurators that have to complete before this one runs
+
+                   \param  dependencies    Receives the configurator names
+                */
+                inline void GetDependencies(std::vector<std::string>& dependencies) const
+                {
+                    dependencies.push_back(ConfiguratorNames::Pre);
+                    dependencies.push_back(ConfiguratorNames::TimeZone);
+                    dependencies.push_back(ConfiguratorNames::HostDomain);
+                    dependencies.push_back(ConfiguratorNames::Users);
+                    dependencies.push_back(ConfiguratorNames::Network);
+                    dependencies.push_back(ConfiguratorNames::RunOnce);
+                }
+
                 /*----------------------------------------------------------------------------*/
                 /**
                    Function that invokes the preconfig script
@@ -109,15 +137,9 @@ namespace VMM
                 {
                     using namespace VMM::GuestAgent::Utilities;
                     using namespace VMM::GuestAgent::StatusManager;
-                    using namespace VMM::GuestAgent::Fetcher;
                     using namespace SCX::Util::Xml;
 
                     SCX_LOGINFO(m_logHandle, ("Executing post-configuration script"));
-                    
-                    if (setenv("HISTIGNORE", "*", 1) != 0)
-                    {
-                        SCX_LOGERROR(m_logHandle, ("failed to set HISTIGNORE"));
-                    }
 
                     // Invoke script
                     std::string command =
@@ -144,7 +166,8 @@ namespace VMM
                                                      StatusMessageStrings::SpecializationComplete)));
                     }
 
-                    ISOFetcher::Instance().TerminateSetup();
+                    // The setup ends here either way
+                    throw TerminateSetupException(L"Post-configuration done");
 
                 }
 
@@ -38,10 +38,12 @@
 #include <commandexecutor.h>
 #include <statusmessage.h>
 #include <statusmessagestrings.h>
+#include <terminatesetupexception.h>
 
 #include <scxcorelib/stringaid.h>
 
 using VMM::GuestAgent::OSConfigurator::PreConfigurator;
+using VMM::GuestAgent::OSConfigurator::TerminateSetupException;
 using VMM::GuestAgent::Fetcher::ISOFetcher;
 using VMM::GuestAgent::StatusManager::StatusMessage;
 using VMM::GuestAgent::Utilities::ArgumentManager;
@@ -72,11 +74,6 @@ void PreConfigurator::Execute()
     {
         SCX_LOGINFO(m_logHandle, "Pre-Configuration was never run before");
 
-        if (setenv("HISTIGNORE", "*", 1) != 0)
-        {
-            SCX_LOGERROR(m_logHandle, "failed to set HISTIGNORE");
-        }
-
         std::string command = ArgumentManager::Instance().GetVMMHome() + "/bin/cfgpre";
         SCX_LOGINFO(m_logHandle, "Shell Command:" + command);
     
@@ -94,14 +91,12 @@ void PreConfigurator::Execute()
             // Create the control file
             StatusMessage::Instance().AddChildToRoot(XElementPtr(new XElement(PreConfiguratorStatus, 
                                                                               PreConfiguratorSuccessfull)));
+            StatusMessage::Instance().Compact();
+
             // Restart
             ISOFetcher::Instance().ModifyGrub();
 
-            char const* args[] = { "shutdown", "-r", "now", 0 };
-
-            execv ("/sbin/shutdown", const_cast<char * const*>(args));
-            execv ("/etc/shutdown", const_cast<char * const*>(args));
-            execv ("/bin/shutdown", const_cast<char * const*>(args));
+            VMM::GuestAgent::Utilities::CommandExecutor::Shutdown("-r");
 
             SCX_LOGERROR(m_logHandle, "Unable to reboot after preconfig. Aborting");
         }
@@ -112,7 +107,7 @@ void PreConfigurator::Execute()
                                                                               PreConfiguratorFailed)));
             StatusMessage::Instance().AddChildToRoot(XElementPtr(new XElement( StatusMessageStrings::SpecializationFailed, "")));
 
-            ISOFetcher::Instance().TerminateSetup();
+            throw TerminateSetupException(L"Preconfig did not finish");
         }
         
     }
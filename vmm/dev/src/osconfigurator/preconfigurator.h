@@ -37,6 +37,7 @@
 
 #include <util/LogHandleCache.h>
 
+#include <configuratornames.h>
 #include <osconfigurator.h>
 #include <commandexecutor.h>
 
@@ -71,7 +72,7 @@ namespace VMM
                 PreConfigurator()
                   : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
                                 "scx.vmmguestagent.osconfigurator.preconfigurator"))
-                  , m_componentName("Pre-Configurator")
+                  , m_componentName(ConfiguratorNames::Pre)
                 {}
 
                 /*----------------------------------------------------------------------------*/
@@ -94,6 +95,28 @@ namespace VMM
                     visitor.Visit(this);
                 }
 
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Name of the configurator
+
+                   \return     Configurator name
+                */
+                inline std::string GetName() const
+                {
+                    return m_componentName;
+                }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Configurators that have to complete before this one runs
+
+                   \param  dependencies    Receives the configurator names
+                */
+                inline void GetDependencies(std::vector<std::string>& /* dependencies */) const
+                {
+                    // Runs first; everything else depends on it
+                }
+
                 /*----------------------------------------------------------------------------*/
                 /**
                    Function that invokes the preconfig script
@@ -31,49 +31,141 @@
 /*----------------------------------------------------------------------------*/
 #include <runoncecommandconfigurator.h>
 #include <commandexecutor.h>
+#include <inputdigest.h>
+#include <statusmessage.h>
+#include <statusmessagestrings.h>
+
+#include <util/XElement.h>
+
+#include <vector>
 
 using VMM::GuestAgent::OSConfigurator::RunOnceCommandConfigurator;
+using VMM::GuestAgent::StatusManager::StatusMessage;
+using VMM::GuestAgent::StatusManager::StatusMessageStrings;
 using VMM::GuestAgent::Utilities::CommandExecutor;
+using VMM::GuestAgent::Utilities::InputDigest;
+using VMM::GuestAgent::Utilities::PendingCommandHandle;
+using SCX::Util::Utf8String;
+using SCX::Util::Xml::XElement;
+using SCX::Util::Xml::XElementPtr;
 using namespace VMM::GuestAgent::Utilities;
 
 const std::string RunOnceCommandConfiguratorComponent = "RunOnceCommandConfigurator";
 
-void RunOnceCommandConfigurator::Execute(const std::map<int, SCX::Util::Utf8String>& commands)
+const std::string AttributeNameSequence                = "Sequence";
+const std::string AttributeNameExitCode                = "ExitCode";
+
+namespace
 {
-    CommandExecutor commandExecutor;
+    /** A run-once command that has been started */
+    struct StartedCommand
+    {
+        int                  m_sequence;
+        std::string          m_step;        //!< Checkpoint step of the command
+        std::string          m_digest;      //!< Checkpoint input digest of the command
+        std::string          m_command;
+        PendingCommandHandle m_pending;
+    };
+
+    /*----------------------------------------------------------------------------*/
+    /**
+       Do two commands belong to the same group?
+
+       \param  groups      Group of each command that has one, by sequence
+       \param  first       Sequence of one command
+       \param  second      Sequence of the other command
+    */
+    bool SameGroup(const std::map<int, Utf8String>& groups, int first, int second)
+    {
+        std::map<int, Utf8String>::const_iterator firstGroup = groups.find(first);
+        std::map<int, Utf8String>::const_iterator secondGroup = groups.find(second);
+
+        return firstGroup != groups.end() &&
+               secondGroup != groups.end() &&
+               firstGroup->second == secondGroup->second;
+    }
+}
+
+void RunOnceCommandConfigurator::Execute(const std::map<int, Utf8String>& commands,
+                                         const std::map<int, Utf8String>& groups,
+                                         unsigned int maxConcurrent)
+{
+    unsigned int timeout = readConfig ();
+    if (DEFAULT_TIMEOUT != timeout)
+    {
+        std::ostringstream strm;
+        strm << "Timeout value overridden to " << timeout << " seconds";
+        SCX_LOGINFO (m_logHandle, strm.str ());
+    }
+
+    CommandExecutor::SetConcurrencyLimit(0 != maxConcurrent ? maxConcurrent : DEFAULT_CONCURRENT_COMMANDS);
+
     int exitstatus = 0;
 
-    for (std::map<int, SCX::Util::Utf8String>::const_iterator it = commands.begin(); it != commands.end(); ++it)
+    std::map<int, Utf8String>::const_iterator it = commands.begin();
+    while (it != commands.end())
     {
-        std::ostringstream st;
-        st << it->first;
-        SCX_LOGINFO(m_logHandle, "Executing run-once command item: " +
-                    st.str() +
-                    " command: " +
-                    it->second.Str());
-
-        if (setenv("HISTIGNORE", "*", 1) != 0)
-        {
-            SCX_LOGERROR(m_logHandle, "failed to set HISTIGNORE");
-        }
-        std::string command = it->second.Str();
+        // A batch is a command and the commands after it in the same group;
+        // the commands of a batch run at the same time, the batches in order
+        std::vector<StartedCommand> batch;
+        int batchStart = it->first;
 
-        unsigned int timeout = readConfig ();
-        if (DEFAULT_TIMEOUT != timeout)
+        do
         {
-            std::ostringstream strm;
-            strm << "Timeout value overridden to " << timeout << " seconds";
-            SCX_LOGINFO (m_logHandle, strm.str ());
-        }
+            std::ostringstream st;
+            st << it->first;
+
+            // A command that ran before a restart is not run again, whatever its
+            // exit code; the commands need not be idempotent
+            StartedCommand started;
+            started.m_sequence = it->first;
+            started.m_step = RunOnceCommandConfiguratorComponent + ":" + st.str();
+            started.m_digest = InputDigest().Add(it->second.Str()).Str();
+            started.m_command = it->second.Str();
 
-        int ret = commandExecutor.Execute(SCXCoreLib::StrFromMultibyte(command), 
-                                          RunOnceCommandConfiguratorComponent,
-                                          timeout);
+            if (StatusMessage::Instance().IsCheckpointed(started.m_step, started.m_digest))
+            {
+                SCX_LOGINFO(m_logHandle, "Run-once command item: " + st.str() + " already ran; skipping");
+            }
+            else
+            {
+                SCX_LOGINFO(m_logHandle, "Executing run-once command item: " +
+                            st.str() +
+                            " command: " +
+                            started.m_command);
 
-        if (ret != 0)
+                // The step names the command in the log lines of its output,
+                // which interleave with those of the rest of the batch
+                started.m_pending = CommandExecutor().ExecuteAsync(SCXCoreLib::StrFromMultibyte(started.m_command),
+                                                                   started.m_step,
+                                                                   timeout);
+                batch.push_back(started);
+            }
+
+            ++it;
+        } while (it != commands.end() && SameGroup(groups, batchStart, it->first));
+
+        for (std::vector<StartedCommand>::iterator iter = batch.begin(); iter != batch.end(); ++iter)
         {
-            SCX_LOGERROR(m_logHandle, "Failed Run once command: " + command);
-            exitstatus = 1;
+            int ret = iter->m_pending->Wait();
+
+            std::ostringstream sequence;
+            sequence << iter->m_sequence;
+            std::ostringstream exitCode;
+            exitCode << ret;
+
+            XElementPtr result(new XElement(StatusMessageStrings::RunOnceCommandResult));
+            result->SetAttributeValue(AttributeNameSequence, sequence.str());
+            result->SetAttributeValue(AttributeNameExitCode, exitCode.str());
+            StatusMessage::Instance().AddChildToRoot(result);
+
+            StatusMessage::Instance().AddCheckpoint(iter->m_step, iter->m_digest);
+
+            if (ret != 0)
+            {
+                SCX_LOGERROR(m_logHandle, "Failed Run once command: " + iter->m_command);
+                exitstatus = 1;
+            }
         }
     }
 
@@ -36,6 +36,7 @@
 
 #include <util/Unicode.h>
 
+#include <configuratornames.h>
 #include <osconfigurator.h>
 #include <util/LogHandleCache.h>
 
@@ -91,12 +92,45 @@ namespace VMM
 
                 /*----------------------------------------------------------------------------*/
                 /**
-                   Function that executes the run-once commands
+                   Name of the configurator
+
+                   \return     Configurator name
+                */
+                inline std::string GetName() const
+                {
+                    return ConfiguratorNames::RunOnce;
+                }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Configurators that have to complete before this one runs
+
+                   \param  dependencies    Receives the configurator names
+                */
+                inline void GetDependencies(std::vector<std::string>& dependencies) const
+                {
+                    // Commands expect the rest of the specialization to be applied
+                    dependencies.push_back(ConfiguratorNames::TimeZone);
+                    dependencies.push_back(ConfiguratorNames::HostDomain);
+                    dependencies.push_back(ConfiguratorNames::Users);
+                    dependencies.push_back(ConfiguratorNames::Network);
+                }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Function that executes the run-once commands in sequence order;
+                   commands adjacent in that order with the same group run concurrently
+
+                   \param  commands        Commands by sequence
+                   \param  groups          Group of each command that has one, by sequence
+                   \param  maxConcurrent   Most commands to run at once; 0 for the default
 
                    \return     None
 
                 */
-                void Execute(const std::map<int, SCX::Util::Utf8String>& commands);
+                void Execute(const std::map<int, SCX::Util::Utf8String>& commands,
+                             const std::map<int, SCX::Util::Utf8String>& groups,
+                             unsigned int maxConcurrent);
 
 
             }; // End of RunOnceCommandConfigurator class
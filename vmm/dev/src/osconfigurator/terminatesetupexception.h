@@ -0,0 +1,90 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        terminatesetupexception.h
+
+   \brief       Exception a configurator throws to end the setup
+
+   \date        10-18-2026 14:05:12
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef TERMINATESETUPEXCEPTION_H
+#define TERMINATESETUPEXCEPTION_H
+
+#include <scxcorelib/scxexception.h>
+
+namespace VMM
+{
+
+    namespace GuestAgent
+    {
+
+        namespace OSConfigurator
+        {
+
+            /*----------------------------------------------------------------------------*/
+            /**
+               Thrown by a configurator, in place of calling ISOFetcher::TerminateSetup()
+               on a worker thread, once the setup is complete or cannot go on.  The
+               ConfiguratorScheduler starts no more configurators and calls
+               TerminateSetup() on its own thread when the running ones are done.
+
+            */
+            class TerminateSetupException : public SCXCoreLib::SCXException
+            {
+
+            public:
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Construct a TerminateSetupException object
+
+                   \param [in] message reason the setup ends
+                */
+                TerminateSetupException(const std::wstring& message)
+                    : m_message(message) {}
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Implementation of What from SCXException
+
+                   \return The Message string
+                */
+                std::wstring What() const
+                {
+                    return m_message;
+                }
+
+            private:
+
+                /** Exception message */
+                std::wstring m_message;
+
+            }; // End of TerminateSetupException class
+
+        } // End of OSConfigurator namespace
+
+    } // End of GuestAgent
+
+} // End of VMM
+
+#endif /* TERMINATESETUPEXCEPTION_H */
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -0,0 +1,237 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        timezoneconfigurator.cpp
+
+   \brief       This class provides an abstraction layer to configure the time zone
+                based on the values provided in the XML file
+
+   \date        10-18-2026 15:42:10
+
+*/
+/*----------------------------------------------------------------------------*/
+#include <timezoneconfigurator.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include <limits.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <argumentmanager.h>
+
+using VMM::GuestAgent::OSConfigurator::TimeZoneConfigurator;
+using VMM::GuestAgent::Utilities::ArgumentManager;
+
+namespace
+{
+
+/** Zoneinfo files of a Windows time zone index, as listed in the tztable script file */
+struct TimeZoneEntry
+{
+    int         m_id;        //!< Windows time zone index
+    const char* m_primary;   //!< Zoneinfo file, relative to the zoneinfo directory
+    const char* m_alternate; //!< Zoneinfo file used if the primary one is missing, or 0
+};
+
+TimeZoneEntry const TIME_ZONES[] =
+{
+    { 0, "GMT", 0 },
+    { 1, "Pacific/Samoa", 0 },
+    { 2, "HST", 0 },
+    { 3, "US/Alaska", 0 },
+    { 4, "US/Pacific", 0 },
+    { 5, "Mexico/BajaNorte", 0 },
+    { 10, "MST", 0 },
+    { 13, "Mexico/BajaSur", 0 },
+    { 15, "US/Mountain", 0 },
+    { 20, "US/Central", 0 },
+    { 25, "Canada/Central", 0 },
+    { 30, "Mexico/General", 0 },
+    { 33, "America/Guatemala", 0 },
+    { 35, "EST", 0 },
+    { 40, "US/Eastern", 0 },
+    { 41, "America/Caracas", 0 },
+    { 45, "America/Bogota", 0 },
+    { 46, "America/Asuncion", 0 },
+    { 47, "Brazil/Acre", 0 },
+    { 50, "Canada/Atlantic", 0 },
+    { 55, "America/Caracas", 0 },
+    { 56, "America/Santiago", 0 },
+    { 60, "Canada/Newfoundland", 0 },
+    { 65, "Brazil/East", 0 },
+    { 66, "America/Buenos_Aires", 0 },
+    { 67, "America/Montevideo", 0 },
+    { 70, "America/Buenos_Aires", 0 },
+    { 73, "America/Godthab", 0 },
+    { 75, "America/Noronha", 0 },
+    { 80, "Atlantic/Azores", 0 },
+    { 83, "Atlantic/Cape_Verde", 0 },
+    { 85, "GMT", 0 },
+    { 90, "Greenwich", 0 },
+    { 91, "Africa/Casablanca", 0 },
+    { 95, "CET", 0 },
+    { 100, "CST6CDT", 0 },
+    { 105, "Europe/Brussels", 0 },
+    { 110, "WET", 0 },
+    { 113, "Africa/Bangui", 0 },
+    { 115, "EET", 0 },
+    { 120, "Egypt", 0 },
+    { 125, "Europe/Kiev", 0 },
+    { 130, "Europe/Istanbul", 0 },
+    { 131, "Europe/Istanbul", 0 },
+    { 132, "Africa/Windhoek", 0 },
+    { 133, "Europe/Istanbul", 0 },
+    { 135, "Israel", 0 },
+    { 140, "Africa/Johannesburg", 0 },
+    { 145, "Europe/Moscow", 0 },
+    { 150, "Asia/Riyadh", 0 },
+    { 155, "Africa/Nairobi", 0 },
+    { 156, "Asia/Tbilisi", 0 },
+    { 158, "Asia/Baghdad", 0 },
+    { 160, "Asia/Tehran", 0 },
+    { 165, "Asia/Muscat", 0 },
+    { 166, "Indian/Mauritius", 0 },
+    { 167, "Asia/Baku", 0 },
+    { 170, "Asia/Baku", 0 },
+    { 175, "Asia/Kabul", 0 },
+    { 180, "Asia/Yekaterinburg", 0 },
+    { 185, "Asia/Karachi", 0 },
+    { 186, "Asia/Karachi", 0 },
+    { 190, "Asia/Kolkata", "Asia/Calcutta" },
+    { 193, "Asia/Kathmandu", "Asia/Katmandu" },
+    { 195, "Asia/Dhaka", 0 },
+    { 200, "Asia/Colombo", 0 },
+    { 201, "Asia/Novosibirsk", 0 },
+    { 203, "Asia/Rangoon", 0 },
+    { 205, "Asia/Bangkok", 0 },
+    { 207, "Asia/Krasnoyarsk", 0 },
+    { 210, "Asia/Beijing", "Asia/Shanghai" },
+    { 215, "Asia/Singapore", 0 },
+    { 220, "Asia/Taipei", 0 },
+    { 225, "Australia/Perth", 0 },
+    { 227, "Asia/Ulaanbaatar", 0 },
+    { 230, "Asia/Seoul", 0 },
+    { 235, "Asia/Tokyo", 0 },
+    { 240, "Asia/Yakutsk", 0 },
+    { 245, "Australia/Darwin", 0 },
+    { 250, "Australia/Adelaide", 0 },
+    { 255, "Australia/Sydney", 0 },
+    { 260, "Australia/Brisbane", 0 },
+    { 265, "Australia/Hobart", 0 },
+    { 270, "Asia/Vladivostok", 0 },
+    { 275, "Pacific/Guam", 0 },
+    { 280, "Asia/Magadan", 0 },
+    { 285, "Pacific/Fiji", 0 },
+    { 290, "Pacific/Auckland", 0 },
+    { 291, "Asia/Kamchatka", 0 },
+    { 300, "Pacific/Tongatapu", 0 },
+};
+
+char const ZONE_DIR[] = "/usr/share/zoneinfo";
+char const LOCALTIME[] = "/etc/localtime";
+
+inline bool
+IsFile(
+    const std::string& path)
+{
+    struct stat st;
+    return 0 == stat(path.c_str(), &st) && S_ISREG(st.st_mode);
+}
+
+inline const TimeZoneEntry*
+FindTimeZone(
+    int id)
+{
+    for (size_t i = 0; i < sizeof(TIME_ZONES) / sizeof(TIME_ZONES[0]); ++i)
+    {
+        if (id == TIME_ZONES[i].m_id)
+        {
+            return &TIME_ZONES[i];
+        }
+    }
+
+    return 0;
+}
+
+}
+
+void TimeZoneConfigurator::Execute(const int& timezoneID)
+{
+    SCX_LOGINFO(m_logHandle, ("Executing time zone configuration"));
+
+    const TimeZoneEntry* entry = FindTimeZone(timezoneID);
+    if (0 == entry)
+    {
+        std::ostringstream oss;
+        oss << "Unknown time zone id " << timezoneID << ", time zone not set";
+        SCX_LOGWARNING(m_logHandle, oss.str());
+        return;
+    }
+
+    const std::string rootDir = ArgumentManager::Instance().GetRootDir();
+    std::string zonePath = std::string(ZONE_DIR) + "/" + entry->m_primary;
+    if (!IsFile(rootDir + zonePath))
+    {
+        if (0 == entry->m_alternate)
+        {
+            SCX_LOGWARNING(m_logHandle, "Unable to locate time zone file " + zonePath);
+            return;
+        }
+
+        SCX_LOGINFO(m_logHandle, "Primary path " + zonePath + " not found, using alternate path");
+        zonePath = std::string(ZONE_DIR) + "/" + entry->m_alternate;
+        if (!IsFile(rootDir + zonePath))
+        {
+            SCX_LOGWARNING(m_logHandle, "Unable to locate time zone file " + zonePath);
+            return;
+        }
+    }
+
+    // Build the new link beside /etc/localtime and rename it over the old one, so
+    // there is no moment without a valid /etc/localtime
+    const std::string localtime = rootDir + LOCALTIME;
+    const std::string tempLink = localtime + ".tmp";
+    unlink(tempLink.c_str());
+    if (0 != symlink(zonePath.c_str(), tempLink.c_str()) ||
+        0 != rename(tempLink.c_str(), localtime.c_str()))
+    {
+        SCX_LOGWARNING(m_logHandle, "Failed to link " + std::string(LOCALTIME) + " to " + zonePath +
+                       ": " + strerror(errno));
+        unlink(tempLink.c_str());
+        return;
+    }
+
+    std::vector<char> target(PATH_MAX + 1);
+    ssize_t length = readlink(localtime.c_str(), &target[0], PATH_MAX);
+    if (length < 0 || zonePath != std::string(&target[0], length))
+    {
+        SCX_LOGWARNING(m_logHandle, "Link of " + zonePath + " to " + std::string(LOCALTIME) + " failed");
+        return;
+    }
+
+    SCX_LOGINFO(m_logHandle, "Time zone successfully set to " + zonePath);
+}
+
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
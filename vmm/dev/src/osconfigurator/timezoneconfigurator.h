@@ -20,8 +20,8 @@
 /**
    \file        timezoneconfigurator.h
 
-   \brief       This class provides an abstraction layer to execute time zone configuraiton
-                scripts based on the values provided in the XML file
+   \brief       This class provides an abstraction layer to configure the time zone
+                based on the values provided in the XML file
                 
    \date        06-25-2012 04:46:03
 
@@ -32,13 +32,10 @@
 #ifndef TIMEZONECONFIGURATOR_H
 #define TIMEZONECONFIGURATOR_H
 
-#include <scxcorelib/stringaid.h>
-
 #include <util/LogHandleCache.h>
 
-#include <argumentmanager.h>
+#include <configuratornames.h>
 #include <osconfigurator.h>
-#include <commandexecutor.h>
 
 
 namespace VMM
@@ -72,7 +69,7 @@ namespace VMM
                 TimeZoneConfigurator()
                   : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
                                 "scx.vmmguestagent.osconfigurator.timezoneconfigurator"))
-                  , m_componentName("TimeZone-Configurator")
+                  , m_componentName(ConfiguratorNames::TimeZone)
                 {}
 
                 /*----------------------------------------------------------------------------*/
@@ -97,34 +94,37 @@ namespace VMM
 
                 /*----------------------------------------------------------------------------*/
                 /**
-                   Function that invokes the timezone config script
-
-                   \return     None
+                   Name of the configurator
 
+                   \return     Configurator name
                 */
-                inline void Execute(const int& timezoneID)
+                inline std::string GetName() const
                 {
-                    using VMM::GuestAgent::Utilities::ArgumentManager;
-                    SCX_LOGINFO(m_logHandle, ("Executing time zone configuration script"));
-                    
-                    // Construct command
-                    if (setenv("HISTIGNORE", "*", 1) != 0)
-                    {
-                        SCX_LOGERROR(m_logHandle, ("failed to set HISTIGNORE"));
-                    }
-                    std::ostringstream oss;
-                    oss << ArgumentManager::Instance().GetVMMHome() << "/bin/cfgtimezone tzid=" << timezoneID;
-
-                    SCX_LOGINFO(m_logHandle, ("Shell command:") + (oss.str()));
-                    
-                    // Use execute script
-                    VMM::GuestAgent::Utilities::CommandExecutor commandExec;
-                    commandExec.Execute(SCXCoreLib::StrFromMultibyte(oss.str()), 
-                                        m_componentName);
-                    
+                    return m_componentName;
+                }
 
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Configurators that have to complete before this one runs
+
+                   \param  dependencies    Receives the configurator names
+                */
+                inline void GetDependencies(std::vector<std::string>& dependencies) const
+                {
+                    dependencies.push_back(ConfiguratorNames::Pre);
                 }
 
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Point /etc/localtime at the zoneinfo file of the time zone
+
+                   \param      timezoneID    Windows time zone index
+
+                   \return     None
+
+                */
+                void Execute(const int& timezoneID);
+
             }; // End of TimeZoneConfigurator class
 
         } // End of OSConfigurator namespace
@@ -33,13 +33,13 @@
 #include <argumentmanager.h>
 #include <Base64Helper.h>
 #include <commandexecutor.h>
-#include <isofetcher.h>
 #include <statusmessage.h>
 #include <statusmessagestrings.h>
+#include <terminatesetupexception.h>
 
 #include <scxcorelib/stringaid.h>
 
-using VMM::GuestAgent::Fetcher::ISOFetcher;
+using VMM::GuestAgent::OSConfigurator::TerminateSetupException;
 using VMM::GuestAgent::OSConfigurator::UsersConfigurator;
 using VMM::GuestAgent::StatusManager::StatusMessage;
 using VMM::GuestAgent::Utilities::ArgumentManager;
@@ -72,7 +72,7 @@ void UsersConfigurator::Execute(const VMM::GuestAgent::SpecializationReader::OSS
             XElementPtr(new XElement(StatusMessageStrings::SpecializationStatus, 
                                         StatusMessageStrings::SpecializationFailed)));
 
-        ISOFetcher::Instance().TerminateSetup();
+        throw TerminateSetupException(L"Unable to decode password");
     }
 
     std::string decodedPassword(outputBuffer.begin(), outputBuffer.end());
@@ -89,11 +89,6 @@ void UsersConfigurator::Execute(const VMM::GuestAgent::SpecializationReader::OSS
     // Execute command
     if (!command.empty())
     {
-        if (setenv("HISTIGNORE", "*", 1) != 0)
-        {
-            SCX_LOGERROR(m_logHandle, "failed to set HISTIGNORE");
-        }
-
         // Use execute script
         VMM::GuestAgent::Utilities::CommandExecutor commandExec;
         int ret = commandExec.Execute(SCXCoreLib::StrFromMultibyte(command), 
@@ -106,7 +101,7 @@ void UsersConfigurator::Execute(const VMM::GuestAgent::SpecializationReader::OSS
                 XElementPtr(new XElement(StatusMessageStrings::SpecializationStatus, 
                                          StatusMessageStrings::SpecializationFailed)));
 
-            ISOFetcher::Instance().TerminateSetup();
+            throw TerminateSetupException(L"User configuration failed");
         }
         
     }
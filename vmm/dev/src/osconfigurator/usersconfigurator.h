@@ -34,6 +34,7 @@
 #include <scxcorelib/stringaid.h>
 
 #include <util/LogHandleCache.h>
+#include <configuratornames.h>
 #include <osconfigurator.h>
 #include <commandexecutor.h>
 #include <osspecializationreader.h>
@@ -69,7 +70,7 @@ namespace VMM
                 UsersConfigurator()
                   : m_logHandle(SCX::Util::LogHandleCache::Instance().GetLogHandle(
                                 "scx.vmmguestagent.osconfigurator.usersconfigurator"))
-                  , m_componentName("User-Configurator")
+                  , m_componentName(ConfiguratorNames::Users)
                 {}
 
                 /*----------------------------------------------------------------------------*/
@@ -92,6 +93,28 @@ namespace VMM
                     visitor.Visit(this);
                 }
 
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Name of the configurator
+
+                   \return     Configurator name
+                */
+                inline std::string GetName() const
+                {
+                    return m_componentName;
+                }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                   Configurators that have to complete before this one runs
+
+                   \param  dependencies    Receives the configurator names
+                */
+                inline void GetDependencies(std::vector<std::string>& dependencies) const
+                {
+                    dependencies.push_back(ConfiguratorNames::Pre);
+                }
+
                 /*----------------------------------------------------------------------------*/
                 /**
                    Function that invokes the users config script
@@ -29,57 +29,106 @@
 
 #include <osspecializationreader.h>
 #include <osspecializationparserexception.h>
+#include <specializationparser.h>
 
 #include <util/LogHandleCache.h>
 
 
 using namespace std;
 
-using SCX::Util::Xml::XElement;
-using SCX::Util::Xml::XElementList;
-using SCX::Util::Xml::XElementPtr;
 using SCX::Util::Xml::XmlException;
 using SCX::Util::Utf8String;
 
 using VMM::GuestAgent::SpecializationReader::OSSpecializationReader;
+using VMM::GuestAgent::SpecializationReader::SpecializationParser;
 using SCX::Util::LogHandleCache;
 
-const string OSSpecializationReader::sLinuxOSSpecialization   = "LinuxOSSpecialization";
-const string OSSpecializationReader::sAgentVersion            = "AgentVersion";
-const string OSSpecializationReader::sSchemaVersion           = "SchemaVersion";
-const string OSSpecializationReader::sOSConfiguration         = "OSConfiguration";
-const string OSSpecializationReader::sHostName                = "HostName";
-const string OSSpecializationReader::sDomainName              = "DNSDomainName";
-const string OSSpecializationReader::sTimeZone                = "TimeZone";
-const string OSSpecializationReader::sVNetAdapters            = "VNetAdapters";
-const string OSSpecializationReader::sRunOnceCommands         = "RunOnceCommands";
-const string OSSpecializationReader::sRunOnceCommand          = "RunOnceCommand";
 const string OSSpecializationReader::sCommandSequence         = "Sequence";
-const string OSSpecializationReader::sVNetAdapter             = "VNetAdapter";
-const string OSSpecializationReader::sMACAddress              = "MACAddress";
-const string OSSpecializationReader::sIPV4Property            = "IPV4Property";
-const string OSSpecializationReader::sIPV6Property            = "IPV6Property";
-const string OSSpecializationReader::sStaticIP                = "StaticIP";
+const string OSSpecializationReader::sCommandGroup            = "Group";
+const string OSSpecializationReader::sMaxConcurrency          = "MaxConcurrency";
 const string OSSpecializationReader::sAddressType             = "AddressType";
 const string OSSpecializationReader::sSTATIC                  = "STATIC";
 const string OSSpecializationReader::sDHCP                    = "DHCP";
-const string OSSpecializationReader::sGateways                = "Gateways";
-const string OSSpecializationReader::sGateway                 = "Gateway";
-const string OSSpecializationReader::sAddress                 = "Address";
-const string OSSpecializationReader::sMetric                  = "Metric";
-const string OSSpecializationReader::sNameServers             = "NameServers";
-const string OSSpecializationReader::sNameServer              = "NameServer";
-const string OSSpecializationReader::sUsers                   = "Users";
-const string OSSpecializationReader::sUser                    = "User";
 const string OSSpecializationReader::sRoot                    = "root";
-const string OSSpecializationReader::sUserName                = "UserName";
-const string OSSpecializationReader::sPassword                = "Password";
-const string OSSpecializationReader::sSSHKey                  = "SSHKey";
-const string OSSpecializationReader::sUID                     = "UID";
-const string OSSpecializationReader::sGroupID                 = "GroupID";
-const string OSSpecializationReader::sPrimaryGroup            = "PrimaryGroup";
-const string OSSpecializationReader::sDNSSearchSuffixes       = "DNSSearchSuffixes";
-const string OSSpecializationReader::sDNSSearchSuffix         = "DNSSearchSuffix";
+
+namespace
+{
+    // The elements of the specialization file; a reader switches on these ids.
+    // An element is added with an id here, its name in ELEMENT_NAMES at the same
+    // position and a case in the Read method of its parent.
+    enum Element
+    {
+        eLinuxOSSpecialization,
+        eAgentVersion,
+        eSchemaVersion,
+        eOSConfiguration,
+        eHostName,
+        eDomainName,
+        eTimeZone,
+        eVNetAdapters,
+        eRunOnceCommands,
+        eRunOnceCommand,
+        eVNetAdapter,
+        eMACAddress,
+        eIPV4Property,
+        eIPV6Property,
+        eStaticIP,
+        eGateways,
+        eGateway,
+        eAddress,
+        eMetric,
+        eNameServers,
+        eNameServer,
+        eUsers,
+        eUser,
+        eUserName,
+        ePassword,
+        eSSHKey,
+        eUID,
+        eGroupID,
+        ePrimaryGroup,
+        eDNSSearchSuffixes,
+        eDNSSearchSuffix,
+        eElementCount
+    };
+
+    const char* const ELEMENT_NAMES[eElementCount] =
+    {
+        "LinuxOSSpecialization",
+        "AgentVersion",
+        "SchemaVersion",
+        "OSConfiguration",
+        "HostName",
+        "DNSDomainName",
+        "TimeZone",
+        "VNetAdapters",
+        "RunOnceCommands",
+        "RunOnceCommand",
+        "VNetAdapter",
+        "MACAddress",
+        "IPV4Property",
+        "IPV6Property",
+        "StaticIP",
+        "Gateways",
+        "Gateway",
+        "Address",
+        "Metric",
+        "NameServers",
+        "NameServer",
+        "Users",
+        "User",
+        "UserName",
+        "Password",
+        "SSHKey",
+        "UID",
+        "GroupID",
+        "PrimaryGroup",
+        "DNSSearchSuffixes",
+        "DNSSearchSuffix"
+    };
+
+    const VMM::GuestAgent::SpecializationReader::ElementNameTable g_elementNames(ELEMENT_NAMES, eElementCount);
+}
 
 // log handle at file scope to be visible to nested classes of OSSpecializationReader
 SCXCoreLib::SCXLogHandle g_logHandle;
@@ -101,251 +150,288 @@ bool OSSpecializationReader::GetLinuxOSSpecialization(OSSpecializationReader::Li
     return ret;
 }
 
+const OSSpecializationReader::LinuxOSSpecialization* OSSpecializationReader::GetLinuxOSSpecialization() const
+{
+    const LinuxOSSpecialization* ret = m_specialization.Get();
+
+    if (ret == NULL)
+    {
+        SCX_LOGWARNING(g_logHandle, "GetLinuxOSSpecialization failed: uninitialized LinuxOSSpecialization");
+    }
+
+    return ret;
+}
+
 void OSSpecializationReader::LoadXML(const Utf8String& xmlString)
 {
     SCX_LOGINFO(g_logHandle, "Inside loadXML");
 
     SCXASSERT(!xmlString.Empty());
 
-    m_xmlString = xmlString;
+    SCX_LOGTRACE(g_logHandle, "Begin Loading OSSpecialization object from XML");
+
+    // The elements are read straight into the specialization classes as the
+    // parser comes across them; no document tree is built
+    m_specialization.IsValid() = false;
+    m_specialization.inner() = LinuxOSSpecialization();
 
     try
     {
-        XElement::Load(xmlString, m_pXElementRoot);
+        SpecializationParser parser(xmlString, g_elementNames);
 
-        SCX_LOGTRACE(g_logHandle, "XML Root element successfully loaded in OSSpecializationReader::LoadXML");
+        int root;
+        parser.ReadRoot(root);
+        if (root != eLinuxOSSpecialization)
+        {
+            SCX_LOGERROR(g_logHandle, "Unrecognized XML Root element: " + parser.GetName().Str());
+            throw OSSpecializationParserException(std::string("Unrecognized root element") + ELEMENT_NAMES[eLinuxOSSpecialization]);
+        }
+
+        m_specialization.IsValid() = true;
+        m_specialization.inner().Read(parser);
     }
     catch (XmlException& x)
     {
+        m_specialization.IsValid() = false;
         SCX_LOGERROR(g_logHandle, L"XML Exception: " + x.What());
         return;
     }
 
-    SCX_LOGTRACE(g_logHandle, "Begin Loading OSSpecialization object from XML");
-
-    Load();
-
     SCX_LOGTRACE(g_logHandle, "Completed Loading OSSpecialization object from XML");
 }
 
-void OSSpecializationReader::Load()
+void OSSpecializationReader::ReadStrings(SpecializationParser& parser,
+                                         int element,
+                                         std::vector<Utf8String>& values)
 {
-    if (m_pXElementRoot == NULL)
-    {
-        SCX_LOGERROR(g_logHandle, "OSSpecializationReader::ParseChildNodes, null m_pXElementRoot"); 
-        throw OSSpecializationParserException("null m_pXElementRoot");
-    }
+    values.clear();
 
-    if (m_pXElementRoot->GetName().Str() != sLinuxOSSpecialization)
+    int child;
+    while (parser.ReadChild(child))
     {
-        SCX_LOGERROR(g_logHandle, "Unrecognized XML Root element: " + m_pXElementRoot->GetName().Str());
-        throw OSSpecializationParserException("Unrecognized root element" + sLinuxOSSpecialization);
-    }
+        if (child == element)
+        {
+            values.push_back(Utf8String());
+            parser.ReadContent(values.back());
 
-    m_specialization.IsValid() = true;
-    m_specialization.inner().Read(m_pXElementRoot);
+            SCX_LOGTRACE(g_logHandle, parser.GetName().Str() + " read as: " + values.back().Str());
+        }
+        else
+        {
+            SCX_LOGERROR(g_logHandle, std::string("invalid tag encountered while reading ") + ELEMENT_NAMES[element] + "s: " + parser.GetName().Str());
+            throw OSSpecializationParserException("unexpected tag encountered: " + parser.GetName().Str());
+        }
+    }
 }
 
-void OSSpecializationReader::LinuxOSSpecialization::Read(const XElementPtr& osSpecElementPtr)
+void OSSpecializationReader::LinuxOSSpecialization::Read(SpecializationParser& parser)
 {
-    XElementList xElementList;
-    osSpecElementPtr->GetChildren(xElementList);
-
-    for (XElementList::const_iterator xElementListIter = xElementList.begin();
-        xElementListIter != xElementList.end();
-        xElementListIter++)
+    int element;
+    while (parser.ReadChild(element))
     {
-        XElementPtr xElementPtr = *xElementListIter;
-        Utf8String elementName = xElementPtr->GetName();
-
-        if (elementName == sAgentVersion)
+        switch (element)
         {
-            m_agentVersion = xElementPtr->GetContent();
+        case eAgentVersion:
+            m_agentVersion.IsValid() = true;
+            parser.ReadContent(m_agentVersion.inner());
 
-            SCX_LOGTRACE(g_logHandle, "Agent Version read as: " + xElementPtr->GetContent().Str());
-        }
-        else if (elementName == sSchemaVersion)
-        {
-            m_schemaVersion = xElementPtr->GetContent();
+            SCX_LOGTRACE(g_logHandle, "Agent Version read as: " + m_agentVersion.inner().Str());
+            break;
 
-            SCX_LOGTRACE(g_logHandle, "Schema Version read as: " + xElementPtr->GetContent().Str());
-        }
-        else if (elementName == sOSConfiguration)
-        {
+        case eSchemaVersion:
+            m_schemaVersion.IsValid() = true;
+            parser.ReadContent(m_schemaVersion.inner());
+
+            SCX_LOGTRACE(g_logHandle, "Schema Version read as: " + m_schemaVersion.inner().Str());
+            break;
+
+        case eOSConfiguration:
             m_osConfiguration.IsValid() = true;
-            m_osConfiguration.inner().Read(xElementPtr);
+            m_osConfiguration.inner().Read(parser);
 
             SCX_LOGTRACE(g_logHandle, "Read of OS Configuration complete.");
-        }
-        else
-        {
-            SCX_LOGERROR(g_logHandle, "Unexpected tag encountered in LinuxOSSpecialization :" + elementName.Str());
-            throw OSSpecializationParserException("unexpected tag encountered: " + elementName.Str());
+            break;
+
+        default:
+            SCX_LOGERROR(g_logHandle, "Unexpected tag encountered in LinuxOSSpecialization :" + parser.GetName().Str());
+            throw OSSpecializationParserException("unexpected tag encountered: " + parser.GetName().Str());
         }
     }
 }
 
-void OSSpecializationReader::OSConfiguration::Read(const XElementPtr& osConfigElementPtr)
+void OSSpecializationReader::OSConfiguration::Read(SpecializationParser& parser)
 {
-    XElementList xElementList;
-    osConfigElementPtr->GetChildren(xElementList);
-
-    for (XElementList::const_iterator xElementListIter = xElementList.begin();
-        xElementListIter != xElementList.end();
-        xElementListIter++)
+    int element;
+    while (parser.ReadChild(element))
     {
-        XElementPtr xElementPtr = *xElementListIter;
-        Utf8String elementName = xElementPtr->GetName();
-
-        if (elementName == sHostName)
+        switch (element)
         {
-            m_hostName = xElementPtr->GetContent();
+        case eHostName:
+            m_hostName.IsValid() = true;
+            parser.ReadContent(m_hostName.inner());
 
-            SCX_LOGTRACE(g_logHandle, "Host Name read as: " + xElementPtr->GetContent().Str());
-        }
-        else if (elementName == sDomainName)
-        {
-            m_domainName = xElementPtr->GetContent();
+            SCX_LOGTRACE(g_logHandle, "Host Name read as: " + m_hostName.inner().Str());
+            break;
 
-            //SCX_LOGTRACE(g_logHandle, "Domain Name read as: " + xElementPtr->GetContent());
-        }
-        else if (elementName == sTimeZone)
+        case eDomainName:
+            m_domainName.IsValid() = true;
+            parser.ReadContent(m_domainName.inner());
+
+            //SCX_LOGTRACE(g_logHandle, "Domain Name read as: " + m_domainName.inner());
+            break;
+
+        case eTimeZone:
         {
+            Utf8String content;
+            parser.ReadContent(content);
+
             int val;
-            istringstream ( xElementPtr->GetContent().Str() ) >> val;
+            istringstream ( content.Str() ) >> val;
             m_timeZone = val;
 
-            SCX_LOGTRACE(g_logHandle, "Time Zone read as: " + xElementPtr->GetContent().Str());
+            SCX_LOGTRACE(g_logHandle, "Time Zone read as: " + content.Str());
+            break;
         }
-        else if (elementName == sVNetAdapters)
-        {
-            ReadVNetAdapters(xElementPtr);
+
+        case eVNetAdapters:
+            ReadVNetAdapters(parser);
 
             SCX_LOGTRACE(g_logHandle, "Read of VNet Adapters complete.");
-        }
-        else if (elementName == sRunOnceCommands)
-        {
-            ReadRunOnceCommands(xElementPtr);
+            break;
+
+        case eRunOnceCommands:
+            ReadRunOnceCommands(parser);
 
             SCX_LOGTRACE(g_logHandle, "Read of Run Once Commands complete.");
-        }
-        else if (elementName == sUsers)
-        {
-            ReadRootUser(xElementPtr);
+            break;
+
+        case eUsers:
+            ReadRootUser(parser);
 
             SCX_LOGTRACE(g_logHandle, "Read of Root User complete.");
-        }
-        else
-        {
-            SCX_LOGERROR(g_logHandle, "Unexpected tag encountered in OSConfiguration :" + elementName.Str());
-            throw OSSpecializationParserException("unexpected tag encountered: " + elementName.Str());
+            break;
+
+        default:
+            SCX_LOGERROR(g_logHandle, "Unexpected tag encountered in OSConfiguration :" + parser.GetName().Str());
+            throw OSSpecializationParserException("unexpected tag encountered: " + parser.GetName().Str());
         }
     }
 }
 
-void OSSpecializationReader::OSConfiguration::ReadVNetAdapters(const XElementPtr& vNetAdaptersElementPtr)
+void OSSpecializationReader::OSConfiguration::ReadVNetAdapters(SpecializationParser& parser)
 {
-    XElementList vNetAdaptersElementList;
-    vNetAdaptersElementPtr->GetChildren(vNetAdaptersElementList);
     VNetAdapters.clear();
 
-    for (XElementList::const_iterator vNetAdaptersElementIter = vNetAdaptersElementList.begin();
-         vNetAdaptersElementIter != vNetAdaptersElementList.end();
-         vNetAdaptersElementIter++)
+    int element;
+    while (parser.ReadChild(element))
     {
-        XElementPtr xElementPtr = *vNetAdaptersElementIter;
-
-        Utf8String elementName = xElementPtr->GetName();
-
-        if (elementName == sVNetAdapter)
+        if (element == eVNetAdapter)
         {
-            VNetAdapter val;
-            val.Read(xElementPtr);
-            VNetAdapters.push_back(val);
+            // Read in place rather than copying a finished adapter in
+            VNetAdapters.push_back(VNetAdapter());
+            VNetAdapters.back().Read(parser);
 
             SCX_LOGTRACE(g_logHandle, "Read of VNet Adapter complete.");
         }
         else
         {
-            SCX_LOGERROR(g_logHandle, "invalid tag encountered in ReadVNetAdapters: " + elementName.Str());
-            throw OSSpecializationParserException("unexpected tag encountered: " + elementName.Str());
+            SCX_LOGERROR(g_logHandle, "invalid tag encountered in ReadVNetAdapters: " + parser.GetName().Str());
+            throw OSSpecializationParserException("unexpected tag encountered: " + parser.GetName().Str());
         }
     }
 }
 
-void OSSpecializationReader::OSConfiguration::ReadRunOnceCommands(const XElementPtr& runOnceCommandsElementPtr)
+void OSSpecializationReader::OSConfiguration::ReadRunOnceCommands(SpecializationParser& parser)
 {
-    XElementList runOnceCommandsElementList;
-    runOnceCommandsElementPtr->GetChildren(runOnceCommandsElementList);
-
-    for (XElementList::const_iterator runOnceCommandsElementIter = runOnceCommandsElementList.begin();
-         runOnceCommandsElementIter != runOnceCommandsElementList.end();
-         runOnceCommandsElementIter++)
+    Utf8String maxConcurrency;
+    if (parser.GetAttribute(sMaxConcurrency, maxConcurrency))
     {
-        XElementPtr xElementPtr = *runOnceCommandsElementIter;
-
-        Utf8String elementName = xElementPtr->GetName();
+        unsigned int val = 0;
+        istringstream ( maxConcurrency.Str() ) >> val;
+        if (val > 0)
+        {
+            m_maxConcurrentCommands = val;
+        }
+        else
+        {
+            SCX_LOGERROR(g_logHandle, "invalid MaxConcurrency attribute ignored in ReadRunOnceCommands: " + maxConcurrency.Str());
+        }
+    }
 
-        if (elementName == sRunOnceCommand)
+    int element;
+    while (parser.ReadChild(element))
+    {
+        if (element == eRunOnceCommand)
         {
             Utf8String sSequenceVal;
 
-            if (xElementPtr->GetAttributeValue(sCommandSequence, sSequenceVal))
+            if (parser.GetAttribute(sCommandSequence, sSequenceVal))
             {
                 int sequenceVal;
                 istringstream ( sSequenceVal.Str() ) >> sequenceVal;
 
+                // Read before the content; the attributes are those of the last start tag
+                Utf8String group;
+                bool hasGroup = parser.GetAttribute(sCommandGroup, group);
+
+                Utf8String command;
+                parser.ReadContent(command);
+
                 if (RunOnceCommands.find(sequenceVal) == RunOnceCommands.end())
                 {
-                    RunOnceCommands[sequenceVal] = xElementPtr->GetContent();
+                    RunOnceCommands[sequenceVal].swap(command);
+                    if (hasGroup)
+                    {
+                        RunOnceCommandGroups[sequenceVal].swap(group);
+                    }
 
-                    SCX_LOGTRACE(g_logHandle, "Run Once Command read as: " + xElementPtr->GetContent().Str());
+                    SCX_LOGTRACE(g_logHandle, "Run Once Command read as: " + RunOnceCommands[sequenceVal].Str());
                 }
                 else
                 {
-                    SCX_LOGERROR(g_logHandle, "duplicate Sequence attribute encountered in ReadRunOnceCommands: " + elementName.Str());
+                    SCX_LOGERROR(g_logHandle, "duplicate Sequence attribute encountered in ReadRunOnceCommands: " + parser.GetName().Str());
                 }
             }
             else
             {
-                SCX_LOGERROR(g_logHandle, "required Sequence attribute missing in ReadRunOnceCommands: " + elementName.Str());
+                parser.Skip();
+
+                SCX_LOGERROR(g_logHandle, "required Sequence attribute missing in ReadRunOnceCommands: " + parser.GetName().Str());
             }
         }
         else
         {
-            SCX_LOGERROR(g_logHandle, "invalid tag encountered in ReadRunOnceCommands: " + elementName.Str());
-            throw OSSpecializationParserException("unexpected tag encountered: " + elementName.Str());
+            SCX_LOGERROR(g_logHandle, "invalid tag encountered in ReadRunOnceCommands: " + parser.GetName().Str());
+            throw OSSpecializationParserException("unexpected tag encountered: " + parser.GetName().Str());
         }
     }
 }
 
-void OSSpecializationReader::OSConfiguration::ReadRootUser(const XElementPtr& xElementPtr)
+void OSSpecializationReader::OSConfiguration::ReadRootUser(SpecializationParser& parser)
 {
-    XElementList usersElementList;
-    xElementPtr->GetChildren(usersElementList);
     m_root.IsValid() = false;
 
-	for (XElementList::const_iterator usersElementIter = usersElementList.begin();
-		usersElementIter != usersElementList.end();
-		usersElementIter++)
-	{
-		XElementPtr userNameElement;
-		XElementPtr xElementPtr = *usersElementIter;
-
-        if (xElementPtr->GetName().Str() != sUser)
+    int element;
+    while (parser.ReadChild(element))
+    {
+        if (element != eUser)
         {
-            SCX_LOGERROR(g_logHandle, "Expecting tag value \"User\", got: " + xElementPtr->GetName().Str());
-            throw OSSpecializationParserException("unexpected tag encountered: " + xElementPtr->GetName().Str());
+            SCX_LOGERROR(g_logHandle, "Expecting tag value \"User\", got: " + parser.GetName().Str());
+            throw OSSpecializationParserException("unexpected tag encountered: " + parser.GetName().Str());
         }
 
-		if (xElementPtr->GetChild(sUserName, userNameElement))
-		{
-			if (userNameElement->GetContent() == sRoot)
-			{
-				m_root.IsValid() = true;
-				m_root.inner().Read(xElementPtr);
-			}
-		}
+        // Only root is kept; which user this is is known once it has been read
+        User user;
+        user.Read(parser);
+
+        Utf8String userName;
+        if (user.GetUserName(userName))
+        {
+            if (userName == sRoot)
+            {
+                m_root = user;
+            }
+        }
         else
         {
             SCX_LOGERROR(
@@ -353,249 +439,174 @@ void OSSpecializationReader::OSConfiguration::ReadRootUser(const XElementPtr& xE
                 L"unexpected tag encountered when looking for value \"Name\"");
             throw OSSpecializationParserException("unexpected tag encountered when looking for value \"Name\"");
         }
-	}
+    }
 }
 
-void OSSpecializationReader::VNetAdapter::Read(const XElementPtr& vNetAdapterElementPtr)
+void OSSpecializationReader::VNetAdapter::Read(SpecializationParser& parser)
 {
-    XElementList xElementList;
-    vNetAdapterElementPtr->GetChildren(xElementList);
-
-    for (XElementList::const_iterator xElementListIter = xElementList.begin();
-        xElementListIter != xElementList.end();
-        xElementListIter++)
+    int element;
+    while (parser.ReadChild(element))
     {
-        XElementPtr xElementPtr = *xElementListIter;
-        Utf8String elementName = xElementPtr->GetName();
-
-        if (elementName == sMACAddress)
+        switch (element)
         {
-            m_macAddress = xElementPtr->GetContent();
+        case eMACAddress:
+            m_macAddress.IsValid() = true;
+            parser.ReadContent(m_macAddress.inner());
 
-            SCX_LOGTRACE(g_logHandle, "MAC Address read as: " + xElementPtr->GetContent().Str());
-        }
-        else if (elementName == sIPV4Property)
-        {
+            SCX_LOGTRACE(g_logHandle, "MAC Address read as: " + m_macAddress.inner().Str());
+            break;
+
+        case eIPV4Property:
             m_ipV4.IsValid() = true;
-            m_ipV4.inner().Read(xElementPtr);
+            m_ipV4.inner().Read(parser);
 
             SCX_LOGTRACE(g_logHandle, "Read of IP V4 address complete.");
-        }
-        else if (elementName == sIPV6Property)
-        {
+            break;
+
+        case eIPV6Property:
             m_ipV6.IsValid() = true;
-            m_ipV6.inner().Read(xElementPtr);
+            m_ipV6.inner().Read(parser);
 
             SCX_LOGTRACE(g_logHandle, "Read of IP V6 address complete.");
-        }
-        else if (elementName == sGateways)
-        {
-            ReadGateways(xElementPtr);
-
-            SCX_LOGTRACE(g_logHandle, "Read of Gateways complete.");
-        }
-        else if (elementName == sNameServers)
-        {
-            XElementList nameServerElementList;
-            xElementPtr->GetChildren(nameServerElementList);
-            NameServers.clear();
-
-            for (XElementList::const_iterator nameServerElementIter = nameServerElementList.begin();
-                 nameServerElementIter != nameServerElementList.end();
-                 nameServerElementIter++)
-            {
-                xElementPtr = *nameServerElementIter;
+            break;
 
-                Utf8String elementName = xElementPtr->GetName();
+        case eGateways:
+            ReadGateways(parser);
 
-                if (elementName == sNameServer)
-                {
-                    NameServers.push_back(xElementPtr->GetContent());
-
-                    SCX_LOGTRACE(g_logHandle, "Name Server read as: " + xElementPtr->GetContent().Str());
-                }
-                else
-                {
-                    SCX_LOGERROR(g_logHandle, "invalid tag encountered while reading NameServers: " + elementName.Str());
-                    throw OSSpecializationParserException("unexpected tag encountered: " + elementName.Str());
-                }
-            }
-        }
-        else if (elementName == sDNSSearchSuffixes)
-        {
-            XElementList dnsSearchSuffixElementList;
-            xElementPtr->GetChildren(dnsSearchSuffixElementList);
-            DNSSearchSuffixes.clear();
-
-            for (XElementList::const_iterator dnsSearchSuffixElementIter = dnsSearchSuffixElementList.begin();
-                 dnsSearchSuffixElementIter != dnsSearchSuffixElementList.end();
-                 dnsSearchSuffixElementIter++)
-            {
-                xElementPtr = *dnsSearchSuffixElementIter;
+            SCX_LOGTRACE(g_logHandle, "Read of Gateways complete.");
+            break;
 
-                Utf8String elementName = xElementPtr->GetName();
+        case eNameServers:
+            ReadStrings(parser, eNameServer, NameServers);
+            break;
 
-                if (elementName == sDNSSearchSuffix)
-                {
-                    DNSSearchSuffixes.push_back(xElementPtr->GetContent());
+        case eDNSSearchSuffixes:
+            ReadStrings(parser, eDNSSearchSuffix, DNSSearchSuffixes);
+            break;
 
-                    SCX_LOGTRACE(g_logHandle, "DNS Search Suffix read as: " + xElementPtr->GetContent().Str());
-                }
-                else
-                {
-                    SCX_LOGERROR(g_logHandle, "invalid tag encountered while reading DNSSearchSuffixes: " + elementName.Str());
-                    throw OSSpecializationParserException("unexpected tag encountered: " + elementName.Str());
-                }
-            }
-        }
-        else
-        {
-            SCX_LOGERROR(g_logHandle, "invalid tag encountered in ReadRunOnceCommands: " + elementName.Str());
-            throw OSSpecializationParserException("unexpected tag encountered: " + elementName.Str());
+        default:
+            SCX_LOGERROR(g_logHandle, "invalid tag encountered in ReadRunOnceCommands: " + parser.GetName().Str());
+            throw OSSpecializationParserException("unexpected tag encountered: " + parser.GetName().Str());
         }
     }
 }
 
-void OSSpecializationReader::VNetAdapter::ReadGateways(const XElementPtr& gatewaysElementPtr)
+void OSSpecializationReader::VNetAdapter::ReadGateways(SpecializationParser& parser)
 {
-    XElementList gatewaysElementList;
-    gatewaysElementPtr->GetChildren(gatewaysElementList);
     Gateways.clear();
 
-    for (XElementList::const_iterator gatewaysElementIter = gatewaysElementList.begin();
-         gatewaysElementIter != gatewaysElementList.end();
-         gatewaysElementIter++)
+    int element;
+    while (parser.ReadChild(element))
     {
-        XElementPtr xElementPtr = *gatewaysElementIter;
-
-        Utf8String elementName = xElementPtr->GetName();
-
-        if (elementName == sGateway)
+        if (element == eGateway)
         {
-            Gateway val;
-            val.Read(xElementPtr);
-            Gateways.push_back(val);
+            Gateways.push_back(Gateway());
+            Gateways.back().Read(parser);
 
             SCX_LOGTRACE(g_logHandle, "Read of Gateway complete.");
         }
         else
         {
-            SCX_LOGERROR(g_logHandle, "invalid tag encountered within ReadGateways: " + elementName.Str());
-            throw OSSpecializationParserException("unexpected tag encountered: " + elementName.Str());
+            SCX_LOGERROR(g_logHandle, "invalid tag encountered within ReadGateways: " + parser.GetName().Str());
+            throw OSSpecializationParserException("unexpected tag encountered: " + parser.GetName().Str());
         }
     }
 }
 
-void OSSpecializationReader::User::Read(const XElementPtr& userElementPtr)
+void OSSpecializationReader::User::Read(SpecializationParser& parser)
 {
-    XElementList xElementList;
-    userElementPtr->GetChildren(xElementList);
-
-    for (XElementList::const_iterator xElementListIter = xElementList.begin();
-        xElementListIter != xElementList.end();
-        xElementListIter++)
+    int element;
+    while (parser.ReadChild(element))
     {
-        XElementPtr xElementPtr = *xElementListIter;
-        Utf8String elementName = xElementPtr->GetName();
-
-        if (elementName == sUserName)
+        switch (element)
         {
-            m_userName = xElementPtr->GetContent();
+        case eUserName:
+            m_userName.IsValid() = true;
+            parser.ReadContent(m_userName.inner());
 
-            SCX_LOGTRACE(g_logHandle, "User Name read as: " + xElementPtr->GetContent().Str());
-        }
-        else if (elementName == sPassword)
-        {
-            m_password = xElementPtr->GetContent();
+            SCX_LOGTRACE(g_logHandle, "User Name read as: " + m_userName.inner().Str());
+            break;
+
+        case ePassword:
+            m_password.IsValid() = true;
+            parser.ReadContent(m_password.inner());
 
             SCX_LOGTRACE(g_logHandle, "Password read.");
-        }
-        else if (elementName == sSSHKey)
-        {
-            m_sshKey = xElementPtr->GetContent();
+            break;
+
+        case eSSHKey:
+            m_sshKey.IsValid() = true;
+            parser.ReadContent(m_sshKey.inner());
 
             SCX_LOGTRACE(g_logHandle, "SSH Key read.");
-        }
-	    else if (elementName == sUID)
-	    {
-		    m_UID = xElementPtr->GetContent();
-
-		    SCX_LOGTRACE(g_logHandle, "UID read as: " + xElementPtr->GetContent().Str());
-	    }
-	    else if (elementName == sGroupID)
-	    {
-		    m_groupID = xElementPtr->GetContent();
-
-		    SCX_LOGTRACE(g_logHandle, "Group ID read as: " + xElementPtr->GetContent().Str());
-	    }
-	    else if (elementName == sPrimaryGroup)
-	    {
-		    m_primaryGroup = xElementPtr->GetContent();
-
-		    SCX_LOGTRACE(g_logHandle, "Primary Group read as: " + xElementPtr->GetContent().Str());
-	    }
-        else
-        {
-            SCX_LOGERROR(g_logHandle, "invalid tag encountered within User::Read: " + elementName.Str());
-            throw OSSpecializationParserException("unexpected tag encountered: " + elementName.Str());
+            break;
+
+        case eUID:
+            m_UID.IsValid() = true;
+            parser.ReadContent(m_UID.inner());
+
+            SCX_LOGTRACE(g_logHandle, "UID read as: " + m_UID.inner().Str());
+            break;
+
+        case eGroupID:
+            m_groupID.IsValid() = true;
+            parser.ReadContent(m_groupID.inner());
+
+            SCX_LOGTRACE(g_logHandle, "Group ID read as: " + m_groupID.inner().Str());
+            break;
+
+        case ePrimaryGroup:
+            m_primaryGroup.IsValid() = true;
+            parser.ReadContent(m_primaryGroup.inner());
+
+            SCX_LOGTRACE(g_logHandle, "Primary Group read as: " + m_primaryGroup.inner().Str());
+            break;
+
+        default:
+            SCX_LOGERROR(g_logHandle, "invalid tag encountered within User::Read: " + parser.GetName().Str());
+            throw OSSpecializationParserException("unexpected tag encountered: " + parser.GetName().Str());
         }
     }
 }
 
-void OSSpecializationReader::Gateway::Read(const XElementPtr& gatewayPtr)
+void OSSpecializationReader::Gateway::Read(SpecializationParser& parser)
 {
-    XElementList xElementList;
-    gatewayPtr->GetChildren(xElementList);
-
-    for (XElementList::const_iterator xElementListIter = xElementList.begin();
-        xElementListIter != xElementList.end();
-        xElementListIter++)
+    int element;
+    while (parser.ReadChild(element))
     {
-        XElementPtr xElementPtr = *xElementListIter;
-        Utf8String elementName = xElementPtr->GetName();
-
-        if (elementName == sAddress)
+        switch (element)
         {
-            m_address = xElementPtr->GetContent();
+        case eAddress:
+            m_address.IsValid() = true;
+            parser.ReadContent(m_address.inner());
 
-            SCX_LOGTRACE(g_logHandle, "Gateway Address read as: " + xElementPtr->GetContent().Str());
-        }
-        else if (elementName == sMetric)
-        {
-            m_metric = xElementPtr->GetContent();
+            SCX_LOGTRACE(g_logHandle, "Gateway Address read as: " + m_address.inner().Str());
+            break;
 
-            SCX_LOGTRACE(g_logHandle, "Gateway Metric read as: " + xElementPtr->GetContent().Str());
-        }
-        else
-        {
-            SCX_LOGERROR(g_logHandle, "invalid tag encountered within Gateway::Read: " + elementName.Str());
-            throw OSSpecializationParserException("unexpected tag encountered: " + elementName.Str());
+        case eMetric:
+            m_metric.IsValid() = true;
+            parser.ReadContent(m_metric.inner());
+
+            SCX_LOGTRACE(g_logHandle, "Gateway Metric read as: " + m_metric.inner().Str());
+            break;
+
+        default:
+            SCX_LOGERROR(g_logHandle, "invalid tag encountered within Gateway::Read: " + parser.GetName().Str());
+            throw OSSpecializationParserException("unexpected tag encountered: " + parser.GetName().Str());
         }
     }
 }
 
-void OSSpecializationReader::NetworkProperties::Read(const XElementPtr& netPropElementPtr)
+void OSSpecializationReader::NetworkProperties::Read(SpecializationParser& parser)
 {    
     Utf8String addressType;
-    if (netPropElementPtr->GetAttributeValue(sAddressType, addressType))
+    if (parser.GetAttribute(sAddressType, addressType))
     {
         if (addressType == sSTATIC)
         {
             m_isStatic = true;
 
             SCX_LOGTRACE(g_logHandle, "IP Address is STATIC");
-
-            XElementPtr xElementPtr;
-            if (netPropElementPtr->GetChild(sStaticIP, xElementPtr))
-            {
-                XElementPtr val;
-                if (xElementPtr->GetChild(sAddress, val))
-                {
-                    m_staticIP = val->GetContent();
-
-                    SCX_LOGTRACE(g_logHandle, "Static IP address read as: " + val->GetContent().Str());
-                }
-            }
         }
         else if (addressType == sDHCP)
         {
@@ -609,4 +620,31 @@ void OSSpecializationReader::NetworkProperties::Read(const XElementPtr& netPropE
             throw OSSpecializationParserException("unexpected attribute value encountered: " + addressType.Str());
         }
     }
+
+    // Only the address of a static IP is of interest; everything else is passed over
+    int element;
+    while (parser.ReadChild(element))
+    {
+        if (m_isStatic && element == eStaticIP)
+        {
+            while (parser.ReadChild(element))
+            {
+                if (element == eAddress)
+                {
+                    m_staticIP.IsValid() = true;
+                    parser.ReadContent(m_staticIP.inner());
+
+                    SCX_LOGTRACE(g_logHandle, "Static IP address read as: " + m_staticIP.inner().Str());
+                }
+                else
+                {
+                    parser.Skip();
+                }
+            }
+        }
+        else
+        {
+            parser.Skip();
+        }
+    }
 }
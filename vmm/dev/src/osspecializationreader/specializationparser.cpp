@@ -0,0 +1,213 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+        \file        specializationparser.cpp
+
+        \brief       Pull parser over the specialization file
+
+        \date        10-18-2026 19:20:05
+
+*/
+/*----------------------------------------------------------------------------*/
+
+#include <specializationparser.h>
+
+#include <algorithm>
+
+using SCX::Util::Utf8String;
+using SCX::Util::Xml::CXElement;
+using SCX::Util::Xml::XmlException;
+using SCX::Util::Xml::XML_Type;
+using SCX::Util::Xml::XML_START;
+using SCX::Util::Xml::XML_END;
+using SCX::Util::Xml::XML_CHARS;
+
+using VMM::GuestAgent::SpecializationReader::ElementNameTable;
+using VMM::GuestAgent::SpecializationReader::SpecializationParser;
+
+ElementNameTable::ElementNameTable(const char* const names[], size_t count)
+{
+    m_entries.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_entries.push_back(Entry(Utf8String(names[i]), static_cast<int>(i)));
+    }
+
+    std::sort(m_entries.begin(), m_entries.end(), NameLess);
+}
+
+int ElementNameTable::Find(const Utf8String& name) const
+{
+    // Utf8String's comparisons against text convert the text first; comparing
+    // against the stored strings costs no allocation
+    size_t low = 0;
+    size_t high = m_entries.size();
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        int order = m_entries[middle].first.compare(name);
+        if (0 == order)
+        {
+            return m_entries[middle].second;
+        }
+        if (order < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return UNKNOWN_ELEMENT;
+}
+
+bool ElementNameTable::NameLess(const Entry& left, const Entry& right)
+{
+    return left.first.compare(right.first) < 0;
+}
+
+SpecializationParser::SpecializationParser(const Utf8String& xmlString, const ElementNameTable& names)
+    : m_event(new CXElement()),
+      m_names(names)
+{
+    m_reader.XML_Init();
+    m_reader.XML_SetText(xmlString);
+}
+
+void SpecializationParser::ReadRoot(int& element)
+{
+    XML_Type type = Next();
+    if (XML_START != type)
+    {
+        throw XmlException("expected the root element", m_name);
+    }
+
+    element = m_names.Find(m_name);
+}
+
+bool SpecializationParser::ReadChild(int& element)
+{
+    for (;;)
+    {
+        XML_Type type = Next();
+        if (XML_START == type)
+        {
+            element = m_names.Find(m_name);
+            return true;
+        }
+        if (XML_END == type)
+        {
+            return false;
+        }
+
+        // Text between child elements carries nothing
+    }
+}
+
+bool SpecializationParser::GetAttribute(const std::string& name, Utf8String& value) const
+{
+    int count = m_event->GetAttributeCount();
+    for (int i = 0; i < count; ++i)
+    {
+        if (m_event->GetAttributeName(i) == name)
+        {
+            value = m_event->GetAttributeValue(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void SpecializationParser::ReadContent(Utf8String& content)
+{
+    content.Clear();
+
+    for (;;)
+    {
+        XML_Type type = Next();
+        if (XML_CHARS == type)
+        {
+            content += m_event->GetText();
+        }
+        else if (XML_START == type)
+        {
+            Skip();
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+void SpecializationParser::Skip()
+{
+    size_t depth = 0;
+    for (;;)
+    {
+        XML_Type type = Next();
+        if (XML_START == type)
+        {
+            ++depth;
+        }
+        else if (XML_END == type)
+        {
+            if (0 == depth)
+            {
+                return;
+            }
+            --depth;
+        }
+    }
+}
+
+XML_Type SpecializationParser::Next()
+{
+    for (;;)
+    {
+        // The reader adds the attributes of a start tag to those already there
+        m_event->ClearAttributes();
+
+        int status = m_reader.XML_Next(m_event);
+        if (0 != status)
+        {
+            if (m_reader.XML_GetError())
+            {
+                throw XmlException(m_reader.XML_GetErrorMessage(), m_name);
+            }
+            throw XmlException("unexpected end of document", m_name);
+        }
+
+        XML_Type type = m_event->GetType();
+        if (XML_START == type || XML_END == type || XML_CHARS == type)
+        {
+            if (XML_CHARS != type)
+            {
+                m_name = m_event->GetName();
+            }
+            return type;
+        }
+    }
+}
+
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
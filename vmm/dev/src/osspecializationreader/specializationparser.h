@@ -0,0 +1,204 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+        \file        specializationparser.h
+
+        \brief       Pull parser over the specialization file; hands out the elements
+                     one at a time so that they can be read straight into the
+                     specialization classes, without building a document tree
+
+        \date        10-18-2026 19:20:05
+
+*/
+/*----------------------------------------------------------------------------*/
+#ifndef SPECIALIZATIONPARSER_H
+#define SPECIALIZATIONPARSER_H
+
+#include <string>
+#include <vector>
+
+#include <util/Unicode.h>
+#include <util/XElement.h>
+
+namespace VMM
+{
+    namespace GuestAgent
+    {
+        namespace SpecializationReader
+        {
+            /*----------------------------------------------------------------------------*/
+            /**
+                The element names a document may use, each with a small integer id.
+                Names are looked up once, as the parser comes across them, so that
+                readers dispatch on the id with a switch instead of comparing the
+                name against every element they accept.
+            */
+            class ElementNameTable
+            {
+            public:
+                /** Id of a name that is not in the table */
+                static const int UNKNOWN_ELEMENT = -1;
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                    ElementNameTable constructor
+
+                    \param  names   Element names; the id of a name is its index
+                    \param  count   Number of names
+                */
+                ElementNameTable(const char* const names[], size_t count);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                    Id of an element name
+
+                    \param  name    Element name
+
+                    \return The id, or UNKNOWN_ELEMENT
+                */
+                int Find(const SCX::Util::Utf8String& name) const;
+
+            private:
+                typedef std::pair<SCX::Util::Utf8String, int> Entry;
+
+                /** Orders entries by name */
+                static bool NameLess(const Entry& left, const Entry& right);
+
+                /** Names and ids, sorted by name */
+                std::vector<Entry> m_entries;
+            };
+
+            /*----------------------------------------------------------------------------*/
+            /**
+                Pull parser for the specialization file.  After ReadRoot() or ReadChild()
+                returns an element, the caller consumes all of it with ReadContent(),
+                Skip() or a ReadChild() loop before asking for the next sibling.
+
+                \code
+                    int element;
+                    while (parser.ReadChild(element))
+                    {
+                        switch (element)
+                        {
+                        case eHostName:
+                            parser.ReadContent(hostName);
+                            break;
+                        default:
+                            parser.Skip();
+                        }
+                    }
+                \endcode
+            */
+            class SpecializationParser
+            {
+            public:
+                /*----------------------------------------------------------------------------*/
+                /**
+                    SpecializationParser constructor
+
+                    \param  xmlString   Document to parse; must outlive the parser
+                    \param  names       Element names of the document; must outlive the parser
+                */
+                SpecializationParser(const SCX::Util::Utf8String& xmlString, const ElementNameTable& names);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                    Advance to the root element
+
+                    \param  element     Receives the id of the element name
+
+                    \throws XmlException if the document is malformed or empty
+                */
+                void ReadRoot(int& element);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                    Advance to the next child of the current element
+
+                    \param  element     Receives the id of the element name
+
+                    \return true at a child, false once the current element has ended
+
+                    \throws XmlException if the document is malformed
+                */
+                bool ReadChild(int& element);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                    Name of the element ReadRoot() or ReadChild() advanced to last, for
+                    messages about it
+                */
+                const SCX::Util::Utf8String& GetName() const { return m_name; }
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                    Attribute of the element ReadRoot() or ReadChild() advanced to last
+
+                    \param  name    Attribute name
+                    \param  value   Receives the attribute value
+
+                    \return true if the element has the attribute
+                */
+                bool GetAttribute(const std::string& name, SCX::Util::Utf8String& value) const;
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                    Read the text of the current element through its end; child elements
+                    are skipped
+
+                    \param  content     Receives the text
+
+                    \throws XmlException if the document is malformed
+                */
+                void ReadContent(SCX::Util::Utf8String& content);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                    Skip the rest of the current element
+
+                    \throws XmlException if the document is malformed
+                */
+                void Skip();
+
+            private:
+                /** Intentionally not implemented */
+                SpecializationParser(const SpecializationParser&);
+                SpecializationParser& operator=(const SpecializationParser&);
+
+                /*----------------------------------------------------------------------------*/
+                /**
+                    Advance to the next start tag, end tag or text; comments and
+                    processing instructions are passed over
+                */
+                SCX::Util::Xml::XML_Type Next();
+
+                SCX::Util::Xml::XMLReader   m_reader;
+                SCX::Util::Xml::pCXElement  m_event;
+                const ElementNameTable&     m_names;
+
+                /** Current element name, for error messages */
+                SCX::Util::Utf8String       m_name;
+            };
+
+         } // namespace SpecializationReader
+    } // namespace GuestAgent
+} // namespace VMM
+
+#endif // SPECIALIZATIONPARSER_H
@@ -30,13 +30,23 @@
 /*----------------------------------------------------------------------------*/
 #include <statusmessage.h>
 
+#include <cerrno>
 #include <fstream>
+#include <sstream>
 
+#include <scxcorelib/scxassert.h>
+
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
 
 #include <argumentmanager.h>
+#include <phasetimeline.h>
+#include <statusmessagestrings.h>
 
 using VMM::GuestAgent::StatusManager::StatusMessage;
+using VMM::GuestAgent::StatusManager::StatusMessageStrings;
+using VMM::GuestAgent::Utilities::PhaseTimeline;
 using SCX::Util::Xml::XElementPtr;
 using SCX::Util::Xml::XElement;
 using SCX::Util::Xml::XmlException;
@@ -46,9 +56,17 @@ using SCX::Util::Utf8String;
 const std::string ElementNameOSConfigurationStatusRoot = "OSConfigurationStatus";
 const std::string AttributeNameSchemaVersion           = "SchemaVersion";
 const std::string SchemaVersion                        = "1.1";
+const std::string AttributeNameStep                    = "Step";
+const std::string AttributeNameInputDigest             = "InputDigest";
 
 const std::string StatusDir                            = "status";
 const std::string StatusMessageXml                     = "statusmessage.xml";
+const std::string StatusJournalSuffix                  = ".journal";
+const std::string StatusTempSuffix                     = ".tmp";
+const std::string TimelineJson                         = "timeline.json";
+
+const char JournalSeparator                            = ' ';
+const char JournalTerminator                           = '\n';
 
 std::string StatusMessage::ReadStatusFileAsString()
 {
@@ -76,84 +94,315 @@ std::string StatusMessage::ReadStatusFileAsString()
     
 }
 
+StatusMessage::~StatusMessage()
+{
+    if (m_journalFd >= 0)
+    {
+        close(m_journalFd);
+    }
+}
+
 bool StatusMessage::AddChildToRoot(const XElementPtr& element)
 {
 
     SCX_LOGTRACE(m_logHandle, "Adding child element to root");
 
-    mp_xelementRoot = NULL;
+    SCXCoreLib::SCXThreadLock lock(m_lock);
 
-    std::string xmlString = ReadStatusFileAsString();
+    AddToDocument(element);
 
-    //Let's Load'em up!
-    try
+    // Only the new element is persisted; the status file itself is
+    // rewritten when the journal is compacted
+    std::map<SCXCoreLib::SCXThreadId, CommitGroup>::iterator group =
+        m_commitGroups.find(SCXCoreLib::SCXThread::GetCurrentThreadID());
+    if (m_commitGroups.end() != group)
     {
-        XElement::Load(xmlString,
-                       mp_xelementRoot);
+        AppendRecord(group->second.m_pendingJournal, element);
+        return true;
     }
-    catch (XmlException& x)
+
+    std::string journal;
+    AppendRecord(journal, element);
+    return CommitJournal(journal);
+}
+
+void StatusMessage::BeginCommitGroup()
+{
+    SCXCoreLib::SCXThreadLock lock(m_lock);
+
+    ++m_commitGroups[SCXCoreLib::SCXThread::GetCurrentThreadID()].m_depth;
+}
+
+bool StatusMessage::EndCommitGroup()
+{
+    SCXCoreLib::SCXThreadLock lock(m_lock);
+
+    std::map<SCXCoreLib::SCXThreadId, CommitGroup>::iterator group =
+        m_commitGroups.find(SCXCoreLib::SCXThread::GetCurrentThreadID());
+    SCXASSERT(m_commitGroups.end() != group);
+    if (m_commitGroups.end() == group)
     {
-        SCX_LOGERROR(m_logHandle, L"XML Exception:" + x.What());
-        return false;
+        return true;
+    }
+    if (--group->second.m_depth > 0)
+    {
+        return true;
     }
-    
-    mp_xelementRoot->AddChild(element);
 
-    Write();
-    
-    return true;
+    std::string journal;
+    journal.swap(group->second.m_pendingJournal);
+    m_commitGroups.erase(group);
+    return CommitJournal(journal);
 }
 
 bool StatusMessage::ReadChildOfRoot(const std::string& elementNameIn, 
                                     std::string&       elementValue)
 {
+    SCXCoreLib::SCXThreadLock lock(m_lock);
 
-    // Reset root
-    mp_xelementRoot = NULL;
-    
-    std::string xmlString = ReadStatusFileAsString();
-    SCX_LOGINFO(m_logHandle, ("File read as:") + (xmlString));
+    std::map<std::string, XElementPtr>::const_iterator iter = m_index.find(elementNameIn);
+    if (m_index.end() == iter)
+    {
+        return false;
+    }
 
-    //Let's Load'em up!
-    try
+    elementValue = iter->second->GetContent().Str();
+    return true;
+}
+
+void StatusMessage::Compact()
+{
+    SCXCoreLib::SCXThreadLock lock(m_lock);
+
+    bool written = Write();
+
+    // Whatever is still pending is part of the document just written; if it
+    // was not written, the journal has to hold it instead
+    std::map<SCXCoreLib::SCXThreadId, CommitGroup>::iterator group;
+    for (group = m_commitGroups.begin(); group != m_commitGroups.end(); ++group)
     {
-        XElement::Load(xmlString,
-                       mp_xelementRoot);
+        if (written)
+        {
+            group->second.m_pendingJournal.clear();
+        }
+        else
+        {
+            CommitJournal(group->second.m_pendingJournal);
+        }
     }
-    catch (XmlException& x)
+
+    if (!written)
     {
-        SCX_LOGERROR(m_logHandle, ("XML Exception:") + SCXCoreLib::StrToMultibyte(x.What()));
-        return false;
+        SCX_LOGERROR(m_logHandle, "Status file not written, keeping the status journal");
+        PhaseTimeline::Instance().Flush();
+        return;
+    }
+
+    if (m_journalFd >= 0)
+    {
+        close(m_journalFd);
+        m_journalFd = -1;
+    }
+
+    if (unlink(m_journalFile.c_str()) != 0 && errno != ENOENT)
+    {
+        SCX_LOGERROR(m_logHandle, "Unable to remove status journal errno: " +
+                     SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+    }
+
+    // The agent may be about to go away; keep the timeline up to date with it
+    PhaseTimeline::Instance().Flush();
+}
+
+bool StatusMessage::AddCheckpoint(const std::string& step,
+                                  const std::string& inputDigest)
+{
+    XElementPtr checkpoint(new XElement(StatusMessageStrings::Checkpoint));
+    checkpoint->SetAttributeValue(AttributeNameStep, step);
+    checkpoint->SetAttributeValue(AttributeNameInputDigest, inputDigest);
+
+    SCXCoreLib::SCXThreadLock lock(m_lock);
+
+    AddToDocument(checkpoint);
+
+    // Whatever else the group of the thread has pending happened before the
+    // step completed
+    std::string journal;
+    std::map<SCXCoreLib::SCXThreadId, CommitGroup>::iterator group =
+        m_commitGroups.find(SCXCoreLib::SCXThread::GetCurrentThreadID());
+    if (m_commitGroups.end() != group)
+    {
+        journal.swap(group->second.m_pendingJournal);
+    }
+    AppendRecord(journal, checkpoint);
+    return CommitJournal(journal);
+}
+
+bool StatusMessage::IsCheckpointed(const std::string& step,
+                                   const std::string& inputDigest)
+{
+    SCXCoreLib::SCXThreadLock lock(m_lock);
+
+    std::map<std::string, std::string>::const_iterator iter = m_checkpoints.find(step);
+    return m_checkpoints.end() != iter && iter->second == inputDigest;
+}
+
+void StatusMessage::AddToDocument(const XElementPtr& element)
+{
+    mp_xelementRoot->AddChild(element);
+    IndexElement(element);
+}
+
+void StatusMessage::IndexElement(const XElementPtr& element)
+{
+    std::string name = element->GetName().Str();
+
+    // Lookups return the first element of a name, same as walking the children
+    m_index.insert(std::make_pair(name, element));
+
+    std::string step;
+    std::string inputDigest;
+    if (StatusMessageStrings::Checkpoint == name &&
+        element->GetAttributeValue(AttributeNameStep, step) &&
+        element->GetAttributeValue(AttributeNameInputDigest, inputDigest))
+    {
+        m_checkpoints[step] = inputDigest;
+    }
+}
+
+void StatusMessage::AppendRecord(std::string& journal, const XElementPtr& element)
+{
+    Utf8String xmlString;
+    element->ToString(xmlString, false);
+    std::string xml = xmlString.Str();
+
+    SCX_LOGINFO(m_logHandle, "Journaling status element:" + xml);
+
+    // Length prefixed so that element content may hold new lines, and a record
+    // torn by a crash can be told apart from a complete one
+    std::ostringstream record;
+    record << xml.size() << JournalSeparator << xml << JournalTerminator;
+    journal += record.str();
+}
+
+bool StatusMessage::CommitJournal(std::string& journal)
+{
+    if (journal.empty())
+    {
+        return true;
+    }
+
+    if (m_journalFd < 0)
+    {
+        m_journalFd = open(m_journalFile.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR);
+        if (m_journalFd < 0)
+        {
+            SCX_LOGERROR(m_logHandle, "Unable to open status journal errno: " +
+                         SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+            return false;
+        }
+
+        SyncStatusDir();
     }
 
-    XElementPtr xElementPtr(NULL);
-    XElementList::const_iterator elementIter;
+    // All the records go out in one write and one sync
+    bool committed = WriteAll(m_journalFd, journal) &&
+                     fdatasync(m_journalFd) == 0;
+    if (!committed)
+    {
+        SCX_LOGERROR(m_logHandle, "Unable to write status journal errno: " +
+                     SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+    }
 
-    // Fetch the children elements from the XML string
-    XElementList elementList;
-    mp_xelementRoot->GetChildren(elementList);
+    journal.clear();
+    return committed;
+}
 
-    // Loop through elements and set class member variables appropriately
-    for (elementIter = elementList.begin();
-         elementIter != elementList.end();
-         elementIter++)
+size_t StatusMessage::ReplayJournal()
+{
+    std::ifstream fileStream(m_journalFile.c_str());
+    if (!fileStream.is_open())
     {
+        return 0;
+    }
 
-        xElementPtr = *elementIter;
+    std::ostringstream strStream;
+    strStream << fileStream.rdbuf();
+    std::string journal = strStream.str();
 
-        // Get the current element and its value
-        Utf8String elementName = xElementPtr->GetName();
-        Utf8String elementContent = xElementPtr->GetContent();
-        
-        // Check with the xml tags that are expected and store them in appropriate data members
-        if (elementName.Str() == elementNameIn)
+    size_t replayed = 0;
+    std::string::size_type pos = 0;
+    while (pos < journal.size())
+    {
+        std::string::size_type separator = journal.find(JournalSeparator, pos);
+        if (std::string::npos == separator)
         {
-            elementValue = elementContent.Str();
-            return true;
+            break;
         }
+
+        std::istringstream lengthStream(journal.substr(pos, separator - pos));
+        size_t length = 0;
+        if (!(lengthStream >> length) ||
+            separator + 1 + length >= journal.size() ||
+            journal[separator + 1 + length] != JournalTerminator)
+        {
+            SCX_LOGWARNING(m_logHandle, "Ignoring incomplete status journal record");
+            break;
+        }
+
+        XElementPtr element;
+        try
+        {
+            XElement::Load(journal.substr(separator + 1, length), element);
+            AddToDocument(element);
+            ++replayed;
+        }
+        catch (XmlException& x)
+        {
+            SCX_LOGERROR(m_logHandle, L"XML Exception in status journal:" + x.What());
+        }
+
+        pos = separator + 1 + length + 1;
+    }
+
+    return replayed;
+}
+
+void StatusMessage::Load()
+{
+    std::string xmlString = ReadStatusFileAsString();
+
+    //Let's Load'em up!
+    try
+    {
+        XElement::Load(xmlString,
+                       mp_xelementRoot);
+
+        XElementList elementList;
+        mp_xelementRoot->GetChildren(elementList);
+        for (XElementList::const_iterator elementIter = elementList.begin();
+             elementIter != elementList.end();
+             elementIter++)
+        {
+            IndexElement(*elementIter);
+        }
+    }
+    catch (XmlException& x)
+    {
+        SCX_LOGERROR(m_logHandle, L"XML Exception:" + x.What());
+
+        // Start over rather than failing every status update from here on
+        mp_xelementRoot = NULL;
+        m_index.clear();
+        m_checkpoints.clear();
+        AddRoot();
+    }
+
+    if (ReplayJournal() > 0)
+    {
+        SCX_LOGINFO(m_logHandle, "Status journal replayed, compacting");
+        Compact();
     }
-    
-    return false;
 }
 
 void StatusMessage::AddRoot()
@@ -193,48 +442,98 @@ void StatusMessage::SetUp()
         SCX_LOGINFO(m_logHandle, "Status dir existed from before");
     }
 
-    m_statusFile = installHome + 
-        std::string("/") +  
-        StatusDir  + 
+    m_statusDir = statusDir;
+    m_statusFile = statusDir +
         std::string("/") +  
         StatusMessageXml;
     
+    m_journalFile = m_statusFile + StatusJournalSuffix;
+
+    PhaseTimeline::Instance().SetFile(statusDir + std::string("/") + TimelineJson);
+
     // No file exists. So add root node.
     if (stat(m_statusFile.c_str(), &statBuff) == -1)
     {
         SCX_LOGINFO(m_logHandle, "No status xml files. Adding a new one");
         AddRoot();
+
+        // A journal only makes sense on top of the status file it extends
+        unlink(m_journalFile.c_str());
     }
     else
     {
         SCX_LOGINFO(m_logHandle, "Status XML file exists.");
+        Load();
     }
 
 }
 
-void StatusMessage::Write()
+bool StatusMessage::Write()
 {
+    Utf8String xmlString;
+    mp_xelementRoot->ToString(xmlString, false);
+    std::string data = xmlString.Str();
 
-    std::ofstream fileStream(m_statusFile.c_str(), 
-                             std::ios::out |
-                             std::ios::trunc);
-    if (fileStream.is_open())
+    SCX_LOGINFO(m_logHandle,
+                L"Writing following to file:" + 
+                SCXCoreLib::StrFromMultibyte(data));
+
+    // Write a complete copy next to the status file and move it over the old
+    // one, so a crash leaves either the old or the new document behind
+    std::string tempFile = m_statusFile + StatusTempSuffix;
+    int fd = open(tempFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
     {
+        SCX_LOGINFO(m_logHandle, "Unable to open status file");
+        return false;
+    }
 
-        Utf8String xmlString;
-        mp_xelementRoot->ToString(xmlString, false);
-
-        SCX_LOGINFO(m_logHandle,
-                    L"Writing following to file:" + 
-                    SCXCoreLib::StrFromMultibyte(xmlString.Str()));
+    bool written = WriteAll(fd, data) && fsync(fd) == 0;
+    if (close(fd) != 0)
+    {
+        written = false;
+    }
 
-        fileStream << xmlString.Str();
+    if (!written ||
+        rename(tempFile.c_str(), m_statusFile.c_str()) != 0)
+    {
+        SCX_LOGERROR(m_logHandle, "Unable to write status file errno: " +
+                     SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+        unlink(tempFile.c_str());
+        return false;
     }
-    else
+
+    SyncStatusDir();
+    return true;
+}
+
+bool StatusMessage::WriteAll(int fd, const std::string& data)
+{
+    size_t done = 0;
+    while (done < data.size())
     {
-        SCX_LOGINFO(m_logHandle, "Unable to open status file");
+        ssize_t count = write(fd, data.c_str() + done, data.size() - done);
+        if (count < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        done += static_cast<size_t>(count);
     }
 
-    fileStream.close();
+    return true;
+}
 
+void StatusMessage::SyncStatusDir()
+{
+    // Make renames and newly created files in the status dir durable
+    int fd = open(m_statusDir.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0)
+    {
+        fsync(fd);
+        close(fd);
+    }
 }
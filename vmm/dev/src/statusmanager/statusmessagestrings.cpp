@@ -37,5 +37,8 @@ const char* StatusMessageStrings::SpecializationComplete      =  "Specialization
 const char* StatusMessageStrings::SpecializationFailed        =  "SpecializationFailed";
 const char* StatusMessageStrings::InsmodStatus                =  "InsmodStatus";
 const char* StatusMessageStrings::InsmodCommandComplete       =  "InsmodCommandComplete";
+const char* StatusMessageStrings::ConfiguratorTiming          =  "ConfiguratorTiming";
+const char* StatusMessageStrings::Checkpoint                  =  "Checkpoint";
+const char* StatusMessageStrings::RunOnceCommandResult        =  "RunOnceCommandResult";
 
 /*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/
@@ -42,6 +42,7 @@ namespace
 
 char const VMM_HOME_ENV_VAR[] = "SCVMM_HOME";
 char const VMM_HOME_DEFAULT[] = "/opt/microsoft/scvmmguestagent/";
+char const VMM_ROOT_ENV_VAR[] = "SCVMM_ROOT";
 char const CLI_CONFIG_FILENAME[] = "mntpath=";
 char const USAGE[] = "scvmmguestagent [mntpath=<PATH>]";
 
@@ -52,6 +53,7 @@ char const USAGE[] = "scvmmguestagent [mntpath=<PATH>]";
 ArgumentManager::ArgumentManager()
   : m_vmmHome(VMM_HOME_DEFAULT)
   , m_configFilename()
+  , m_rootDir()
 {
     // empty
 }
@@ -76,6 +78,12 @@ ArgumentManager::LoadArgs(
         m_vmmHome = vmmHomeEnv;
     }
 
+    char const* const vmmRootEnv = getenv(VMM_ROOT_ENV_VAR);
+    if (NULL != vmmRootEnv)
+    {
+        m_rootDir = vmmRootEnv;
+    }
+
     if (2 == argc &&
         0 == strncmp (CLI_CONFIG_FILENAME, argv[1],
                       strlen(CLI_CONFIG_FILENAME)))
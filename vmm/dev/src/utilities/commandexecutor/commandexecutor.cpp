@@ -29,21 +29,34 @@
 */
 /*----------------------------------------------------------------------------*/
 #include <commandexecutor.h>
+#include <phasetimeline.h>
+
+#include <scxcorelib/scxcondition.h>
+#include <scxcorelib/scxprocesssupervisor.h>
+#include <scxcorelib/scxthread.h>
 
 #include <algorithm>
 #include <cctype>
 #include <cerrno>
 #include <climits>
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <vector>
+
+#include <unistd.h>
 
 namespace
 {
 
 size_t const BUFFSIZE = 1024;
 
+VMM::GuestAgent::Utilities::CommandRunner* s_runner = 0;
+
 inline char*
 skipws (
     char* startPos,
@@ -52,6 +65,129 @@ skipws (
     return std::find_if (startPos, endPos, std::not1 (std::ptr_fun (isspace)));
 }
 
+/*----------------------------------------------------------------------------*/
+/**
+   Logs what a command writes, one line at a time.  At most MAXIMUM_OUTPUT_LINE
+   characters are held; longer lines are logged in pieces.
+
+*/
+class OutputLogBuf : public std::streambuf
+{
+public:
+    OutputLogBuf(const SCXCoreLib::SCXLogHandle& logHandle,
+                 const std::string& prefix,
+                 bool isError)
+        : m_logHandle(logHandle)
+        , m_prefix(prefix)
+        , m_isError(isError)
+    {
+        m_line.reserve(VMM::GuestAgent::Utilities::MAXIMUM_OUTPUT_LINE);
+    }
+
+    ~OutputLogBuf()
+    {
+        LogLine();
+    }
+
+    /** Log the last line if it did not end with a newline */
+    void LogLine()
+    {
+        if (!m_line.empty())
+        {
+            if (m_isError)
+            {
+                SCX_LOGERROR(m_logHandle, m_prefix + m_line);
+            }
+            else
+            {
+                SCX_LOGINFO(m_logHandle, m_prefix + m_line);
+            }
+            m_line.clear();
+        }
+    }
+
+protected:
+    int_type overflow(int_type c)
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            return traits_type::not_eof(c);
+        }
+
+        if ('\n' == c)
+        {
+            LogLine();
+        }
+        else
+        {
+            m_line += traits_type::to_char_type(c);
+            if (m_line.size() >= VMM::GuestAgent::Utilities::MAXIMUM_OUTPUT_LINE)
+            {
+                LogLine();
+            }
+        }
+
+        return c;
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n)
+    {
+        for (std::streamsize i = 0; i < n; ++i)
+        {
+            overflow(traits_type::to_int_type(s[i]));
+        }
+
+        return n;
+    }
+
+private:
+    SCXCoreLib::SCXLogHandle m_logHandle;
+    std::string              m_prefix;
+    bool                     m_isError;
+    std::string              m_line;
+};
+
+/*----------------------------------------------------------------------------*/
+/**
+   Log how a command ended
+
+*/
+void
+LogExitStatus(
+    const SCXCoreLib::SCXLogHandle& logHandle,
+    const std::string& component,
+    int exitStatus)
+{
+    if (exitStatus == 0)
+    {
+        // Success
+        SCX_LOGINFO(logHandle, L"Successfully configured " +
+                    SCXCoreLib::StrFromMultibyte(component));
+        
+    }
+    else if (exitStatus == 1)
+    {
+        // Success with warnings
+        SCX_LOGWARNING(logHandle, SCXCoreLib::StrFromMultibyte(component) +
+                       L" completed with warnings");
+    }
+    else if (exitStatus == -1)
+    {
+        // Critical failure
+        SCX_LOGERROR(logHandle, SCXCoreLib::StrFromMultibyte(component) +
+                     L" failed with exitcode:-1");
+    }
+    else
+    {
+        
+        SCX_LOGERROR(logHandle, SCXCoreLib::StrFromMultibyte(component) +
+                     L" failed with other exitcode:");
+        SCX_LOGERROR(
+            logHandle,
+            SCXCoreLib::StrToMultibyte(SCXCoreLib::StrFrom(exitStatus)));
+    }
+}
+
 }
 
 
@@ -65,8 +201,16 @@ namespace Utilities
 unsigned int
 readConfig ()
 {
-    unsigned int timeout = DEFAULT_TIMEOUT;
-    std::fstream configFile (CONFIG_FILE_NAME);
+    return readConfig (CONFIG_FILE_NAME, DEFAULT_TIMEOUT);
+}
+
+unsigned int
+readConfig (
+    char const* fileName,
+    unsigned int const defaultValue)
+{
+    unsigned int timeout = defaultValue;
+    std::fstream configFile (fileName);
     if (configFile.good ())
     {
         char buffer[BUFFSIZE] = "";
@@ -83,38 +227,276 @@ readConfig ()
                 !(ULONG_MAX == val &&
                   ERANGE == errno))
             {
-                if (MINIMUM_TIMEOUT > val)
+                timeout = clampTimeout (val);
+            }
+        }
+    }
+    return timeout;
+}
+
+unsigned int
+clampTimeout (
+    unsigned long const timeoutSecs)
+{
+    if (MINIMUM_TIMEOUT > timeoutSecs)
+    {
+        return MINIMUM_TIMEOUT;
+    }
+    else if (MAXIMUM_TIMEOUT < timeoutSecs)
+    {
+        return MAXIMUM_TIMEOUT;
+    }
+    return static_cast<unsigned int> (timeoutSecs);
+}
+
+/*----------------------------------------------------------------------------*/
+/**
+   A command started by ExecuteAsync().  Once queued, m_exitStatus and m_done
+   are protected by the supervision condition; the rest belongs to the
+   supervisor thread.
+
+*/
+class CommandState
+{
+public:
+    CommandState(const std::wstring& command,
+                 const std::string& component,
+                 unsigned int const timeoutSecs,
+                 const SCXCoreLib::SCXLogHandle& logHandle)
+        : m_command(command)
+        , m_component(component)
+        , m_timeoutSecs(timeoutSecs)
+        , m_stdInStream("")
+        , m_stdOutBuf(logHandle, component + " stdout: ", false)
+        , m_stdErrBuf(logHandle, component + " stderr: ", true)
+        , m_stdOutStream(&m_stdOutBuf)
+        , m_stdErrStream(&m_stdErrBuf)
+        , m_start(0)
+        , m_exitStatus(-1)
+        , m_done(false)
+    {
+    }
+
+    std::wstring                               m_command;       //!< Script to run
+    std::string                                m_component;     //!< Text identifier used in log output
+    unsigned int                               m_timeoutSecs;   //!< Timeout in seconds
+    std::istringstream                         m_stdInStream;   //!< Nothing to send to the script
+    OutputLogBuf                               m_stdOutBuf;     //!< Logs the script's stdout
+    OutputLogBuf                               m_stdErrBuf;     //!< Logs the script's stderr
+    std::ostream                               m_stdOutStream;  //!< Stream over m_stdOutBuf
+    std::ostream                               m_stdErrStream;  //!< Stream over m_stdErrBuf
+    SCXCoreLib::SCXHandle<SCXCoreLib::SCXProcess> m_process;    //!< The script, while it runs
+    scxulong                                   m_start;         //!< Timeline time it was started
+    int                                        m_exitStatus;    //!< Return value, once done
+    bool                                       m_done;          //!< Has the command completed?
+
+private:
+    /** Intentionally not implemented */
+    CommandState(const CommandState&);
+    CommandState& operator=(const CommandState&);
+};
+
+}
+}
+}
+
+using VMM::GuestAgent::Utilities::CommandExecutor;
+using VMM::GuestAgent::Utilities::CommandState;
+using VMM::GuestAgent::Utilities::PendingCommand;
+using VMM::GuestAgent::Utilities::PendingCommandHandle;
+using VMM::GuestAgent::Utilities::PhaseSpan;
+using VMM::GuestAgent::Utilities::PhaseTimeline;
+using VMM::GuestAgent::Utilities::PHASE_CATEGORY_COMMAND;
+
+namespace
+{
+
+/*----------------------------------------------------------------------------*/
+/**
+   Commands started with ExecuteAsync() are run and reaped by one supervisor
+   thread, which runs while any of them are queued or running.  The condition
+   protects everything here.
+
+*/
+struct Supervision
+{
+    Supervision()
+        : m_running(0)
+        , m_limit(VMM::GuestAgent::Utilities::DEFAULT_CONCURRENT_COMMANDS)
+        , m_active(false)
+        , m_supervisor(0)
+    {
+        m_cond.SetSleep(0);
+    }
+
+    SCXCoreLib::SCXCondition                     m_cond;
+    std::deque<SCXCoreLib::SCXHandle<CommandState> > m_queued;   //!< Not started yet
+    unsigned int                                 m_running;      //!< Started and not done
+    unsigned int                                 m_limit;        //!< Most commands running at once
+    bool                                         m_active;       //!< Is the supervisor thread running?
+    SCXCoreLib::SCXProcessSupervisor*            m_supervisor;   //!< Of the supervisor thread, to wake it up
+    SCXCoreLib::SCXHandle<SCXCoreLib::SCXThread> m_thread;       //!< The supervisor thread
+} s_supervision;
+
+/** Record how a command ended and release its waiters */
+void
+CompleteCommand(
+    const SCXCoreLib::SCXLogHandle& logHandle,
+    CommandState& state,
+    int exitStatus)
+{
+    state.m_stdOutBuf.LogLine();
+    state.m_stdErrBuf.LogLine();
+    state.m_process = NULL;
+
+    // Only the component goes into the timeline; commands may carry passwords
+    PhaseTimeline::Instance().Record(state.m_component, PHASE_CATEGORY_COMMAND,
+                                     state.m_start, PhaseTimeline::Now());
+
+    LogExitStatus(logHandle, state.m_component, exitStatus);
+
+    SCXCoreLib::SCXConditionHandle h(s_supervision.m_cond);
+    state.m_exitStatus = exitStatus;
+    state.m_done = true;
+    --s_supervision.m_running;
+    h.Broadcast();
+}
+
+void
+SuperviseCommands(
+    SCXCoreLib::SCXThreadParamHandle& /* param */)
+{
+    SCXCoreLib::SCXLogHandle logHandle = SCX::Util::LogHandleCache::Instance().GetLogHandle(
+        "scx.vmmguestagent.osconfigurator.commandexecutor");
+
+    // Commands in the order they were added to the supervisor, until they are done
+    std::vector<SCXCoreLib::SCXHandle<CommandState> > started;
+
+    try
+    {
+        SCXCoreLib::SCXProcessSupervisor supervisor;
+        {
+            SCXCoreLib::SCXConditionHandle h(s_supervision.m_cond);
+            s_supervision.m_supervisor = &supervisor;
+        }
+
+        for (;;)
+        {
+            std::vector<SCXCoreLib::SCXHandle<CommandState> > starting;
+            {
+                SCXCoreLib::SCXConditionHandle h(s_supervision.m_cond);
+                while (!s_supervision.m_queued.empty() &&
+                       s_supervision.m_running < s_supervision.m_limit)
+                {
+                    starting.push_back(s_supervision.m_queued.front());
+                    s_supervision.m_queued.pop_front();
+                    ++s_supervision.m_running;
+                }
+
+                if (starting.empty() && 0 == s_supervision.m_running)
                 {
-                    timeout = MINIMUM_TIMEOUT;
+                    s_supervision.m_supervisor = 0;
+                    s_supervision.m_active = false;
+                    return;
                 }
-                else if (MAXIMUM_TIMEOUT < val)
+            }
+
+            for (size_t i = 0; i < starting.size(); ++i)
+            {
+                CommandState& state = *starting[i];
+                state.m_start = PhaseTimeline::Now();
+                try
                 {
-                    timeout = MAXIMUM_TIMEOUT;
+                    state.m_process = new SCXCoreLib::SCXProcess(SCXCoreLib::SCXProcess::SplitCommand(state.m_command),
+                                                                 SCXCoreLib::SCXFilePath(L"."));
                 }
-                else
+                catch (SCXCoreLib::SCXException& e)
                 {
-                    timeout = static_cast<unsigned int> (val);
+                    SCX_LOGERROR(logHandle, SCXCoreLib::StrFromMultibyte(state.m_component) +
+                                 L" failed due to exceptions: " + e.What());
+                    CompleteCommand(logHandle, state, -1);
+                    continue;
                 }
+
+                size_t index = supervisor.Add(*state.m_process,
+                                              state.m_stdInStream,
+                                              state.m_stdOutStream,
+                                              state.m_stdErrStream,
+                                              VMM::GuestAgent::Utilities::clampTimeout(state.m_timeoutSecs) * 1000);
+                started.resize(index + 1);
+                started[index] = starting[i];
+            }
+
+            // Returns early once ExecuteAsync() queued another command
+            size_t index = supervisor.RunUntilExit();
+            if (SCXCoreLib::SCXProcessSupervisor::npos == index)
+            {
+                continue;
+            }
+
+            int exitStatus = supervisor.GetReturnCode(index);
+            if (supervisor.WasInterrupted(index))
+            {
+                SCX_LOGWARNING(logHandle, SCXCoreLib::StrFromMultibyte(started[index]->m_component) +
+                               L" timed out");
+                exitStatus = -1;
             }
+
+            CompleteCommand(logHandle, *started[index], exitStatus);
+            started[index] = NULL;
         }
     }
-    return timeout;
-}
+    catch (SCXCoreLib::SCXException& e)
+    {
+        SCX_LOGERROR(logHandle, L"Unable to supervise commands: " + e.What());
+    }
 
-}
-}
+    // Nothing supervises what is left; fail it rather than leave its waiters hanging
+    for (size_t i = 0; i < started.size(); ++i)
+    {
+        if (NULL != started[i])
+        {
+            CompleteCommand(logHandle, *started[i], -1);
+        }
+    }
+
+    SCXCoreLib::SCXConditionHandle h(s_supervision.m_cond);
+    while (!s_supervision.m_queued.empty())
+    {
+        SCXCoreLib::SCXHandle<CommandState> state = s_supervision.m_queued.front();
+        s_supervision.m_queued.pop_front();
+        SCX_LOGERROR(logHandle, state->m_component + " failed due to exceptions");
+        state->m_exitStatus = -1;
+        state->m_done = true;
+    }
+    s_supervision.m_supervisor = 0;
+    s_supervision.m_active = false;
+    h.Broadcast();
 }
 
-using VMM::GuestAgent::Utilities::CommandExecutor;
+}
 
 int CommandExecutor::Execute(const std::wstring& command, 
                              const std::string& component,
                              unsigned int const timeoutSecs)
 {
 
+    // Only the component goes into the timeline; commands may carry passwords
+    PhaseSpan span(component, PHASE_CATEGORY_COMMAND);
+
+    if (0 != s_runner)
+    {
+        return s_runner->Execute(command, component, timeoutSecs);
+    }
+
     std::istringstream stdInStream("");
-    std::ostringstream stdOutStream;
-    std::ostringstream stdErrStream;
+
+    // Output goes to the log as it arrives; nothing is logged for a stream
+    // the command did not write to
+    OutputLogBuf stdOutBuf(m_logHandle, component + " stdout: ", false);
+    OutputLogBuf stdErrBuf(m_logHandle, component + " stderr: ", true);
+    std::ostream stdOutStream(&stdOutBuf);
+    std::ostream stdErrStream(&stdErrBuf);
     
     SCXCoreLib::SCXFilePath workingPath(L".");
     int exitStatus = 0;
@@ -126,7 +508,7 @@ int CommandExecutor::Execute(const std::wstring& command,
                                                  stdInStream,
                                                  stdOutStream,
                                                  stdErrStream,
-                                                 timeoutSecs * 1000,
+                                                 clampTimeout(timeoutSecs) * 1000,
                                                  workingPath
                                                  /* , ChrootPath */ );
     }
@@ -143,40 +525,102 @@ int CommandExecutor::Execute(const std::wstring& command,
         exitStatus = -1;
     }
     
-    // Check return codes
-    if (exitStatus == 0)
+    stdOutBuf.LogLine();
+    stdErrBuf.LogLine();
+
+    LogExitStatus(m_logHandle, component, exitStatus);
+
+    return exitStatus;
+
+}
+
+PendingCommandHandle CommandExecutor::ExecuteAsync(const std::wstring& command,
+                                                   const std::string& component,
+                                                   unsigned int const timeoutSecs)
+{
+    SCXCoreLib::SCXHandle<CommandState> state(new CommandState(command, component, timeoutSecs, m_logHandle));
+
+    // A runner records commands rather than run them; there is nothing to wait for
+    if (0 != s_runner)
     {
-        // Success
-        SCX_LOGINFO(m_logHandle, L"Successfully configured " +
-                    SCXCoreLib::StrFromMultibyte(component));
-        
+        state->m_exitStatus = Execute(command, component, timeoutSecs);
+        state->m_done = true;
+        return PendingCommandHandle(new PendingCommand(state));
     }
-    else if (exitStatus == 1)
+
+    SCXCoreLib::SCXConditionHandle h(s_supervision.m_cond);
+    s_supervision.m_queued.push_back(state);
+
+    if (!s_supervision.m_active)
     {
-        // Success with warnings
-        SCX_LOGWARNING(m_logHandle, SCXCoreLib::StrFromMultibyte(component) +
-                       L" completed with warnings");
+        s_supervision.m_active = true;
+        s_supervision.m_thread = new SCXCoreLib::SCXThread(SuperviseCommands);
     }
-    else if (exitStatus == -1)
+    else if (0 != s_supervision.m_supervisor)
     {
-        // Critical failure
-        SCX_LOGERROR(m_logHandle, SCXCoreLib::StrFromMultibyte(component) +
-                     L" failed with exitcode:-1");
+        s_supervision.m_supervisor->Interrupt();
     }
-    else
+
+    return PendingCommandHandle(new PendingCommand(state));
+}
+
+void CommandExecutor::SetConcurrencyLimit(unsigned int const limit)
+{
+    SCXCoreLib::SCXConditionHandle h(s_supervision.m_cond);
+    s_supervision.m_limit = std::max(limit, 1u);
+
+    // Queued commands may start now
+    if (0 != s_supervision.m_supervisor)
     {
-        
-        SCX_LOGERROR(m_logHandle, SCXCoreLib::StrFromMultibyte(component) +
-                     L" failed with other exitcode:");
-        SCX_LOGERROR(
-            m_logHandle,
-            SCXCoreLib::StrToMultibyte(SCXCoreLib::StrFrom(exitStatus)));
+        s_supervision.m_supervisor->Interrupt();
+    }
+}
+
+void CommandExecutor::Shutdown(char const* option)
+{
+    if (0 != s_runner)
+    {
+        s_runner->Shutdown(option);
+        return;
     }
 
-    // Printing stderr/stdout
-    SCX_LOGINFO(m_logHandle, std::string("stdout as a result of running command:") + stdOutStream.str());
-    SCX_LOGERROR(m_logHandle, std::string("stderr as a result of running command:") + stdErrStream.str());
+    char const* args[] = { "shutdown", option, "now", 0 };
 
-    return exitStatus;
+    // exec does not run exit handlers; write out what is still queued
+    SCXCoreLib::SCXLogHandleFactory::Flush();
+
+    execv ("/sbin/shutdown", const_cast<char* const*>(args));
+    execv ("/etc/shutdown", const_cast<char* const*>(args));
+    execv ("/bin/shutdown", const_cast<char* const*>(args));
+}
+
+void CommandExecutor::SetRunner(CommandRunner* runner)
+{
+    s_runner = runner;
+}
+
+PendingCommand::PendingCommand(const SCXCoreLib::SCXHandle<CommandState>& state)
+  : m_state(state)
+{
+}
+
+PendingCommand::~PendingCommand()
+{
+    Wait();
+}
 
+int PendingCommand::Wait()
+{
+    SCXCoreLib::SCXConditionHandle h(s_supervision.m_cond);
+    while (!m_state->m_done)
+    {
+        h.Wait();
+    }
+    return m_state->m_exitStatus;
+}
+
+bool PendingCommand::IsDone() const
+{
+    SCXCoreLib::SCXConditionHandle h(s_supervision.m_cond);
+    return m_state->m_done;
 }
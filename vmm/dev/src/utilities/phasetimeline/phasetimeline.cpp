@@ -0,0 +1,269 @@
+/**
+ *  Copyright (c) Microsoft Corporation
+ *
+ *  All rights reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ *  use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  THIS CODE IS PROVIDED *AS IS* BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, EITHER EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION ANY IMPLIED
+ *  WARRANTIES OR CONDITIONS OF TITLE, FITNESS FOR A PARTICULAR PURPOSE,
+ *  MERCHANTABLITY OR NON-INFRINGEMENT.
+ *
+ *  See the Apache Version 2.0 License for specific language governing
+ *  permissions and limitations under the License.
+ *
+ **/
+
+/**
+   \file        phasetimeline.cpp
+
+   \brief       Records when each phase of the specialization starts and ends, and
+                writes the spans as a Chrome trace-event timeline next to the
+                status file
+
+   \date        10-18-2026 16:20:31
+
+*/
+/*----------------------------------------------------------------------------*/
+#include <phasetimeline.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <scxcorelib/stringaid.h>
+
+using VMM::GuestAgent::Utilities::PhaseTimeline;
+
+namespace
+{
+
+char const BOOT_ID_FILE[] = "/proc/sys/kernel/random/boot_id";
+
+inline std::string
+EscapeJSON(
+    const std::string& value)
+{
+    std::string escaped;
+    for (std::string::const_iterator iter = value.begin(); iter != value.end(); ++iter)
+    {
+        unsigned char ch = static_cast<unsigned char>(*iter);
+        if ('"' == ch || '\\' == ch)
+        {
+            escaped += '\\';
+            escaped += *iter;
+        }
+        else if (ch < 0x20)
+        {
+            char code[8];
+            snprintf(code, sizeof(code), "\\u%04x", ch);
+            escaped += code;
+        }
+        else
+        {
+            escaped += *iter;
+        }
+    }
+
+    return escaped;
+}
+
+inline bool
+WriteAll(
+    int fd,
+    const std::string& data)
+{
+    size_t done = 0;
+    while (done < data.size())
+    {
+        ssize_t count = write(fd, data.data() + done, data.size() - done);
+        if (count < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        done += static_cast<size_t>(count);
+    }
+
+    return true;
+}
+
+}
+
+scxulong PhaseTimeline::Now()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<scxulong>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+void PhaseTimeline::Record(const std::string& name,
+                           const char* category,
+                           scxulong start,
+                           scxulong finish)
+{
+    Span span;
+    span.m_name = name;
+    span.m_category = category;
+    span.m_start = start;
+    span.m_finish = finish;
+    span.m_thread = syscall(SYS_gettid);
+
+    SCXCoreLib::SCXThreadLock lock(m_lock);
+    m_spans.push_back(span);
+}
+
+void PhaseTimeline::SetFile(const std::string& path)
+{
+    SCXCoreLib::SCXThreadLock lock(m_lock);
+    m_file = path;
+}
+
+void PhaseTimeline::SetLabel(const std::string& label)
+{
+    SCXCoreLib::SCXThreadLock lock(m_lock);
+    m_label = label;
+}
+
+bool PhaseTimeline::Flush()
+{
+    SCXCoreLib::SCXThreadLock lock(m_lock);
+
+    if (m_file.empty())
+    {
+        return false;
+    }
+
+    if (m_spans.empty() && m_processWritten)
+    {
+        return true;
+    }
+
+    int pid = getpid();
+    std::ostringstream events;
+    if (!m_processWritten)
+    {
+        events << FormatProcess(pid) << ",\n";
+    }
+
+    for (std::vector<Span>::const_iterator iter = m_spans.begin(); iter != m_spans.end(); ++iter)
+    {
+        events << "{\"name\":\"" << EscapeJSON(iter->m_name)
+               << "\",\"cat\":\"" << iter->m_category
+               << "\",\"ph\":\"X\",\"ts\":" << iter->m_start
+               << ",\"dur\":" << iter->m_finish - iter->m_start
+               << ",\"pid\":" << pid
+               << ",\"tid\":" << iter->m_thread << "},\n";
+    }
+
+    int fd = open(m_file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        SCX_LOGWARNING(m_logHandle, "Unable to open timeline file " + m_file + " errno: " +
+                       SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+        return false;
+    }
+
+    // The trace viewer takes a JSON array that is never closed, so runs can
+    // keep appending to it
+    std::string data = events.str();
+    struct stat st;
+    if (0 == fstat(fd, &st) && 0 == st.st_size)
+    {
+        data = "[\n" + data;
+    }
+
+    bool written = WriteAll(fd, data) && 0 == fdatasync(fd);
+    if (0 != close(fd))
+    {
+        written = false;
+    }
+
+    if (!written)
+    {
+        SCX_LOGWARNING(m_logHandle, "Unable to write timeline file " + m_file + " errno: " +
+                       SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+        return false;
+    }
+
+    m_spans.clear();
+    m_processWritten = true;
+    return true;
+}
+
+bool PhaseTimeline::CopyTo(const std::string& path)
+{
+    if (!Flush())
+    {
+        return false;
+    }
+
+    std::string file;
+    {
+        SCXCoreLib::SCXThreadLock lock(m_lock);
+        file = m_file;
+    }
+
+    std::ifstream timelineStream(file.c_str());
+    std::ostringstream timeline;
+    timeline << timelineStream.rdbuf();
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0)
+    {
+        SCX_LOGWARNING(m_logHandle, "Unable to open timeline copy " + path + " errno: " +
+                       SCXCoreLib::StrToUTF8(SCXCoreLib::StrFrom(errno)));
+        return false;
+    }
+
+    bool written = timelineStream.is_open() && WriteAll(fd, timeline.str()) && 0 == fdatasync(fd);
+    if (0 != close(fd))
+    {
+        written = false;
+    }
+
+    if (!written)
+    {
+        SCX_LOGWARNING(m_logHandle, "Unable to copy timeline file " + file + " to " + path);
+        return false;
+    }
+
+    SCX_LOGINFO(m_logHandle, "Timeline copied to " + path);
+    return true;
+}
+
+std::string PhaseTimeline::FormatProcess(int pid) const
+{
+    // Monotonic time starts over with every boot; the boot id tells which
+    // runs can be compared
+    std::string bootId;
+    std::ifstream bootIdStream(BOOT_ID_FILE);
+    std::getline(bootIdStream, bootId);
+
+    std::ostringstream name;
+    name << (m_label.empty() ? "scvmmguestagent" : m_label) << " pid " << pid;
+    if (!bootId.empty())
+    {
+        name << " boot " << bootId;
+    }
+
+    std::ostringstream event;
+    event << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+          << ",\"args\":{\"name\":\"" << EscapeJSON(name.str()) << "\"}}";
+    return event.str();
+}
+
+/*----------------------------E-N-D---O-F---F-I-L-E---------------------------*/